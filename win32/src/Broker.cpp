@@ -0,0 +1,395 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "Broker.h"
+#include <tlhelp32.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "WebExtension.h"
+#include "FrameReader.h"
+#include "KSException.h"
+#include "LogEvent.h"
+
+static size_t defaultWorkers() {
+    return (std::max)(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(2));
+}
+
+static size_t defaultHeavyWorkers() {
+    return defaultWorkers() / 2;
+}
+
+static size_t defaultInteractiveWorkers() {
+    return defaultWorkers() - defaultHeavyWorkers();
+}
+
+/**
+ * SID of the user who runs a process
+ */
+static std::vector<unsigned char> getProcessUser(HANDLE process) {
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(process, TOKEN_QUERY, &token)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    DWORD tokenUserLg = 0;
+    GetTokenInformation(token, TokenUser, nullptr, 0, &tokenUserLg);
+    std::vector<unsigned char> tokenUser(tokenUserLg);
+    if ((tokenUserLg == 0) ||
+        !GetTokenInformation(token, TokenUser, tokenUser.data(), tokenUserLg, &tokenUserLg)) {
+        DWORD error = GetLastError();
+        CloseHandle(token);
+        throw KSException(__func__, __LINE__, error);
+    }
+    CloseHandle(token);
+    auto sid = static_cast<unsigned char *>(reinterpret_cast<TOKEN_USER *>(tokenUser.data())->User.Sid);
+    return std::vector<unsigned char>(sid, sid + GetLengthSid(sid));
+}
+
+/**
+ * Pipe names are shared by all users of the machine, another user can create the pipe before the broker
+ */
+static bool isServerOfCurrentUser(HANDLE pipe) {
+    ULONG serverProcessId = 0;
+    if (!GetNamedPipeServerProcessId(pipe, &serverProcessId)) {
+        return false;
+    }
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, serverProcessId);
+    if (process == nullptr) {
+        return false;
+    }
+    bool sameUser = false;
+    try {
+        auto serverUser = getProcessUser(process);
+        auto currentUser = getProcessUser(GetCurrentProcess());
+        sameUser = (EqualSid(serverUser.data(), currentUser.data()) != FALSE);
+    }
+    catch (KSException &) {
+        // The token of a process of another user can't be opened
+    }
+    CloseHandle(process);
+    return sameUser;
+}
+
+/**
+ * Identity of the client at the other end of the pipe, for the cancellation of its requests. The hosts are
+ * started per request, so the client is the process which started the host, the browser.
+ */
+static std::string getClientId(HANDLE pipe) {
+    ULONG hostProcessId = 0;
+    if (!GetNamedPipeClientProcessId(pipe, &hostProcessId)) {
+        // Only this connection can cancel its requests
+        return "pipe:" + std::to_string(reinterpret_cast<uintptr_t>(pipe));
+    }
+    DWORD clientProcessId = hostProcessId;
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot != INVALID_HANDLE_VALUE) {
+        PROCESSENTRY32 entry;
+        entry.dwSize = sizeof(entry);
+        for (BOOL found = Process32First(snapshot, &entry); found; found = Process32Next(snapshot, &entry)) {
+            if (entry.th32ProcessID == hostProcessId) {
+                clientProcessId = entry.th32ParentProcessID;
+                break;
+            }
+        }
+        CloseHandle(snapshot);
+    }
+    return "process:" + std::to_string(clientProcessId);
+}
+
+namespace {
+    /**
+     * Security attributes which only grant the current user access to the pipe. The default security
+     * descriptor of a named pipe also grants Everyone and anonymous users read access.
+     */
+    class PipeSecurity {
+    public:
+        PipeSecurity() : user(getProcessUser(GetCurrentProcess())) {
+            DWORD aclLg = sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) - sizeof(DWORD) + (DWORD)user.size();
+            acl.resize(aclLg);
+            if (!InitializeAcl(reinterpret_cast<PACL>(acl.data()), aclLg, ACL_REVISION) ||
+                !AddAccessAllowedAce(reinterpret_cast<PACL>(acl.data()), ACL_REVISION, FILE_ALL_ACCESS, user.data()) ||
+                !InitializeSecurityDescriptor(&descriptor, SECURITY_DESCRIPTOR_REVISION) ||
+                !SetSecurityDescriptorDacl(&descriptor, TRUE, reinterpret_cast<PACL>(acl.data()), FALSE)) {
+                throw KSException(__func__, __LINE__, GetLastError());
+            }
+            attributes.nLength = sizeof(attributes);
+            attributes.lpSecurityDescriptor = &descriptor;
+            attributes.bInheritHandle = FALSE;
+        }
+
+        PipeSecurity(const PipeSecurity &) = delete;
+
+        void operator=(const PipeSecurity &) = delete;
+
+        SECURITY_ATTRIBUTES *get() {
+            return &attributes;
+        }
+
+    private:
+        std::vector<unsigned char> user;
+        std::vector<unsigned char> acl;
+        SECURITY_DESCRIPTOR descriptor;
+        SECURITY_ATTRIBUTES attributes;
+    };
+}
+
+Broker::Broker(const std::string &name,
+               size_t heavyWorkers,
+               size_t interactiveWorkers,
+               std::chrono::seconds age) :
+        pipeName(name),
+        running{false},
+        activeClients{0},
+        collectorToken(std::make_shared<CancellationToken>()),
+        keyAge(age),
+        scheduler(heavyWorkers ? heavyWorkers : defaultHeavyWorkers(),
+                  interactiveWorkers ? interactiveWorkers : defaultInteractiveWorkers()) {
+    if (keyAge < KEY_COLLECTOR_LOWEST_AGE) {
+        throw std::invalid_argument("minimum age of orphaned keys is below KEY_COLLECTOR_LOWEST_AGE");
+    }
+}
+
+std::string Broker::getPipeName() {
+    CHAR userName[256 + 1];
+    DWORD userNameLg = sizeof(userName);
+    if (!GetUserNameA(userName, &userNameLg)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    return std::string("\\\\.\\pipe\\org.cryptable.pki.keymgmnt.") + userName;
+}
+
+void Broker::run() {
+    PipeSecurity security;
+    running = true;
+    std::thread collector(&Broker::collectKeys, this);
+    // Fails when another process, possibly of another user, owns the pipe name already
+    DWORD firstInstance = FILE_FLAG_FIRST_PIPE_INSTANCE;
+    while (running) {
+        HANDLE pipe = CreateNamedPipeA(pipeName.c_str(),
+                                       PIPE_ACCESS_DUPLEX | firstInstance,
+                                       PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                       PIPE_UNLIMITED_INSTANCES,
+                                       65536,
+                                       65536,
+                                       0,
+                                       security.get());
+        if (pipe == INVALID_HANDLE_VALUE) {
+            DWORD error = GetLastError();
+            {
+                std::lock_guard<std::mutex> guard(clientsLock);
+                running = false;
+            }
+            stopped.notify_all();
+            collectorToken->cancel();
+            collector.join();
+            throw KSException(__func__, __LINE__, error);
+        }
+        firstInstance = 0;
+        if (!ConnectNamedPipe(pipe, nullptr) && (GetLastError() != ERROR_PIPE_CONNECTED)) {
+            CloseHandle(pipe);
+            continue;
+        }
+        if (!running) {
+            DisconnectNamedPipe(pipe);
+            CloseHandle(pipe);
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> guard(clientsLock);
+            activeClients++;
+        }
+        std::thread(&Broker::serveClient, this, pipe).detach();
+    }
+
+    stopped.notify_all();
+    collector.join();
+    std::unique_lock<std::mutex> guard(clientsLock);
+    clientsDone.wait(guard, [this] { return activeClients == 0; });
+}
+
+void Broker::stop() {
+    {
+        std::lock_guard<std::mutex> guard(clientsLock);
+        running = false;
+    }
+    stopped.notify_all();
+    collectorToken->cancel();
+    // Wake up the accepting thread
+    HANDLE pipe = CreateFileA(pipeName.c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              0,
+                              nullptr,
+                              OPEN_EXISTING,
+                              0,
+                              nullptr);
+    if (pipe != INVALID_HANDLE_VALUE) {
+        CloseHandle(pipe);
+    }
+}
+
+void Broker::collectKeys() {
+    CancellationToken::Scope scope(collectorToken);
+    std::unique_lock<std::mutex> guard(clientsLock);
+    while (running) {
+        guard.unlock();
+        try {
+            certificateStore.collectOrphanKeys(keyAge);
+        }
+        catch (OperationCancelled &) {
+            return;
+        }
+        catch (std::exception &e) {
+            LogEvent::GetInstance().error(0, e.what());
+        }
+        guard.lock();
+        stopped.wait_for(guard, BROKER_COLLECT_INTERVAL, [this] { return !running; });
+    }
+}
+
+void Broker::serveClient(HANDLE pipe) {
+    try {
+        std::string client = getClientId(pipe);
+        std::string request;
+        while (readPipeFrame(pipe, request)) {
+            FrameBuffer buffer(&request[0], request.size());
+            std::istream in(&buffer);
+            std::ostringstream out;
+            WebExtension::process_request(in, out, certificateStore, scheduler, client);
+            wipe(request);
+            std::string response = out.str();
+            if (!writePipe(pipe, response.data(), response.size())) {
+                break;
+            }
+        }
+        wipe(request);
+    }
+    catch (std::exception &e) {
+        LogEvent::GetInstance().error(0, e.what());
+    }
+    FlushFileBuffers(pipe);
+    DisconnectNamedPipe(pipe);
+    CloseHandle(pipe);
+
+    std::lock_guard<std::mutex> guard(clientsLock);
+    activeClients--;
+    clientsDone.notify_all();
+}
+
+bool Broker::relay(const char *request, size_t requestLg, std::string &response, const std::string &pipeName) {
+    if (requestLg > BROKER_MAX_FRAME) {
+        throw KSException(__func__, __LINE__, "Frame too large");
+    }
+    HANDLE pipe = CreateFileA(pipeName.c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              0,
+                              nullptr,
+                              OPEN_EXISTING,
+                              0,
+                              nullptr);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        if ((GetLastError() != ERROR_PIPE_BUSY) || !WaitNamedPipeA(pipeName.c_str(), BROKER_CONNECT_TIMEOUT)) {
+            return false;
+        }
+        pipe = CreateFileA(pipeName.c_str(),
+                           GENERIC_READ | GENERIC_WRITE,
+                           0,
+                           nullptr,
+                           OPEN_EXISTING,
+                           0,
+                           nullptr);
+        if (pipe == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+    }
+    // The request can have passwords and keys, only the broker of this user may read it
+    if (!isServerOfCurrentUser(pipe)) {
+        CloseHandle(pipe);
+        LogEvent::GetInstance().warning(0, "The broker pipe is not owned by the current user");
+        return false;
+    }
+    // The length is written on its own, so the message is relayed from the buffer of the reader without a copy
+    uint32_t frameLg = static_cast<uint32_t>(requestLg);
+    if (!writePipe(pipe, (const char *)&frameLg, 4) || !writePipe(pipe, request, requestLg)) {
+        CloseHandle(pipe);
+        return false;
+    }
+    // The broker has the request, running it again in process could create a second key
+    bool received = readPipeFrame(pipe, response);
+    CloseHandle(pipe);
+    if (!received) {
+        throw KSException(__func__, __LINE__, "Broker closed the connection");
+    }
+    return true;
+}
+
+void Broker::wipe(std::string &frame) {
+    if (!frame.empty()) {
+        SecureZeroMemory(&frame[0], frame.size());
+    }
+    frame.clear();
+}
+
+bool Broker::readPipeFrame(HANDLE pipe, std::string &frame) {
+    uint32_t frameLg = 0;
+    DWORD read = 0;
+    size_t offset = 0;
+    while (offset < 4) {
+        if (!ReadFile(pipe, (char *)&frameLg + offset, 4 - (DWORD)offset, &read, nullptr) || (read == 0)) {
+            return false;
+        }
+        offset += read;
+    }
+    if (frameLg > BROKER_MAX_FRAME) {
+        throw KSException(__func__, __LINE__, "Frame too large");
+    }
+    frame.resize(4 + frameLg);
+    memcpy(&frame[0], &frameLg, 4);
+    while (offset < frame.size()) {
+        if (!ReadFile(pipe, &frame[offset], (DWORD)(frame.size() - offset), &read, nullptr) || (read == 0)) {
+            return false;
+        }
+        offset += read;
+    }
+    return true;
+}
+
+bool Broker::writePipe(HANDLE pipe, const char *data, size_t dataLg) {
+    size_t offset = 0;
+    while (offset < dataLg) {
+        DWORD written = 0;
+        if (!WriteFile(pipe, data + offset, (DWORD)(dataLg - offset), &written, nullptr)) {
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_BROKER_H
+#define KSMGMNT_BROKER_H
+#include "common.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include "CertificateStore.h"
+#include "RequestScheduler.h"
+#include "CancellationToken.h"
+
+// Largest request or response relayed over the pipe
+#define BROKER_MAX_FRAME (64 * 1024 * 1024)
+// Time a host waits for a busy broker before it handles the request itself
+#define BROKER_CONNECT_TIMEOUT 1000
+// Time between two collections of orphaned keys
+#define BROKER_COLLECT_INTERVAL std::chrono::hours(1)
+
+/**
+ * Long running broker which owns the certificate and key stores for all browser processes of a user.
+ * The hosts started by the browsers relay their native messaging frames (length + JSON) over a named
+ * pipe to the broker, so the store handles, indexes and caches stay warm between requests.
+ */
+class Broker {
+public:
+    /**
+     * Pipe name of the broker of the current user
+     */
+    static std::string getPipeName();
+
+    /**
+     * @param heavyWorkers workers for key generation and PKCS12 requests, 0 for half of the cores
+     * @param interactiveWorkers workers for the other requests, 0 for the remaining cores
+     * @param keyAge orphaned keys younger than this are kept
+     * throws std::invalid_argument when keyAge is below KEY_COLLECTOR_LOWEST_AGE
+     */
+    explicit Broker(const std::string &pipeName = getPipeName(),
+                    size_t heavyWorkers = 0,
+                    size_t interactiveWorkers = 0,
+                    std::chrono::seconds keyAge = KEY_COLLECTOR_MINIMUM_AGE);
+
+    Broker(const Broker &) = delete;
+
+    void operator=(const Broker &) = delete;
+
+    /**
+     * Accept clients until stop is called, every client is served on its own thread. Orphaned keys are
+     * collected in the background every BROKER_COLLECT_INTERVAL.
+     */
+    void run();
+
+    void stop();
+
+    /**
+     * Relay one native messaging frame to the broker and return its response
+     * @param request JSON message of the frame, as read by a FrameReader from the browser
+     * @param response length + JSON frame to write to the browser
+     * @return false when no broker is running, the request must be handled in process
+     */
+    static bool relay(const char *request,
+                      size_t requestLg,
+                      std::string &response,
+                      const std::string &pipeName = getPipeName());
+
+    /**
+     * Zeroize a frame, it can hold passwords
+     */
+    static void wipe(std::string &frame);
+
+private:
+    void serveClient(HANDLE pipe);
+
+    void collectKeys();
+
+    static bool readPipeFrame(HANDLE pipe, std::string &frame);
+
+    static bool writePipe(HANDLE pipe, const char *data, size_t dataLg);
+
+    std::string pipeName;
+    std::atomic<bool> running;
+    std::mutex clientsLock;
+    std::condition_variable clientsDone;
+    size_t activeClients;
+    // Wakes up the key collector when the broker stops, the token interrupts a running collection
+    std::condition_variable stopped;
+    std::shared_ptr<CancellationToken> collectorToken;
+    std::chrono::seconds keyAge;
+    // The certificate store is shared by all clients
+    CertificateStore certificateStore;
+    RequestScheduler scheduler;
+};
+
+#endif //KSMGMNT_BROKER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,111 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include "CancellationToken.h"
+
+static thread_local std::shared_ptr<CancellationToken> currentToken;
+
+static std::mutex registrationsLock;
+// Keyed on client and request id, clients choose their request ids
+static std::multimap<std::pair<std::string, std::string>, std::shared_ptr<CancellationToken>> registrations;
+
+CancellationToken::CancellationToken() : cancelled{false}, hasDeadline{false} {
+}
+
+CancellationToken::CancellationToken(Clock::time_point d) : cancelled{false}, hasDeadline{true}, deadline(d) {
+}
+
+void CancellationToken::cancel() {
+    cancelled = true;
+}
+
+bool CancellationToken::isCancelled() const {
+    return cancelled || (hasDeadline && (Clock::now() >= deadline));
+}
+
+void CancellationToken::throwIfCancelled() const {
+    if (cancelled) {
+        throw OperationCancelled("Request cancelled");
+    }
+    if (hasDeadline && (Clock::now() >= deadline)) {
+        throw OperationCancelled("Request deadline exceeded");
+    }
+}
+
+void CancellationToken::checkpoint() {
+    if (currentToken) {
+        currentToken->throwIfCancelled();
+    }
+}
+
+std::shared_ptr<CancellationToken> CancellationToken::current() {
+    return currentToken;
+}
+
+bool CancellationToken::cancel(const std::string &client, const std::string &requestId) {
+    std::lock_guard<std::mutex> guard(registrationsLock);
+    auto range = registrations.equal_range(std::make_pair(client, requestId));
+    for (auto it = range.first; it != range.second; ++it) {
+        it->second->cancel();
+    }
+    return range.first != range.second;
+}
+
+CancellationToken::Scope::Scope(std::shared_ptr<CancellationToken> token) : previous(currentToken) {
+    currentToken = token;
+}
+
+CancellationToken::Scope::~Scope() {
+    currentToken = previous;
+}
+
+CancellationToken::Registration::Registration(const std::string &c,
+                                              const std::string &id,
+                                              std::shared_ptr<CancellationToken> t) :
+        client(c),
+        requestId(id),
+        token(t) {
+    std::lock_guard<std::mutex> guard(registrationsLock);
+    registrations.insert(std::make_pair(std::make_pair(client, requestId), token));
+}
+
+CancellationToken::Registration::~Registration() {
+    std::lock_guard<std::mutex> guard(registrationsLock);
+    auto range = registrations.equal_range(std::make_pair(client, requestId));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == token) {
+            registrations.erase(it);
+            break;
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_CANCELLATIONTOKEN_H
+#define KSMGMNT_CANCELLATIONTOKEN_H
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Thrown by a checkpoint when the running request is cancelled or passed its deadline
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    explicit OperationCancelled(const std::string &what) : std::runtime_error(what) {}
+};
+
+/**
+ * Cooperative cancellation of a request. The token of the running request is installed per thread
+ * with a Scope, long running code calls checkpoint() at points where it can stop without leaving
+ * half finished work behind.
+ */
+class CancellationToken {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    CancellationToken();
+
+    explicit CancellationToken(Clock::time_point deadline);
+
+    void cancel();
+
+    /**
+     * @return true when cancelled or the deadline passed
+     */
+    bool isCancelled() const;
+
+    /**
+     * throws OperationCancelled when cancelled or the deadline passed
+     */
+    void throwIfCancelled() const;
+
+    /**
+     * Check the token of the current thread, if any
+     * throws OperationCancelled when it is cancelled or the deadline passed
+     */
+    static void checkpoint();
+
+    /**
+     * Token of the current thread, nullptr outside a Scope. Pass it to threads started by the request.
+     */
+    static std::shared_ptr<CancellationToken> current();
+
+    /**
+     * Cancel the request which a client registered under requestId, the requests of other clients
+     * with the same id are not touched
+     * @return false when the client has no such request running
+     */
+    static bool cancel(const std::string &client, const std::string &requestId);
+
+    /**
+     * Install a token for the current thread
+     */
+    class Scope {
+    public:
+        explicit Scope(std::shared_ptr<CancellationToken> token);
+
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+
+        void operator=(const Scope &) = delete;
+
+    private:
+        std::shared_ptr<CancellationToken> previous;
+    };
+
+    /**
+     * Make a token cancellable by the client and request id, as long as the registration lives
+     */
+    class Registration {
+    public:
+        Registration(const std::string &client, const std::string &requestId, std::shared_ptr<CancellationToken> token);
+
+        ~Registration();
+
+        Registration(const Registration &) = delete;
+
+        void operator=(const Registration &) = delete;
+
+    private:
+        std::string client;
+        std::string requestId;
+        std::shared_ptr<CancellationToken> token;
+    };
+
+private:
+    std::atomic<bool> cancelled;
+    bool hasDeadline;
+    Clock::time_point deadline;
+};
+
+#endif //KSMGMNT_CANCELLATIONTOKEN_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
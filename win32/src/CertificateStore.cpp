@@ -4,115 +4,540 @@
  * Author: "David Tillemans"
  * Date: 08/08/2020
  */
-#include <rpc.h>
 #include <functional>
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include "CertificateStore.h"
+#include "Digest.h"
 #include "KSException.h"
+#include "Metrics.h"
+#include "PemScanner.h"
 #include "X509Name.h"
+#include "CertificateView.h"
+#include "CancellationToken.h"
+#include "Utf8Utils.h"
+#include "Uuid.h"
+#include "LogEvent.h"
 
-CertificateStore::CertificateStore() : keyStore(MS_KEY_STORAGE_PROVIDER) {
+// Room for the PKCS12 envelope, its MAC and the key bag attributes on top of the certificates and the key
+#define PFX_EXPORT_OVERHEAD 4096
+// Room for the attributes of a certificate bag
+#define PFX_EXPORT_CERTIFICATE_OVERHEAD 256
+// Number of certificates per worker before the classification of a PFX import is run in parallel
+#define PFX_PARALLEL_IMPORT_THRESHOLD 32
+
+namespace {
+    /**
+     * Change notification of a system certificate store, the store is read again when it changed
+     */
+    class SystemStoreSource : public StoreWatcher::Source {
+    public:
+        explicit SystemStoreSource(HCERTSTORE storeHandle) : store{CertDuplicateStore(storeHandle)}, event{nullptr} {
+            arm();
+        }
+
+        explicit SystemStoreSource(const char *systemStore) : store{CertOpenSystemStoreA(NULL, systemStore)},
+                                                              event{nullptr} {
+            if (store == nullptr) {
+                throw KSException("SystemStoreSource", __LINE__, GetLastError());
+            }
+            arm();
+        }
+
+        ~SystemStoreSource() override {
+            CertCloseStore(store, 0);
+            CloseHandle(event);
+        }
+
+        bool changed() override {
+            if (WaitForSingleObject(event, 0) != WAIT_OBJECT_0) {
+                return false;
+            }
+            // Also waits for the next change
+            CertControlStore(store, 0, CERT_STORE_CTRL_RESYNC, &event);
+            return true;
+        }
+
+    private:
+        void arm() {
+            event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            if ((event == nullptr) || !CertControlStore(store, 0, CERT_STORE_CTRL_NOTIFY_CHANGE, &event)) {
+                DWORD lastError = GetLastError();
+                if (event != nullptr) {
+                    CloseHandle(event);
+                }
+                CertCloseStore(store, 0);
+                throw KSException("SystemStoreSource", __LINE__, lastError);
+            }
+        }
+
+        HCERTSTORE store;
+        HANDLE event;
+    };
+
+    /**
+     * Files which are added to or removed from a directory, like the keys of the software key storage provider
+     */
+    class DirectorySource : public StoreWatcher::Source {
+    public:
+        explicit DirectorySource(const std::wstring &directory) :
+                notification{FindFirstChangeNotificationW(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME)} {
+            if (notification == INVALID_HANDLE_VALUE) {
+                throw KSException("DirectorySource", __LINE__, GetLastError());
+            }
+        }
+
+        ~DirectorySource() override {
+            FindCloseChangeNotification(notification);
+        }
+
+        bool changed() override {
+            if (WaitForSingleObject(notification, 0) != WAIT_OBJECT_0) {
+                return false;
+            }
+            FindNextChangeNotification(notification);
+            return true;
+        }
+
+    private:
+        HANDLE notification;
+    };
+}
+
+CertificateStore::CertificateStore() : keyStore(MS_KEY_STORAGE_PROVIDER),
+                                       chainBuilder(verifySignature),
+                                       issuersLoaded{false},
+                                       indexStale{true},
+                                       certificatesGeneration{0},
+                                       issuersGeneration{0},
+                                       keysGeneration{0} {
     storeHandle = CertOpenSystemStoreA(NULL, "MY");
     if (storeHandle == nullptr) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
+    watchStores(true);
 }
 
-CertificateStore::CertificateStore(const std::wstring &keyStoreProvider) : keyStore(keyStoreProvider.c_str()) {
+CertificateStore::CertificateStore(const std::wstring &keyStoreProvider) : keyStore(keyStoreProvider.c_str()),
+                                                                         chainBuilder(verifySignature),
+                                                                         issuersLoaded{false},
+                                       indexStale{true},
+                                       certificatesGeneration{0},
+                                       issuersGeneration{0},
+                                       keysGeneration{0} {
     storeHandle = CertOpenSystemStoreA(NULL, "MY");
     if (storeHandle == nullptr) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
+    watchStores(keyStoreProvider == MS_KEY_STORAGE_PROVIDER);
+}
+
+void CertificateStore::watchStores(bool softwareProvider) {
+    try {
+        storeWatcher.watch(StoreWatcher::watchedStore::Certificates,
+                           std::unique_ptr<StoreWatcher::Source>(new SystemStoreSource(storeHandle)));
+        storeWatcher.watch(StoreWatcher::watchedStore::Issuers,
+                           std::unique_ptr<StoreWatcher::Source>(new SystemStoreSource("CA")));
+        storeWatcher.watch(StoreWatcher::watchedStore::Issuers,
+                           std::unique_ptr<StoreWatcher::Source>(new SystemStoreSource("ROOT")));
+        // The software provider keeps a file per user key, other providers do not tell about their changes
+        wchar_t appData[MAX_PATH];
+        DWORD appDataLg = GetEnvironmentVariableW(L"APPDATA", appData, MAX_PATH);
+        if (softwareProvider && (appDataLg > 0) && (appDataLg < MAX_PATH)) {
+            storeWatcher.watch(StoreWatcher::watchedStore::Keys,
+                               std::unique_ptr<StoreWatcher::Source>(
+                                       new DirectorySource(std::wstring(appData, appDataLg) +
+                                                           L"\\Microsoft\\Crypto\\Keys")));
+        }
+    }
+    catch (const std::exception &e) {
+        // Without notification a cache is only refreshed after the changes of this process
+        LogEvent::GetInstance().warning(0, std::string("Store changes are not watched: ") + e.what());
+    }
+}
+
+void CertificateStore::syncStores() {
+    storeWatcher.poll();
+    std::lock_guard<std::mutex> guard(lock);
+    uint64_t certificates = storeWatcher.getGeneration(StoreWatcher::watchedStore::Certificates);
+    uint64_t issuers = storeWatcher.getGeneration(StoreWatcher::watchedStore::Issuers);
+    uint64_t keys = storeWatcher.getGeneration(StoreWatcher::watchedStore::Keys);
+    if ((certificates != certificatesGeneration) || (keys != keysGeneration)) {
+        indexStale = true;
+    }
+    // The other open keys stay valid, only the deleted ones are closed
+    if (keys != keysGeneration) {
+        keyStore.closeDeletedKeys();
+    }
+    // A CA certificate can be removed, so the issuers are loaded again instead of only adding the new ones
+    if ((issuers != issuersGeneration) && issuersLoaded) {
+        chainBuilder.clear();
+        for (auto &issuer : importedIssuers) {
+            chainBuilder.addIssuer(issuer.data(), issuer.size());
+        }
+        issuersLoaded = false;
+    }
+    certificatesGeneration = certificates;
+    issuersGeneration = issuers;
+    keysGeneration = keys;
+}
+
+void CertificateStore::addImportedIssuer(const BYTE *cert, DWORD certLg) {
+    std::lock_guard<std::mutex> guard(lock);
+    chainBuilder.addIssuer(cert, certLg);
+    for (auto &issuer : importedIssuers) {
+        if ((issuer.size() == certLg) && std::equal(issuer.begin(), issuer.end(), cert)) {
+            return;
+        }
+    }
+    importedIssuers.emplace_back(cert, cert + certLg);
 }
 
 std::string CertificateStore::createCertificateRequest(const std::string &subjectName,
                                                        size_t bitLength,
                                                        bool forcePINPasswordProtection) {
-    UUID uuid;
-    RPC_STATUS status;
-    RPC_WSTR   strUuid;
-    status = UuidCreate(&uuid);
-    if ((status != RPC_S_OK) && (status != RPC_S_UUID_LOCAL_ONLY)) {
-        KSException(__func__, __LINE__, (DWORD)status);
-    }
-    status = UuidToStringW(&uuid, &strUuid);
-    auto safeUuid = std::unique_ptr<RPC_WSTR,std::function<void(RPC_WSTR *ptr)>>(&strUuid, RpcStringFreeW );
-    if (status != RPC_S_OK) {
-        KSException(__func__, __LINE__, (DWORD)status);
-    }
-    std::wstring stringUuid(reinterpret_cast<const wchar_t *const>(strUuid));
+    // Time ordered key names, the keys of one host sort in the order they are created
+    unsigned char uuid[16];
+    wchar_t strUuid[UUID_STRING_LENGTH + 1];
+    Uuid::generate(Uuid::uuidVersion::V7, uuid);
+    Uuid::format(uuid, strUuid);
+    std::wstring stringUuid(strUuid, UUID_STRING_LENGTH);
     auto keyPair = keyStore.generateKeyPair(stringUuid, bitLength, forcePINPasswordProtection);
+    invalidateIndex();
+    try {
+        CancellationToken::checkpoint();
+    }
+    catch (OperationCancelled &) {
+        keyStore.deleteKeyPair(keyPair->getName());
+        throw;
+    }
 
-    lastKeyId = stringUuid;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        lastKeyId = stringUuid;
+    }
 
     return createCertificateRequestFromCNG(subjectName, keyPair.get());
 }
 
+std::vector<CertificateStore::GeneratedRequest> CertificateStore::createCertificateRequests(
+        const std::vector<RequestTemplate> &requests,
+        bool forcePINPasswordProtection) {
+    if (requests.empty() || (requests.size() > CSR_BATCH_MAX_REQUESTS)) {
+        throw KSException(__func__, __LINE__, "Invalid number of certificate requests");
+    }
+    // Refuse invalid names before any key is generated
+    for (auto &request : requests) {
+        X509Name subject(request.subjectName);
+    }
+
+    std::vector<GeneratedRequest> generated(requests.size());
+    std::vector<std::wstring> keyNames(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        unsigned char uuid[16];
+        char strUuid[UUID_STRING_LENGTH + 1];
+        wchar_t wstrUuid[UUID_STRING_LENGTH + 1];
+        Uuid::generate(Uuid::uuidVersion::V7, uuid);
+        Uuid::format(uuid, strUuid);
+        Uuid::format(uuid, wstrUuid);
+        generated[i].keyName.assign(strUuid, UUID_STRING_LENGTH);
+        keyNames[i].assign(wstrUuid, UUID_STRING_LENGTH);
+    }
+
+    // Every worker takes the next key until all keys are generated, a failed key does not stop the others
+    std::vector<std::shared_ptr<KeyPair>> keyPairs(requests.size());
+    std::vector<std::exception_ptr> errors(requests.size());
+    std::atomic<size_t> next(0);
+    // The workers do not inherit the cancellation token of this thread
+    auto token = CancellationToken::current();
+    auto generate = [&]() {
+        size_t i;
+        while ((i = next++) < requests.size()) {
+            try {
+                if (token) {
+                    token->throwIfCancelled();
+                }
+                keyPairs[i] = keyStore.generateKeyPair(keyNames[i],
+                                                       (u_long)requests[i].bitLength,
+                                                       forcePINPasswordProtection);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    size_t workers = (std::min)((std::max)(static_cast<size_t>(std::thread::hardware_concurrency()),
+                                           static_cast<size_t>(1)),
+                                requests.size());
+    std::vector<std::future<void>> results;
+    for (size_t i = 1; i < workers; i++) {
+        results.push_back(std::async(std::launch::async, generate));
+    }
+    generate();
+    for (auto &result : results) {
+        result.get();
+    }
+    invalidateIndex();
+
+    bool signing = false;
+    size_t signedRequests = 0;
+    try {
+        for (auto &error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        CancellationToken::checkpoint();
+        signing = true;
+        for (; signedRequests < requests.size(); signedRequests++) {
+            generated[signedRequests].request = createCertificateRequestFromCNG(requests[signedRequests].subjectName,
+                                                                                keyPairs[signedRequests].get());
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            // createCertificateRequestFromCNG already deleted the key of the request it failed on
+            if (keyPairs[i] && !(signing && (i == signedRequests))) {
+                try {
+                    keyStore.deleteKeyPair(keyNames[i]);
+                }
+                catch (const std::exception &e) {
+                    LogEvent::GetInstance().error(0, e.what());
+                }
+            }
+        }
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        lastKeyId = keyNames.back();
+    }
+
+    return generated;
+}
+
 CertificateStore::~CertificateStore() {
     CertCloseStore(storeHandle, 0);
 }
 
 void CertificateStore::importCertificate(const std::string &pemCertificate) {
-    DWORD certLg = 0;
+    importCertificate(pemCertificate.data(), pemCertificate.size());
+}
 
-    if (pemCertificate.size() > MAXDWORD) {
+void CertificateStore::importCertificate(const char *pem, size_t pemLg) {
+    if (pemLg > MAXDWORD) {
         throw std::overflow_error("DWORD overflow");
     }
-    if (!CryptStringToBinaryA(pemCertificate.c_str(),
-                              (DWORD)pemCertificate.size(),
-                              CRYPT_STRING_BASE64HEADER,
-                              nullptr,
-                              &certLg,
-                              nullptr,
-                              nullptr)) {
+    // The certificates are linked to the open keys, which must not have been deleted meanwhile
+    syncStores();
+
+    // The certificates of the bundle are staged in memory, the MY store is only changed when all of them are valid
+    HCERTSTORE staging = CertOpenStore(CERT_STORE_PROV_MEMORY, 0, 0, 0, nullptr);
+    if (staging == nullptr) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
-    std::vector<unsigned char> cert(certLg);
-    CryptStringToBinaryA(pemCertificate.c_str(),
-                         (DWORD)pemCertificate.size(),
-                         CRYPT_STRING_BASE64HEADER,
-                         cert.data(),
-                         &certLg,
-                         nullptr,
-                         nullptr);
+    std::vector<PCCERT_CONTEXT> certificates;
+    try {
+        PemScanner scanner(pem, pemLg);
+        while (scanner.next()) {
+            if (scanner.label() == "CERTIFICATE") {
+                stageCertificate(staging, scanner.data(), (DWORD)scanner.size());
+            }
+            else if (scanner.label() == "PKCS7") {
+                stagePkcs7(staging, scanner.data(), (DWORD)scanner.size());
+            }
+            // Other blocks, like the private key of a PEM file, are not imported
+        }
+        PCCERT_CONTEXT certificateCtx = nullptr;
+        while ((certificateCtx = CertEnumCertificatesInStore(staging, certificateCtx)) != nullptr) {
+            certificates.push_back(CertDuplicateCertificateContext(certificateCtx));
+        }
+        if (certificates.empty()) {
+            throw KSException(__func__, __LINE__, "No certificate found");
+        }
+        // Last point to back out before the store is changed
+        CancellationToken::checkpoint();
+    }
+    catch (...) {
+        for (auto cert : certificates) {
+            CertFreeCertificateContext(cert);
+        }
+        CertCloseStore(staging, 0);
+        throw;
+    }
 
-    // TODO: maybe allow other stores then 'MY'
-    PCCERT_CONTEXT certContext = nullptr;
-    if (!CertAddEncodedCertificateToStore(storeHandle,
+    // Commit, and remove the certificates added by this import again when one of them fails. Certificates which
+    // were already in the store are found by their thumbprint, and stay. CA certificates are only used for chains,
+    // like in a PFX.
+    std::vector<PCCERT_CONTEXT> added;
+    try {
+        for (size_t i = 0; i < certificates.size(); i++) {
+            if (isCACertificate(certificates[i])) {
+                continue;
+            }
+            std::string thumbprintValue = getThumbprint(certificates[i]);
+            CRYPT_HASH_BLOB thumbprint = {static_cast<DWORD>(thumbprintValue.size()),
+                                          reinterpret_cast<BYTE *>(&thumbprintValue[0])};
+            PCCERT_CONTEXT present = CertFindCertificateInStore(storeHandle,
+                                                                X509_ASN_ENCODING,
+                                                                0,
+                                                                CERT_FIND_SHA1_HASH,
+                                                                &thumbprint,
+                                                                nullptr);
+            if (present != nullptr) {
+                CertFreeCertificateContext(present);
+            }
+            PCCERT_CONTEXT storeCtx = nullptr;
+            if (!CertAddCertificateContextToStore(storeHandle,
+                                                  certificates[i],
+                                                  CERT_STORE_ADD_REPLACE_EXISTING,
+                                                  &storeCtx)) {
+                throw KSException(__func__, __LINE__, GetLastError());
+            }
+            if (present == nullptr) {
+                added.push_back(storeCtx);
+            }
+            try {
+                linkKey(storeCtx);
+            }
+            catch (...) {
+                if (present != nullptr) {
+                    CertFreeCertificateContext(storeCtx);
+                }
+                throw;
+            }
+            if (present != nullptr) {
+                CertFreeCertificateContext(storeCtx);
+            }
+        }
+    }
+    catch (...) {
+        for (auto cert : added) {
+            CertDeleteCertificateFromStore(cert);
+        }
+        for (auto cert : certificates) {
+            CertFreeCertificateContext(cert);
+        }
+        CertCloseStore(staging, 0);
+        invalidateIndex();
+        throw;
+    }
+
+    for (auto cert : certificates) {
+        if (isCACertificate(cert)) {
+            addImportedIssuer(cert->pbCertEncoded, cert->cbCertEncoded);
+        }
+        CertFreeCertificateContext(cert);
+    }
+    for (auto cert : added) {
+        CertFreeCertificateContext(cert);
+    }
+    CertCloseStore(staging, 0);
+    invalidateIndex();
+}
+
+void CertificateStore::stageCertificate(HCERTSTORE staging, const BYTE *cert, DWORD certLg) {
+    // Reject malformed certificates before they reach the store
+    CertificateView certificate(cert, certLg);
+    if (isRevoked(certificate)) {
+        throw KSException(__func__, __LINE__, "Certificate is revoked");
+    }
+    // A certificate which is more than once in the bundle is imported once
+    if (!CertAddEncodedCertificateToStore(staging,
                                           X509_ASN_ENCODING,
-                                          cert.data(),
+                                          cert,
                                           certLg,
-                                          CERT_STORE_ADD_ALWAYS,
-                                          &certContext)) {
-        CertCloseStore(storeHandle, 0);
+                                          CERT_STORE_ADD_USE_EXISTING,
+                                          nullptr)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+}
+
+void CertificateStore::stagePkcs7(HCERTSTORE staging, const BYTE *pkcs7, DWORD pkcs7Lg) {
+    CRYPT_DATA_BLOB pkcs7Blob = {pkcs7Lg, const_cast<BYTE *>(pkcs7)};
+    HCERTSTORE pkcs7Store = CertOpenStore(CERT_STORE_PROV_PKCS7,
+                                          X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
+                                          0,
+                                          0,
+                                          &pkcs7Blob);
+    if (pkcs7Store == nullptr) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
+    PCCERT_CONTEXT certificateCtx = nullptr;
+    while ((certificateCtx = CertEnumCertificatesInStore(pkcs7Store, certificateCtx)) != nullptr) {
+        try {
+            stageCertificate(staging, certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+        }
+        catch (...) {
+            CertFreeCertificateContext(certificateCtx);
+            CertCloseStore(pkcs7Store, 0);
+            throw;
+        }
+    }
+    CertCloseStore(pkcs7Store, 0);
+}
+
+void CertificateStore::linkKey(PCCERT_CONTEXT certContext) {
+    // The key collector checks the links again under this lock before it deletes a key
+    std::lock_guard<std::mutex> guard(keyLinkLock);
     auto keyPair = keyStore.getKeyPair(certContext->pCertInfo->SubjectPublicKeyInfo);
-    if (keyPair != nullptr) {
-        CRYPT_KEY_PROV_INFO cryptKeyProvInfo = {
-                const_cast<LPWSTR>(keyPair->getName().c_str()),
-                const_cast<LPWSTR>(MS_KEY_STORAGE_PROVIDER),
-                0,
-                0,
-                0,
-                nullptr,
-                AT_SIGNATURE
-        };
-        if (!CertSetCertificateContextProperty(certContext,
-                                               CERT_KEY_PROV_INFO_PROP_ID,
-                                               0,
-                                               &cryptKeyProvInfo)) {
-            CertCloseStore(storeHandle, 0);
-            throw KSException(__func__, __LINE__, GetLastError());
+    if (keyPair == nullptr) {
+        return;
+    }
+    CRYPT_KEY_PROV_INFO cryptKeyProvInfo = {
+            const_cast<LPWSTR>(keyPair->getName().c_str()),
+            const_cast<LPWSTR>(MS_KEY_STORAGE_PROVIDER),
+            0,
+            0,
+            0,
+            nullptr,
+            AT_SIGNATURE
+    };
+    if (!CertSetCertificateContextProperty(certContext,
+                                           CERT_KEY_PROV_INFO_PROP_ID,
+                                           0,
+                                           &cryptKeyProvInfo)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    DWORD keyHandle = (DWORD)keyPair->getHandle();
+    if (!CertSetCertificateContextProperty(certContext,
+                                           CERT_NCRYPT_KEY_HANDLE_PROP_ID,
+                                           0,
+                                           &keyHandle)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+}
+
+void CertificateStore::deleteLinkedKeys(const std::vector<PCCERT_CONTEXT> &certificates) {
+    std::set<std::wstring> keyNames;
+    for (auto cert : certificates) {
+        DWORD keyProvInfoLg = 0;
+        if (!CertGetCertificateContextProperty(cert, CERT_KEY_PROV_INFO_PROP_ID, nullptr, &keyProvInfoLg)) {
+            continue;
         }
-        DWORD keyHandle = (DWORD)keyPair->getHandle();
-        if (!CertSetCertificateContextProperty(certContext,
-                                               CERT_NCRYPT_KEY_HANDLE_PROP_ID,
-                                               0,
-                                               &keyHandle)) {
-            throw KSException(__func__, __LINE__, GetLastError());
+        std::vector<BYTE> keyProvInfo(keyProvInfoLg);
+        if (!CertGetCertificateContextProperty(cert, CERT_KEY_PROV_INFO_PROP_ID, keyProvInfo.data(), &keyProvInfoLg)) {
+            continue;
+        }
+        auto containerName = reinterpret_cast<CRYPT_KEY_PROV_INFO *>(keyProvInfo.data())->pwszContainerName;
+        if (containerName != nullptr) {
+            keyNames.insert(containerName);
+        }
+    }
+    for (const auto &keyName : keyNames) {
+        try {
+            keyStore.deleteKeyPair(keyName);
+        }
+        catch (const std::exception &e) {
+            LogEvent::GetInstance().error(0, e.what());
         }
     }
 }
@@ -175,18 +600,13 @@ std::string CertificateStore::createCertificateRequestFromCNG(const std::string
                              &b64CertReqLg);
         return std::string(b64CertReq.get(), b64CertReqLg);
     }
-    catch (KSException &e) {
+    catch (const KSException &) {
         keyStore.deleteKeyPair(keyPair->getName());
-        throw e;
+        throw;
     }
 }
 
-std::string CertificateStore::pfxExport(const std::string &issuer,
-                                        const std::string &serial,
-                                        const std::wstring &password) {
-    DWORD issuerNameLg = 0;
-
-    CERT_INFO certificateInfo{0x00};
+std::vector<BYTE> CertificateStore::parseSerial(const std::string &serial) {
     DWORD serialNumberLg;
     std::string tmpSerial(serial);
     if ((tmpSerial.rfind("0x", 0) == 0) ||
@@ -205,19 +625,23 @@ std::string CertificateStore::pfxExport(const std::string &issuer,
                               nullptr)) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
-    auto serialNumber = std::unique_ptr<BYTE[]>(new BYTE[serialNumberLg]);
+    std::vector<BYTE> serialNumber(serialNumberLg);
     CryptStringToBinaryA(tmpSerial.c_str(),
                          tmpSerial.size(),
                          CRYPT_STRING_HEX,
-                         serialNumber.get(),
+                         serialNumber.data(),
                          &serialNumberLg,
                          nullptr,
                          nullptr);
-    std::vector<BYTE> reversedSerNum(serialNumberLg);
-    for (int i=0; i<serialNumberLg; i++) {
-        reversedSerNum[serialNumberLg - 1 - i] = serialNumber[i];
-    }
-    certificateInfo.SerialNumber.cbData = serialNumberLg;
+    return serialNumber;
+}
+
+PCCERT_CONTEXT CertificateStore::findCertificate(const std::string &issuer, const std::string &serial) {
+    CERT_INFO certificateInfo{0x00};
+    // CryptoAPI keeps the serial number little endian
+    std::vector<BYTE> reversedSerNum = parseSerial(serial);
+    std::reverse(reversedSerNum.begin(), reversedSerNum.end());
+    certificateInfo.SerialNumber.cbData = (DWORD)reversedSerNum.size();
     certificateInfo.SerialNumber.pbData = reversedSerNum.data();
     // UTF8 Version test
     X509Name issuerName(issuer);
@@ -242,38 +666,139 @@ std::string CertificateStore::pfxExport(const std::string &issuer,
         }
     }
 
+    return certificateCtx;
+}
+
+/**
+ * Size of the PKCS12 export of the certificates of a store and the key of a certificate, on the high side
+ */
+static size_t estimatePfxSize(HCERTSTORE pfxStore, PCCERT_CONTEXT certificateCtx) {
+    size_t estimate = PFX_EXPORT_OVERHEAD;
+    PCCERT_CONTEXT pfxCertificateCtx = nullptr;
+    while ((pfxCertificateCtx = CertEnumCertificatesInStore(pfxStore, pfxCertificateCtx)) != nullptr) {
+        estimate += pfxCertificateCtx->cbCertEncoded + PFX_EXPORT_CERTIFICATE_OVERHEAD;
+    }
+    // An RSA private key with its CRT parameters is about 4.5 times its modulus, before the padding
+    DWORD keyBits = CertGetPublicKeyLength(X509_ASN_ENCODING, &certificateCtx->pCertInfo->SubjectPublicKeyInfo);
+    estimate += 6 * (((keyBits == 0) ? 4096 : keyBits) / 8);
+    return estimate;
+}
+
+std::string CertificateStore::pfxExport(const std::string &issuer,
+                                        const std::string &serial,
+                                        const std::wstring &password,
+                                        pfxEncryption encryption,
+                                        bool includeChain) {
+    return pfxExport(issuer, serial, password.c_str(), encryption, includeChain);
+}
+
+std::string CertificateStore::pfxExport(const std::string &issuer,
+                                        const std::string &serial,
+                                        const wchar_t *password,
+                                        pfxEncryption encryption,
+                                        bool includeChain) {
+    PCCERT_CONTEXT certificateCtx = findCertificate(issuer, serial);
+    try {
+        if (isRevoked(certificateCtx)) {
+            throw KSException(__func__, __LINE__, "Certificate is revoked");
+        }
+    }
+    catch (...) {
+        CertFreeCertificateContext(certificateCtx);
+        throw;
+    }
+
     HCERTSTORE pfxStore = CertOpenStore (CERT_STORE_PROV_MEMORY,
                                          0,
                                          0,
                                          0,
                                          nullptr);
     if (pfxStore == nullptr) {
+        CertFreeCertificateContext(certificateCtx);
         throw KSException(__func__, __LINE__, GetLastError());
     }
     if (!CertAddCertificateContextToStore(pfxStore,
                                           certificateCtx,
                                           CERT_STORE_ADD_USE_EXISTING,
                                           nullptr)) {
+        CertFreeCertificateContext(certificateCtx);
         CertCloseStore(pfxStore, 0);
         throw KSException(__func__, __LINE__, GetLastError());
     }
-    CRYPT_DATA_BLOB pfxData = {0, nullptr };
-    if (!PFXExportCertStore(pfxStore,
-                            &pfxData,
-                            password.c_str(),
-                            EXPORT_PRIVATE_KEYS)) {
-        CertCloseStore(pfxStore, 0);
-        throw KSException(__func__, __LINE__, GetLastError());
+    if (includeChain) {
+        try {
+            CertificateView certificate(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+            auto chain = getChain(certificate);
+            for (auto &issuerCert : chain->issuers) {
+                if (!CertAddEncodedCertificateToStore(pfxStore,
+                                                      X509_ASN_ENCODING,
+                                                      issuerCert->getEncoded().data,
+                                                      (DWORD)issuerCert->getEncoded().size,
+                                                      CERT_STORE_ADD_USE_EXISTING,
+                                                      nullptr)) {
+                    throw KSException(__func__, __LINE__, GetLastError());
+                }
+            }
+        }
+        catch (...) {
+            CertFreeCertificateContext(certificateCtx);
+            CertCloseStore(pfxStore, 0);
+            throw;
+        }
     }
-    auto pfxDataBuf = std::unique_ptr<BYTE[]>(new BYTE[pfxData.cbData]);
-    pfxData.pbData = pfxDataBuf.get();
-    if (!PFXExportCertStore(pfxStore,
-                            &pfxData,
-                            password.c_str(),
-                            EXPORT_PRIVATE_KEYS)) {
-        CertCloseStore(pfxStore, 0);
-        throw KSException(__func__, __LINE__, GetLastError());
+    // PFXExportCertStoreEx runs the complete key derivation and encryption even when it only
+    // has to report the size, so try to export in one pass with a buffer estimated from the certificates and the
+    // key size, and only retry with the exact size when the estimate is too small.
+    PKCS12_PBES2_EXPORT_PARAMS pbes2Params = {
+        sizeof(PKCS12_PBES2_EXPORT_PARAMS),
+        nullptr,
+        const_cast<PWSTR>(PKCS12_PBES2_ALG_AES256_SHA256)
+    };
+    DWORD exportFlags = EXPORT_PRIVATE_KEYS;
+    void *exportParams = nullptr;
+    if (encryption == pfxEncryption::AES256_SHA256) {
+        exportFlags |= PKCS12_EXPORT_PBES2_PARAMS;
+        exportParams = &pbes2Params;
+    }
+    std::vector<BYTE> pfxDataBuf(estimatePfxSize(pfxStore, certificateCtx));
+    CRYPT_DATA_BLOB pfxData = { (DWORD)pfxDataBuf.size(), pfxDataBuf.data() };
+    if (!PFXExportCertStoreEx(pfxStore,
+                              &pfxData,
+                              password,
+                              exportParams,
+                              exportFlags)) {
+        if (GetLastError() != ERROR_MORE_DATA) {
+            CertFreeCertificateContext(certificateCtx);
+            CertCloseStore(pfxStore, 0);
+            throw KSException(__func__, __LINE__, GetLastError());
+        }
+        // The failed export can report the size already, else it is asked for once
+        if (pfxData.cbData <= pfxDataBuf.size()) {
+            pfxData = { 0, nullptr };
+            if (!PFXExportCertStoreEx(pfxStore,
+                                      &pfxData,
+                                      password,
+                                      exportParams,
+                                      exportFlags)) {
+                CertFreeCertificateContext(certificateCtx);
+                CertCloseStore(pfxStore, 0);
+                throw KSException(__func__, __LINE__, GetLastError());
+            }
+        }
+        pfxDataBuf.resize(pfxData.cbData);
+        pfxData.pbData = pfxDataBuf.data();
+        if (!PFXExportCertStoreEx(pfxStore,
+                                  &pfxData,
+                                  password,
+                                  exportParams,
+                                  exportFlags)) {
+            CertFreeCertificateContext(certificateCtx);
+            CertCloseStore(pfxStore, 0);
+            throw KSException(__func__, __LINE__, GetLastError());
+        }
     }
+    CertFreeCertificateContext(certificateCtx);
+    CertCloseStore(pfxStore, 0);
     // TODO: replace with Base64Utils
     DWORD base64PfxDataLg = 0;
     if (!CryptBinaryToStringA(pfxData.pbData,
@@ -281,7 +806,6 @@ std::string CertificateStore::pfxExport(const std::string &issuer,
                               CRYPT_STRING_BASE64,
                               nullptr,
                               &base64PfxDataLg)) {
-        CertCloseStore(pfxStore, 0);
         throw KSException(__func__, __LINE__, GetLastError());
     }
     auto base64PfxData = std::unique_ptr<char[]>(new char[base64PfxDataLg]);
@@ -295,28 +819,183 @@ std::string CertificateStore::pfxExport(const std::string &issuer,
 
 bool CertificateStore::isCACertificate(PCCERT_CONTEXT certificateCtx)
 {
-    for (int i = 0; i < certificateCtx->pCertInfo->cExtension; i++)
-    {
-        if (strncmp(certificateCtx->pCertInfo->rgExtension[i].pszObjId, szOID_BASIC_CONSTRAINTS2, strlen(szOID_BASIC_CONSTRAINTS2)) == 0)
-        {
-            CERT_BASIC_CONSTRAINTS2_INFO info = { 0 };
-            DWORD size = sizeof(CERT_BASIC_CONSTRAINTS2_INFO);
-            CryptDecodeObject(X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
-                              szOID_BASIC_CONSTRAINTS2,
-                              certificateCtx->pCertInfo->rgExtension[i].Value.pbData,
-                              certificateCtx->pCertInfo->rgExtension[i].Value.cbData,
-                              0,
-                              &info,
-                              &size);
-            return (info.fCA == TRUE);
+    try {
+        CertificateView certificate(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+        return certificate.isCA();
+    }
+    catch (const std::invalid_argument &) {
+        // CryptoAPI decoded the certificate already, fall back to its extensions
+    }
+    PCERT_EXTENSION extension = CertFindExtension(szOID_BASIC_CONSTRAINTS2,
+                                                  certificateCtx->pCertInfo->cExtension,
+                                                  certificateCtx->pCertInfo->rgExtension);
+    if (extension == nullptr) {
+        return false;
+    }
+    CERT_BASIC_CONSTRAINTS2_INFO info = { 0 };
+    DWORD size = sizeof(CERT_BASIC_CONSTRAINTS2_INFO);
+    if (!CryptDecodeObject(X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
+                           szOID_BASIC_CONSTRAINTS2,
+                           extension->Value.pbData,
+                           extension->Value.cbData,
+                           0,
+                           &info,
+                           &size)) {
+        return false;
+    }
+    return (info.fCA == TRUE);
+}
+
+static bool isCertificateOf(KeyPair &keyPair, PCCERT_CONTEXT certificateCtx) {
+    return CertComparePublicKeyInfo(X509_ASN_ENCODING,
+                                    &certificateCtx->pCertInfo->SubjectPublicKeyInfo,
+                                    const_cast<CERT_PUBLIC_KEY_INFO *>(keyPair.getPublicKeyInfo())) != FALSE;
+}
+
+/**
+ * Whether a PEM file has a certificate of the key, in a CERTIFICATE or a PKCS7 block. Its CA certificates can be in
+ * the same file.
+ */
+static bool hasCertificateOf(KeyPair &keyPair, const char *pem, size_t pemLg) {
+    PemScanner scanner(pem, pemLg);
+    while (scanner.next()) {
+        if (scanner.label() == "CERTIFICATE") {
+            PCCERT_CONTEXT certificateCtx = CertCreateCertificateContext(X509_ASN_ENCODING,
+                                                                         scanner.data(),
+                                                                         (DWORD)scanner.size());
+            // A malformed certificate is reported by the import
+            if (certificateCtx == nullptr) {
+                continue;
+            }
+            bool matches = isCertificateOf(keyPair, certificateCtx);
+            CertFreeCertificateContext(certificateCtx);
+            if (matches) {
+                return true;
+            }
+        }
+        else if (scanner.label() == "PKCS7") {
+            CRYPT_DATA_BLOB pkcs7Blob = {(DWORD)scanner.size(), const_cast<BYTE *>(scanner.data())};
+            HCERTSTORE pkcs7Store = CertOpenStore(CERT_STORE_PROV_PKCS7,
+                                                  X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
+                                                  0,
+                                                  0,
+                                                  &pkcs7Blob);
+            if (pkcs7Store == nullptr) {
+                continue;
+            }
+            bool matches = false;
+            PCCERT_CONTEXT certificateCtx = nullptr;
+            while (!matches && (certificateCtx = CertEnumCertificatesInStore(pkcs7Store, certificateCtx)) != nullptr) {
+                matches = isCertificateOf(keyPair, certificateCtx);
+            }
+            if (certificateCtx != nullptr) {
+                CertFreeCertificateContext(certificateCtx);
+            }
+            CertCloseStore(pkcs7Store, 0);
+            if (matches) {
+                return true;
+            }
         }
     }
     return false;
 }
 
+std::string CertificateStore::importPkcs8(const unsigned char *pkcs8,
+                                          size_t pkcs8Lg,
+                                          const wchar_t *password,
+                                          const char *pemCertificate,
+                                          size_t pemCertificateLg,
+                                          bool forcePINPasswordProtection) {
+    unsigned char uuid[16];
+    char strUuid[UUID_STRING_LENGTH + 1];
+    wchar_t wstrUuid[UUID_STRING_LENGTH + 1];
+    Uuid::generate(Uuid::uuidVersion::V7, uuid);
+    Uuid::format(uuid, strUuid);
+    Uuid::format(uuid, wstrUuid);
+    std::wstring keyName(wstrUuid, UUID_STRING_LENGTH);
+
+    auto keyPair = keyStore.importPkcs8(keyName, pkcs8, pkcs8Lg, password, forcePINPasswordProtection);
+    invalidateIndex();
+    try {
+        if (pemCertificate != nullptr) {
+            if (!hasCertificateOf(*keyPair, pemCertificate, pemCertificateLg)) {
+                throw KSException(__func__, __LINE__, "Certificate does not match the key");
+            }
+            // The key is still open, so linking the certificate does not search the key store
+            importCertificate(pemCertificate, pemCertificateLg);
+        }
+        else {
+            CancellationToken::checkpoint();
+        }
+    }
+    catch (...) {
+        try {
+            keyStore.deleteKeyPair(keyName);
+        }
+        catch (const std::exception &e) {
+            LogEvent::GetInstance().error(0, e.what());
+        }
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        lastKeyId = keyName;
+    }
+
+    return std::string(strUuid, UUID_STRING_LENGTH);
+}
+
+CertificateStore::ExportedKey CertificateStore::exportPkcs8(const std::string &issuer,
+                                                            const std::string &serial,
+                                                            const wchar_t *password,
+                                                            uint32_t iterations) {
+    syncStores();
+    PCCERT_CONTEXT certificateCtx = findCertificate(issuer, serial);
+    ExportedKey exported;
+    try {
+        if (isRevoked(certificateCtx)) {
+            throw KSException(__func__, __LINE__, "Certificate is revoked");
+        }
+        DWORD keyProvInfoLg = 0;
+        if (!CertGetCertificateContextProperty(certificateCtx,
+                                               CERT_KEY_PROV_INFO_PROP_ID,
+                                               nullptr,
+                                               &keyProvInfoLg)) {
+            throw KSException(__func__, __LINE__, GetLastError());
+        }
+        std::vector<BYTE> keyProvInfo(keyProvInfoLg);
+        if (!CertGetCertificateContextProperty(certificateCtx,
+                                               CERT_KEY_PROV_INFO_PROP_ID,
+                                               keyProvInfo.data(),
+                                               &keyProvInfoLg)) {
+            throw KSException(__func__, __LINE__, GetLastError());
+        }
+        exported.pkcs8 = keyStore.exportPkcs8(
+                reinterpret_cast<CRYPT_KEY_PROV_INFO *>(keyProvInfo.data())->pwszContainerName,
+                password,
+                iterations);
+        exported.certificate.assign(certificateCtx->pbCertEncoded,
+                                    certificateCtx->pbCertEncoded + certificateCtx->cbCertEncoded);
+    }
+    catch (...) {
+        CertFreeCertificateContext(certificateCtx);
+        throw;
+    }
+    CertFreeCertificateContext(certificateCtx);
+
+    return exported;
+}
+
 void CertificateStore::pfxImport(const std::string &pfxInBase64,
                                  const std::wstring &password,
                                  bool forcePINPasswordProtection) {
+    pfxImport(pfxInBase64, password.c_str(), forcePINPasswordProtection);
+}
+
+void CertificateStore::pfxImport(const std::string &pfxInBase64,
+                                 const wchar_t *password,
+                                 bool forcePINPasswordProtection) {
     DWORD pfxLg = 0;
     if (!CryptStringToBinaryA(pfxInBase64.c_str(),
                               pfxInBase64.size(),
@@ -343,29 +1022,239 @@ void CertificateStore::pfxImport(const std::string &pfxInBase64,
     if (forcePINPasswordProtection) {
         dwFlags = dwFlags | CRYPT_USER_PROTECTED;
     }
+    CancellationToken::checkpoint();
+    auto start = std::chrono::steady_clock::now();
     HCERTSTORE pfxStore = PFXImportCertStore(&cryptDataBlob,
-                                             password.c_str(),
+                                             password,
                                              dwFlags);
     if (pfxStore == 0) {
         throw KSException(__func__, __LINE__, GetLastError());
     }
+    // Compared with keystore.import_pkcs8
+    auto import = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Metrics::GetInstance().record("keystore.import_pfx", static_cast<uint64_t>(import.count()));
+    // The keys of the PFX are in the key store now
+    invalidateIndex();
+    std::vector<PCCERT_CONTEXT> certificates;
     PCCERT_CONTEXT certificateCtx = nullptr;
-    while ( (certificateCtx = CertEnumCertificatesInStore(pfxStore, certificateCtx)) != nullptr )
-    {
-        if (isCACertificate(certificateCtx)) // Don't import CA Certificates
+    while ( (certificateCtx = CertEnumCertificatesInStore(pfxStore, certificateCtx)) != nullptr ) {
+        certificates.push_back(CertDuplicateCertificateContext(certificateCtx));
+    }
+
+    // Classify all certificates before touching the store, large bundles are split over the cores
+    std::set<std::string> thumbprints;
+    std::vector<std::string> certThumbprints(certificates.size());
+    std::vector<char> toImport(certificates.size(), 0);
+    std::vector<char> caCertificates(certificates.size(), 0);
+    std::vector<char> revoked(certificates.size(), 0);
+    // The workers do not inherit the cancellation token of this thread
+    auto token = CancellationToken::current();
+    auto classify = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (token) {
+                token->throwIfCancelled();
+            }
+            if (isCACertificate(certificates[i])) { // Don't import CA Certificates, only use them for chains
+                caCertificates[i] = 1;
+                continue;
+            }
+            revoked[i] = isRevoked(certificates[i]);
+            certThumbprints[i] = getThumbprint(certificates[i]);
+            bool present = (thumbprints.find(certThumbprints[i]) != thumbprints.end());
+            DWORD keyProvInfoLg = 0;
+            bool hasKey = CertGetCertificateContextProperty(certificates[i],
+                                                            CERT_KEY_PROV_INFO_PROP_ID,
+                                                            nullptr,
+                                                            &keyProvInfoLg);
+            // Certificates with a key are replaced to link them with the newly imported key
+            toImport[i] = (!present || hasKey);
+        }
+    };
+    size_t workers = (std::min)(static_cast<size_t>(std::thread::hardware_concurrency()),
+                                certificates.size() / PFX_PARALLEL_IMPORT_THRESHOLD);
+    try {
+        thumbprints = getThumbprints(storeHandle);
+        if (workers > 1) {
+            std::vector<std::future<void>> results;
+            size_t chunk = (certificates.size() + workers - 1) / workers;
+            for (size_t begin = 0; begin < certificates.size(); begin += chunk) {
+                results.push_back(std::async(std::launch::async,
+                                             classify,
+                                             begin,
+                                             (std::min)(begin + chunk, certificates.size())));
+            }
+            for (auto &result : results) {
+                result.get();
+            }
+        }
+        else {
+            classify(0, certificates.size());
+        }
+        if (std::find(revoked.begin(), revoked.end(), 1) != revoked.end()) {
+            throw KSException(__func__, __LINE__, "Certificate is revoked");
+        }
+        // Last point to back out before the store is changed
+        CancellationToken::checkpoint();
+    }
+    catch (...) {
+        // PFXImportCertStore persisted the keys of the PFX already, the key collector only removes host keys
+        deleteLinkedKeys(certificates);
+        for (auto cert : certificates) {
+            CertFreeCertificateContext(cert);
+        }
+        CertCloseStore(pfxStore, 0);
+        throw;
+    }
+
+    for (size_t i = 0; i < certificates.size(); i++) {
+        if (caCertificates[i]) {
+            addImportedIssuer(certificates[i]->pbCertEncoded, certificates[i]->cbCertEncoded);
+        }
+    }
+
+    // Commit, and remove the certificates added by this import again when one of them fails
+    std::vector<PCCERT_CONTEXT> added;
+    DWORD lastError = ERROR_SUCCESS;
+    for (size_t i = 0; i < certificates.size(); i++) {
+        if (!toImport[i])
             continue;
+        PCCERT_CONTEXT storeCtx = nullptr;
         if (!CertAddCertificateContextToStore(storeHandle,
-                                              certificateCtx,
+                                              certificates[i],
                                               CERT_STORE_ADD_REPLACE_EXISTING,
-                                              0)) {
-            CertCloseStore(pfxStore, 0);
-            throw KSException(__func__, __LINE__, GetLastError());
+                                              &storeCtx)) {
+            lastError = GetLastError();
+            break;
+        }
+        if (thumbprints.find(certThumbprints[i]) == thumbprints.end()) {
+            added.push_back(storeCtx);
         }
+        else {
+            CertFreeCertificateContext(storeCtx);
+        }
+    }
+    for (auto cert : certificates) {
+        CertFreeCertificateContext(cert);
     }
     CertCloseStore(pfxStore, 0);
+    if (lastError != ERROR_SUCCESS) {
+        for (auto cert : added) {
+            CertDeleteCertificateFromStore(cert);
+        }
+        throw KSException(__func__, __LINE__, lastError);
+    }
+    for (auto cert : added) {
+        CertFreeCertificateContext(cert);
+    }
+    invalidateIndex();
 }
 
-const std::wstring &CertificateStore::getLastKeyId() {
+std::string CertificateStore::getThumbprint(PCCERT_CONTEXT certificateCtx) {
+    BYTE hash[20];
+    DWORD hashLg = sizeof(hash);
+    if (!CertGetCertificateContextProperty(certificateCtx,
+                                           CERT_SHA1_HASH_PROP_ID,
+                                           hash,
+                                           &hashLg)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    return std::string(reinterpret_cast<char *>(hash), hashLg);
+}
+
+std::set<std::string> CertificateStore::getThumbprints(HCERTSTORE store) {
+    std::set<std::string> thumbprints;
+    PCCERT_CONTEXT certificateCtx = nullptr;
+    while ( (certificateCtx = CertEnumCertificatesInStore(store, certificateCtx)) != nullptr ) {
+        try {
+            thumbprints.insert(getThumbprint(certificateCtx));
+        }
+        catch (const KSException &) {
+            CertFreeCertificateContext(certificateCtx);
+            throw;
+        }
+    }
+    return thumbprints;
+}
+
+std::vector<std::vector<unsigned char>> CertificateStore::getChain(const std::string &issuer,
+                                                                   const std::string &serial) {
+    PCCERT_CONTEXT certificateCtx = findCertificate(issuer, serial);
+    std::vector<std::vector<unsigned char>> result;
+    try {
+        CertificateView certificate(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+        auto chain = getChain(certificate);
+        result.emplace_back(certificate.getEncoded().data,
+                            certificate.getEncoded().data + certificate.getEncoded().size);
+        for (auto &issuerCert : chain->issuers) {
+            result.emplace_back(issuerCert->getEncoded().data,
+                                issuerCert->getEncoded().data + issuerCert->getEncoded().size);
+        }
+    }
+    catch (...) {
+        CertFreeCertificateContext(certificateCtx);
+        throw;
+    }
+    CertFreeCertificateContext(certificateCtx);
+
+    return result;
+}
+
+std::shared_ptr<const ChainBuilder::Chain> CertificateStore::getChain(const CertificateView &certificate) {
+    syncStores();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!issuersLoaded) {
+            loadIssuers("CA");
+            loadIssuers("ROOT");
+            issuersLoaded = true;
+        }
+    }
+    return chainBuilder.getChain(certificate);
+}
+
+void CertificateStore::loadIssuers(const char *systemStore) {
+    HCERTSTORE store = CertOpenSystemStoreA(NULL, systemStore);
+    if (store == nullptr) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    PCCERT_CONTEXT certificateCtx = nullptr;
+    while ( (certificateCtx = CertEnumCertificatesInStore(store, certificateCtx)) != nullptr ) {
+        try {
+            chainBuilder.addIssuer(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+        }
+        catch (std::invalid_argument &) {
+            // Certificates we can't parse, can't be part of a chain
+        }
+    }
+    CertCloseStore(store, 0);
+}
+
+bool CertificateStore::verifySignature(const CertificateView &certificate, const CertificateView &issuer) {
+    PCCERT_CONTEXT issuerCtx = CertCreateCertificateContext(X509_ASN_ENCODING,
+                                                            issuer.getEncoded().data,
+                                                            (DWORD)issuer.getEncoded().size);
+    if (issuerCtx == nullptr) {
+        return false;
+    }
+    CRYPT_DATA_BLOB subject = {
+        (DWORD)certificate.getEncoded().size,
+        const_cast<BYTE *>(certificate.getEncoded().data)
+    };
+    BOOL verified = CryptVerifyCertificateSignatureEx(NULL,
+                                                      X509_ASN_ENCODING,
+                                                      CRYPT_VERIFY_CERT_SIGN_SUBJECT_BLOB,
+                                                      &subject,
+                                                      CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT,
+                                                      const_cast<CERT_CONTEXT *>(issuerCtx),
+                                                      0,
+                                                      nullptr);
+    CertFreeCertificateContext(issuerCtx);
+
+    return verified == TRUE;
+}
+
+std::wstring CertificateStore::getLastKeyId() {
+    std::lock_guard<std::mutex> guard(lock);
     return lastKeyId;
 }
 
@@ -436,4 +1325,257 @@ void CertificateStore::forcePasswordPINProtection(strongKeyProtection k) {
     }
 
     RegCloseKey(hRegKeyHandle);
-}
\ No newline at end of file
+}
+void CertificateStore::setRevocationChecker(std::shared_ptr<RevocationChecker> checker) {
+    std::atomic_store(&revocationChecker, checker);
+}
+
+RevocationIndex::revocationStatus CertificateStore::checkRevocation(const std::string &issuer,
+                                                                    const std::string &serial) {
+    auto checker = std::atomic_load(&revocationChecker);
+    if (!checker) {
+        throw KSException(__func__, __LINE__, "No CRL directory configured");
+    }
+    std::vector<BYTE> serialNumber = parseSerial(serial);
+    DerBlob serialBlob{serialNumber.data(), serialNumber.size()};
+    // UTF8 Version test
+    X509Name utf8Name(issuer);
+    auto status = checker->check(DerBlob{utf8Name.getEncodedBlob().pbData,
+                                         utf8Name.getEncodedBlob().cbData},
+                                 serialBlob);
+    if (status == RevocationIndex::revocationStatus::Unknown) {
+        // PrintableName Version test
+        X509Name printableName(issuer, false);
+        status = checker->check(DerBlob{printableName.getEncodedBlob().pbData,
+                                        printableName.getEncodedBlob().cbData},
+                                serialBlob);
+    }
+    return status;
+}
+
+bool CertificateStore::isRevoked(const CertificateView &certificate) {
+    auto checker = std::atomic_load(&revocationChecker);
+    if (!checker) {
+        return false;
+    }
+    return (checker->check(certificate.getIssuer(), certificate.getSerialNumber()) ==
+            RevocationIndex::revocationStatus::Revoked);
+}
+
+bool CertificateStore::isRevoked(PCCERT_CONTEXT certificateCtx) {
+    auto checker = std::atomic_load(&revocationChecker);
+    if (!checker) {
+        return false;
+    }
+    // Taken from CryptoAPI, which also decodes certificates that CertificateView rejects
+    const CERT_NAME_BLOB &issuer = certificateCtx->pCertInfo->Issuer;
+    const CRYPT_INTEGER_BLOB &serial = certificateCtx->pCertInfo->SerialNumber;
+    // CryptoAPI keeps the content octets of the serial number in little endian
+    std::vector<unsigned char> serialNumber(serial.pbData, serial.pbData + serial.cbData);
+    std::reverse(serialNumber.begin(), serialNumber.end());
+    return (checker->check(DerBlob{issuer.pbData, issuer.cbData},
+                           DerBlob{serialNumber.data(), serialNumber.size()}) ==
+            RevocationIndex::revocationStatus::Revoked);
+}
+
+namespace {
+    /**
+     * Host keys come from the key store, linked keys from the key provider info of the MY certificates
+     */
+    class StoreKeyBackend : public KeyCollector::Backend {
+    public:
+        StoreKeyBackend(KeyStore &keyStore, HCERTSTORE storeHandle, std::mutex &keyLinkLock) :
+                keyStore(keyStore), storeHandle(storeHandle), keyLinkLock(keyLinkLock) {
+        }
+
+        std::vector<KeyCollector::Key> listHostKeys() override {
+            return keyStore.listHostKeys();
+        }
+
+        std::set<std::wstring> listLinkedKeys() override {
+            std::set<std::wstring> linked;
+            PCCERT_CONTEXT certificateCtx = nullptr;
+            while ((certificateCtx = CertEnumCertificatesInStore(storeHandle, certificateCtx)) != nullptr) {
+                DWORD size = 0;
+                if (!CertGetCertificateContextProperty(certificateCtx, CERT_KEY_PROV_INFO_PROP_ID, nullptr, &size)) {
+                    continue;
+                }
+                std::vector<BYTE> buffer(size);
+                if (!CertGetCertificateContextProperty(certificateCtx, CERT_KEY_PROV_INFO_PROP_ID, buffer.data(), &size)) {
+                    continue;
+                }
+                auto keyProvInfo = reinterpret_cast<CRYPT_KEY_PROV_INFO *>(buffer.data());
+                if (keyProvInfo->pwszContainerName != nullptr) {
+                    linked.insert(keyProvInfo->pwszContainerName);
+                }
+            }
+            return linked;
+        }
+
+        bool deleteOrphanKey(const std::wstring &name) override {
+            // An import can have linked the key while the collector paused between its batches
+            std::lock_guard<std::mutex> guard(keyLinkLock);
+            auto linked = listLinkedKeys();
+            if (linked.find(name) != linked.end()) {
+                return false;
+            }
+            keyStore.deleteKeyPair(name);
+            return true;
+        }
+
+    private:
+        KeyStore &keyStore;
+        HCERTSTORE storeHandle;
+        std::mutex &keyLinkLock;
+    };
+}
+
+size_t CertificateStore::collectOrphanKeys(std::chrono::seconds minimumAge) {
+    if (minimumAge < KEY_COLLECTOR_LOWEST_AGE) {
+        // Younger keys can still be waiting for the certificate of their CSR
+        throw std::invalid_argument("minimum age of orphaned keys is below KEY_COLLECTOR_LOWEST_AGE");
+    }
+    StoreKeyBackend backend(keyStore, storeHandle, keyLinkLock);
+    KeyCollector collector(backend, minimumAge);
+    size_t deleted = collector.collect();
+    if (deleted > 0) {
+        invalidateIndex();
+    }
+
+    return deleted;
+}
+
+static std::string toHex(const BYTE *data, size_t size) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (size_t i = 0; i < size; i++) {
+        hex.push_back(digits[data[i] >> 4]);
+        hex.push_back(digits[data[i] & 0x0F]);
+    }
+    return hex;
+}
+
+static std::string toUtf8(const wchar_t *value, size_t size) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "UTF-16 wide strings");
+    std::string utf8(size * 3, '\0');
+    utf8.resize(Utf8Utils::toUtf8(reinterpret_cast<const char16_t *>(value), size, &utf8[0]));
+    return utf8;
+}
+
+static std::string toUtf8(const std::wstring &value) {
+    return toUtf8(value.data(), value.size());
+}
+
+static std::string nameToString(const CERT_NAME_BLOB &name) {
+    DWORD flags = CERT_X500_NAME_STR | CERT_NAME_STR_NO_QUOTING_FLAG;
+    DWORD nameLg = CertNameToStrW(X509_ASN_ENCODING, const_cast<CERT_NAME_BLOB *>(&name), flags, nullptr, 0);
+    std::vector<wchar_t> value(nameLg + 1, L'\0');
+    CertNameToStrW(X509_ASN_ENCODING, const_cast<CERT_NAME_BLOB *>(&name), flags, value.data(), nameLg);
+    // Without the terminating zero
+    return toUtf8(value.data(), nameLg > 0 ? nameLg - 1 : 0);
+}
+
+void CertificateStore::invalidateIndex() {
+    std::lock_guard<std::mutex> guard(lock);
+    indexStale = true;
+}
+
+void CertificateStore::refreshIndex() {
+    syncStores();
+    std::lock_guard<std::mutex> guard(lock);
+    if (!indexStale) {
+        return;
+    }
+    // Only certificates which are new since the last refresh are decoded
+    std::vector<StoreIndex::Certificate> certificates;
+    std::map<std::string, std::string> keyCertificates;
+    Digest sha256(Digest::hashAlgorithm::Sha256);
+    PCCERT_CONTEXT certificateCtx = nullptr;
+    while ((certificateCtx = CertEnumCertificatesInStore(storeHandle, certificateCtx)) != nullptr) {
+        StoreIndex::Certificate certificate;
+        try {
+            std::string thumbprint = getThumbprint(certificateCtx);
+            thumbprint = toHex(reinterpret_cast<const BYTE *>(thumbprint.data()), thumbprint.size());
+            if (!storeIndex.getCertificate(thumbprint, certificate)) {
+                CertificateView view(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+                certificate.thumbprint = thumbprint;
+                certificate.subject = nameToString(certificateCtx->pCertInfo->Subject);
+                certificate.issuer = nameToString(certificateCtx->pCertInfo->Issuer);
+                certificate.serialNumber = toHex(view.getSerialNumber().data, view.getSerialNumber().size);
+                certificate.notBefore = view.getNotBefore();
+                certificate.notAfter = view.getNotAfter();
+                BYTE fingerprint[32];
+                sha256.update(certificateCtx->pbCertEncoded, certificateCtx->cbCertEncoded);
+                sha256.finish(fingerprint, sizeof(fingerprint));
+                certificate.fingerprint = toHex(fingerprint, sizeof(fingerprint));
+            }
+            // The key link is read again, it changes when the certificate is imported with a new key
+            certificate.keyName.clear();
+            DWORD keyProvInfoLg = 0;
+            if (CertGetCertificateContextProperty(certificateCtx,
+                                                  CERT_KEY_PROV_INFO_PROP_ID,
+                                                  nullptr,
+                                                  &keyProvInfoLg)) {
+                std::vector<BYTE> keyProvInfo(keyProvInfoLg);
+                if (CertGetCertificateContextProperty(certificateCtx,
+                                                      CERT_KEY_PROV_INFO_PROP_ID,
+                                                      keyProvInfo.data(),
+                                                      &keyProvInfoLg)) {
+                    auto info = reinterpret_cast<CRYPT_KEY_PROV_INFO *>(keyProvInfo.data());
+                    if (info->pwszContainerName != nullptr) {
+                        certificate.keyName = toUtf8(info->pwszContainerName);
+                    }
+                }
+            }
+        }
+        catch (std::invalid_argument &) {
+            // Malformed certificates, and certificates linked to a key name which is not valid UTF-16, are not listed
+            continue;
+        }
+        catch (...) {
+            CertFreeCertificateContext(certificateCtx);
+            throw;
+        }
+        if (!certificate.keyName.empty()) {
+            keyCertificates[certificate.keyName] = certificate.thumbprint;
+        }
+        certificates.push_back(certificate);
+    }
+
+    std::vector<StoreIndex::Key> keys;
+    for (auto &key : keyStore.listKeys()) {
+        std::string name;
+        std::string algorithm;
+        try {
+            name = toUtf8(key.first);
+            algorithm = toUtf8(key.second);
+        }
+        catch (std::invalid_argument &) {
+            // Key names which are not valid UTF-16 are not listed
+            continue;
+        }
+        auto linked = keyCertificates.find(name);
+        keys.push_back(StoreIndex::Key{name,
+                                       algorithm,
+                                       linked != keyCertificates.end() ? linked->second : std::string()});
+    }
+
+    storeIndex.setCertificates(certificates);
+    storeIndex.setKeys(keys);
+    indexStale = false;
+}
+
+StoreIndex::Page<StoreIndex::Certificate> CertificateStore::listCertificates(const StoreIndex::CertificateFilter &filter,
+                                                                             const std::string &cursor,
+                                                                             size_t pageSize) {
+    refreshIndex();
+    return storeIndex.listCertificates(filter, cursor, pageSize);
+}
+
+StoreIndex::Page<StoreIndex::Key> CertificateStore::listKeys(const StoreIndex::KeyFilter &filter,
+                                                             const std::string &cursor,
+                                                             size_t pageSize) {
+    refreshIndex();
+    return storeIndex.listKeys(filter, cursor, pageSize);
+}
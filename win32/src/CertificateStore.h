@@ -9,8 +9,21 @@
 #define KSMGMNT_CERTIFICATESTORE_H
 #include "common.h"
 #include <string>
+#include <set>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <wincrypt.h>
 #include "KeyStore.h"
+#include "ChainBuilder.h"
+#include "RevocationChecker.h"
+#include "KeyCollector.h"
+#include "Pkcs8.h"
+#include "StoreIndex.h"
+#include "StoreWatcher.h"
+
+// Maximum number of certificate requests created by one createCertificateRequests call
+#define CSR_BATCH_MAX_REQUESTS 16
 
 class CertificateStore {
 
@@ -40,33 +53,159 @@ public:
                                          size_t bitLength,
                                          bool forcePINPasswordProtection = false);
 
+    struct RequestTemplate {
+        std::string subjectName;
+        size_t bitLength;
+    };
+
+    struct GeneratedRequest {
+        std::string keyName;
+        std::string request;    // PEM encoded CSR
+    };
+
     /**
-     * Import the certificate into the KeyStore and link it to the CNG key
+     * Create several certificate requests at once, the keys are generated concurrently on the cores of the
+     * machine, so the batch takes about as long as its slowest key. Either all requests are created, or none of
+     * their keys are kept.
+     * @param requests at most CSR_BATCH_MAX_REQUESTS
+     * @return the requests in the order of the templates
+     */
+    std::vector<GeneratedRequest> createCertificateRequests(const std::vector<RequestTemplate> &requests,
+                                                            bool forcePINPasswordProtection = false);
+
+    /**
+     * Import the certificates of a PEM file into the KeyStore and link them to their CNG key. The file can be a
+     * bundle of CERTIFICATE and PKCS7 (certificates only) blocks, which are imported all or none.
      * @param pemCert
      */
     void importCertificate(const std::string &pemCert);
 
+    /**
+     * @param pem PEM file, which is read without copying it
+     */
+    void importCertificate(const char *pem, size_t pemLg);
+
+    // Password based encryption used to protect the exported PFX
+    enum class pfxEncryption {
+        TripleDES_SHA1 = 0,  // PKCS12 PBE with 3DES and SHA1 MAC (default of PFXExportCertStore)
+        AES256_SHA256        // PBES2 with PBKDF2, AES256-CBC and SHA256 MAC
+    };
+
     /**
      * Export the Micrsoft PFX file (PKCS12)
      * @param issuer This is the CA of the certificate
      * @param serial This is the hex string of the certificate to export
-     * @param Password to use to export the certificate
+     * @param Password to use to export the certificate, zero terminated (a SecureWideString keeps it in locked memory)
+     * @param encryption algorithms used to protect the key and the MAC of the PFX
+     * @param includeChain add the CA certificates of the chain to the PFX
      */
-    std::string pfxExport(const std::string &issuer, const std::string &serial, const std::wstring &password);
+    std::string pfxExport(const std::string &issuer,
+                          const std::string &serial,
+                          const wchar_t *password,
+                          pfxEncryption encryption = pfxEncryption::TripleDES_SHA1,
+                          bool includeChain = false);
+
+    std::string pfxExport(const std::string &issuer,
+                          const std::string &serial,
+                          const std::wstring &password,
+                          pfxEncryption encryption = pfxEncryption::TripleDES_SHA1,
+                          bool includeChain = false);
 
     /**
      * Import the Micrsoft PFX file (PKCS12)
      * @param pfxInBase64 is the PFX(PKCS12) data in base64 format
-     * @param Password to use to import the certificate
+     * @param Password to use to import the certificate, zero terminated
      * @param Use to choose an own password
      */
+    void pfxImport(const std::string &pfxInBase64,
+                   const wchar_t *password,
+                   bool forcePINPasswordProtection = false);
+
     void pfxImport(const std::string &pfxInBase64,
                    const std::wstring &password,
                    bool forcePINPasswordProtection = false);
+
+    /**
+     * Import an encrypted PKCS#8 private key, with its certificate when it has one. This is lighter than a PFX:
+     * there is no MAC or bag structure, and no temporary certificate store.
+     * @param pkcs8 DER encoded EncryptedPrivateKeyInfo, PBES2 (PBKDF2 with AES-CBC) or PKCS12 triple DES
+     * @param password zero terminated
+     * @param pemCertificate PEM file with the certificate of the key and optionally its CA, nullptr without
+     * certificate. The key is deleted again when the certificate is not imported.
+     * @return the name of the imported key
+     */
+    std::string importPkcs8(const unsigned char *pkcs8,
+                            size_t pkcs8Lg,
+                            const wchar_t *password,
+                            const char *pemCertificate,
+                            size_t pemCertificateLg,
+                            bool forcePINPasswordProtection = false);
+
+    struct ExportedKey {
+        std::vector<unsigned char> pkcs8;           // DER encoded EncryptedPrivateKeyInfo
+        std::vector<unsigned char> certificate;     // DER encoded certificate
+    };
+
+    /**
+     * Export the key of a certificate as encrypted PKCS#8, with PBES2, PBKDF2-HMAC-SHA256 and AES256-CBC
+     * @param issuer This is the CA of the certificate
+     * @param serial This is the hex string of the certificate to export
+     * @param password zero terminated
+     * @param iterations PBKDF2 iterations, PKCS8_MIN_ITERATIONS up to PKCS8_MAX_ITERATIONS
+     */
+    ExportedKey exportPkcs8(const std::string &issuer,
+                            const std::string &serial,
+                            const wchar_t *password,
+                            uint32_t iterations = PKCS8_DEFAULT_ITERATIONS);
+
+    /**
+     * Build the certificate chain from the CA and ROOT stores and the CA certificates of imported PFX files
+     * @param issuer This is the CA of the certificate
+     * @param serial This is the hex string of the certificate
+     * @return DER encoded certificates, starting with the certificate itself
+     */
+    std::vector<std::vector<unsigned char>> getChain(const std::string &issuer, const std::string &serial);
+
+    /**
+     * Check certificates against the CRLs of a RevocationChecker, revoked certificates are refused by
+     * importCertificate, pfxImport and pfxExport
+     */
+    void setRevocationChecker(std::shared_ptr<RevocationChecker> checker);
+
+    /**
+     * @param issuer This is the CA of the certificate
+     * @param serial This is the hex string of the certificate
+     */
+    RevocationIndex::revocationStatus checkRevocation(const std::string &issuer, const std::string &serial);
+
+    /**
+     * List the certificates of the MY store, from an index which is only rebuilt after the store changed
+     * @param cursor cursor of the previous page, empty for the first page
+     * @param pageSize 0 for the default page size
+     */
+    StoreIndex::Page<StoreIndex::Certificate> listCertificates(const StoreIndex::CertificateFilter &filter,
+                                                               const std::string &cursor,
+                                                               size_t pageSize);
+
+    /**
+     * List the keys of the key store, with the certificate they are linked to
+     */
+    StoreIndex::Page<StoreIndex::Key> listKeys(const StoreIndex::KeyFilter &filter,
+                                               const std::string &cursor,
+                                               size_t pageSize);
+
+    /**
+     * Delete the keys created by createCertificateRequest which did not get a certificate
+     * @param minimumAge keys younger than this are kept
+     * throws std::invalid_argument when minimumAge is below KEY_COLLECTOR_LOWEST_AGE
+     * @return the number of deleted keys
+     */
+    size_t collectOrphanKeys(std::chrono::seconds minimumAge = KEY_COLLECTOR_MINIMUM_AGE);
+
     /**
      * return the last CNG key created so it can be deleted during tests if necessary
      */
-    const std::wstring &getLastKeyId();
+    std::wstring getLastKeyId();
 
     // https://docs.microsoft.com/en-us/windows/security/threat-protection/security-policy-settings/system-cryptography-force-strong-key-protection-for-user-keys-stored-on-the-computer
     enum class strongKeyProtection {
@@ -83,13 +222,77 @@ public:
 private:
     std::string createCertificateRequestFromCNG(const std::string &subjectName, KeyPair *keyPair);
 
+    void stageCertificate(HCERTSTORE staging, const BYTE *cert, DWORD certLg);
+
+    void stagePkcs7(HCERTSTORE staging, const BYTE *pkcs7, DWORD pkcs7Lg);
+
+    void linkKey(PCCERT_CONTEXT certContext);
+
+    void deleteLinkedKeys(const std::vector<PCCERT_CONTEXT> &certificates);
+
+    PCCERT_CONTEXT findCertificate(const std::string &issuer, const std::string &serial);
+
+    std::shared_ptr<const ChainBuilder::Chain> getChain(const CertificateView &certificate);
+
+    void loadIssuers(const char *systemStore);
+
+    bool isRevoked(const CertificateView &certificate);
+
+    bool isRevoked(PCCERT_CONTEXT certificateCtx);
+
+    static std::vector<BYTE> parseSerial(const std::string &serial);
+
+    static bool verifySignature(const CertificateView &certificate, const CertificateView &issuer);
+
+    void refreshIndex();
+
+    void invalidateIndex();
+
+    void watchStores(bool softwareProvider);
+
+    void syncStores();
+
+    void addImportedIssuer(const BYTE *cert, DWORD certLg);
+
     KeyStore keyStore;
 
+    ChainBuilder chainBuilder;
+
+    bool issuersLoaded;
+
+    std::shared_ptr<RevocationChecker> revocationChecker;
+
+    StoreIndex storeIndex;
+
+    bool indexStale;
+
+    // Changes of other processes to the stores, the caches above are checked against it before they are used
+    StoreWatcher storeWatcher;
+
+    uint64_t certificatesGeneration;
+
+    uint64_t issuersGeneration;
+
+    uint64_t keysGeneration;
+
+    // CA certificates of imports which are not in the CA or ROOT stores, they are kept when the issuers are reloaded
+    std::vector<std::vector<unsigned char>> importedIssuers;
+
+    // The store can be shared by the requests of a broker, this guards the lazily loaded issuers and index, and lastKeyId
+    std::mutex lock;
+
+    // Linking a key to a certificate and deleting an orphaned key exclude each other
+    std::mutex keyLinkLock;
+
     std::wstring lastKeyId;
 
     HCERTSTORE storeHandle;
 
-    bool isCACertificate(PCCERT_CONTEXT certificateCtx);
+    static bool isCACertificate(PCCERT_CONTEXT certificateCtx);
+
+    static std::string getThumbprint(PCCERT_CONTEXT certificateCtx);
+
+    static std::set<std::string> getThumbprints(HCERTSTORE store);
 };
 
 
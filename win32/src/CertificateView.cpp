@@ -0,0 +1,301 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "CertificateView.h"
+
+// DER encoded contents of the extension OIDs
+static const unsigned char OID_BASIC_CONSTRAINTS[] = { 0x55, 0x1D, 0x13 };
+static const unsigned char OID_KEY_USAGE[] = { 0x55, 0x1D, 0x0F };
+static const unsigned char OID_SUBJECT_KEY_IDENTIFIER[] = { 0x55, 0x1D, 0x0E };
+static const unsigned char OID_AUTHORITY_KEY_IDENTIFIER[] = { 0x55, 0x1D, 0x23 };
+
+CertificateView::CertificateView(const unsigned char *data, size_t size) :
+        version{1},
+        notBefore{0},
+        notAfter{0},
+        basicConstraintsDecoded{false},
+        ca{false},
+        pathLength{-1},
+        keyUsageDecoded{false},
+        keyUsagePresent{false},
+        keyUsage{0},
+        keyIdentifiersDecoded{false},
+        subjectKeyIdentifier{nullptr, 0},
+        authorityKeyIdentifier{nullptr, 0} {
+    DerReader outer(data, size);
+    auto certificate = outer.read(DER_SEQUENCE);
+    if (!outer.atEnd()) {
+        throw std::invalid_argument("Certificate: trailing data");
+    }
+    encoded = certificate.encoded;
+
+    DerReader certificateReader(certificate.content);
+    auto tbsElement = certificateReader.read(DER_SEQUENCE);
+    tbs = tbsElement.encoded;
+    certificateReader.read(DER_SEQUENCE);   // signatureAlgorithm
+    certificateReader.read(DER_BIT_STRING); // signatureValue
+
+    DerReader tbsReader(tbsElement.content);
+    DerElement element;
+    if (tbsReader.readOptional(DER_CONTEXT(0), element)) {
+        DerReader versionReader(element.content);
+        auto versionElement = versionReader.read(DER_INTEGER);
+        if (versionElement.content.size != 1) {
+            throw std::invalid_argument("Certificate: invalid version");
+        }
+        version = versionElement.content.data[0] + 1;
+    }
+    serialNumber = tbsReader.read(DER_INTEGER).content;
+    tbsReader.read(DER_SEQUENCE);           // signature
+    issuer = tbsReader.read(DER_SEQUENCE).encoded;
+    auto validity = tbsReader.read(DER_SEQUENCE);
+    DerReader validityReader(validity.content);
+    notBefore = toTime(validityReader.read());
+    notAfter = toTime(validityReader.read());
+    subject = tbsReader.read(DER_SEQUENCE).encoded;
+    subjectPublicKeyInfo = tbsReader.read(DER_SEQUENCE).encoded;
+    // issuerUniqueID and subjectUniqueID are ignored
+    if (!tbsReader.readOptional(DER_CONTEXT_PRIM(1), element)) {
+        tbsReader.readOptional(DER_CONTEXT(1), element);
+    }
+    if (!tbsReader.readOptional(DER_CONTEXT_PRIM(2), element)) {
+        tbsReader.readOptional(DER_CONTEXT(2), element);
+    }
+    if (tbsReader.readOptional(DER_CONTEXT(3), element)) {
+        DerReader extensionsReader(element.content);
+        DerReader extensionListReader(extensionsReader.read(DER_SEQUENCE).content);
+        while (!extensionListReader.atEnd()) {
+            DerReader extensionReader(extensionListReader.read(DER_SEQUENCE).content);
+            Extension extension;
+            extension.oid = extensionReader.read(DER_OID).content;
+            extension.critical = false;
+            DerElement critical;
+            if (extensionReader.readOptional(DER_BOOLEAN, critical)) {
+                extension.critical = (critical.content.size == 1) && (critical.content.data[0] != 0);
+            }
+            extension.value = extensionReader.read(DER_OCTET_STRING).content;
+            extensions.push_back(extension);
+        }
+    }
+}
+
+const DerBlob &CertificateView::getEncoded() const {
+    return encoded;
+}
+
+const DerBlob &CertificateView::getTBS() const {
+    return tbs;
+}
+
+int CertificateView::getVersion() const {
+    return version;
+}
+
+const DerBlob &CertificateView::getSerialNumber() const {
+    return serialNumber;
+}
+
+const DerBlob &CertificateView::getIssuer() const {
+    return issuer;
+}
+
+const DerBlob &CertificateView::getSubject() const {
+    return subject;
+}
+
+std::time_t CertificateView::getNotBefore() const {
+    return notBefore;
+}
+
+std::time_t CertificateView::getNotAfter() const {
+    return notAfter;
+}
+
+const DerBlob &CertificateView::getSubjectPublicKeyInfo() const {
+    return subjectPublicKeyInfo;
+}
+
+const std::vector<CertificateView::Extension> &CertificateView::getExtensions() const {
+    return extensions;
+}
+
+const CertificateView::Extension *CertificateView::findExtension(const DerBlob &oid) const {
+    for (auto &extension : extensions) {
+        if (extension.oid == oid) {
+            return &extension;
+        }
+    }
+    return nullptr;
+}
+
+bool CertificateView::isCA() const {
+    decodeBasicConstraints();
+    return ca;
+}
+
+int CertificateView::getPathLength() const {
+    decodeBasicConstraints();
+    return pathLength;
+}
+
+unsigned int CertificateView::getKeyUsage() const {
+    decodeKeyUsage();
+    return keyUsage;
+}
+
+bool CertificateView::hasKeyUsage() const {
+    decodeKeyUsage();
+    return keyUsagePresent;
+}
+
+const DerBlob &CertificateView::getSubjectKeyIdentifier() const {
+    decodeKeyIdentifiers();
+    return subjectKeyIdentifier;
+}
+
+const DerBlob &CertificateView::getAuthorityKeyIdentifier() const {
+    decodeKeyIdentifiers();
+    return authorityKeyIdentifier;
+}
+
+void CertificateView::decodeBasicConstraints() const {
+    if (basicConstraintsDecoded)
+        return;
+    auto extension = findExtension({ OID_BASIC_CONSTRAINTS, sizeof(OID_BASIC_CONSTRAINTS) });
+    if (extension != nullptr) {
+        DerReader reader(extension->value);
+        DerReader constraintsReader(reader.read(DER_SEQUENCE).content);
+        DerElement element;
+        if (constraintsReader.readOptional(DER_BOOLEAN, element)) {
+            ca = (element.content.size == 1) && (element.content.data[0] != 0);
+        }
+        if (constraintsReader.readOptional(DER_INTEGER, element)) {
+            if ((element.content.size == 0) || (element.content.size > 2)) {
+                throw std::invalid_argument("Certificate: invalid path length");
+            }
+            pathLength = 0;
+            for (size_t i = 0; i < element.content.size; i++) {
+                pathLength = (pathLength << 8) | element.content.data[i];
+            }
+        }
+    }
+    basicConstraintsDecoded = true;
+}
+
+void CertificateView::decodeKeyUsage() const {
+    if (keyUsageDecoded)
+        return;
+    auto extension = findExtension({ OID_KEY_USAGE, sizeof(OID_KEY_USAGE) });
+    if (extension != nullptr) {
+        DerReader reader(extension->value);
+        auto bits = reader.read(DER_BIT_STRING).content;
+        if (bits.size == 0) {
+            throw std::invalid_argument("Certificate: invalid key usage");
+        }
+        // bit 0 is the most significant bit of the first byte after the unused bits count
+        for (size_t bit = 0; bit < 9; bit++) {
+            size_t index = 1 + bit / 8;
+            if ((index < bits.size) && (bits.data[index] & (0x80 >> (bit % 8)))) {
+                keyUsage |= (1u << bit);
+            }
+        }
+        keyUsagePresent = true;
+    }
+    keyUsageDecoded = true;
+}
+
+void CertificateView::decodeKeyIdentifiers() const {
+    if (keyIdentifiersDecoded)
+        return;
+    auto extension = findExtension({ OID_SUBJECT_KEY_IDENTIFIER, sizeof(OID_SUBJECT_KEY_IDENTIFIER) });
+    if (extension != nullptr) {
+        DerReader reader(extension->value);
+        subjectKeyIdentifier = reader.read(DER_OCTET_STRING).content;
+    }
+    extension = findExtension({ OID_AUTHORITY_KEY_IDENTIFIER, sizeof(OID_AUTHORITY_KEY_IDENTIFIER) });
+    if (extension != nullptr) {
+        DerReader reader(extension->value);
+        DerReader identifierReader(reader.read(DER_SEQUENCE).content);
+        DerElement element;
+        if (identifierReader.readOptional(DER_CONTEXT_PRIM(0), element)) {
+            authorityKeyIdentifier = element.content;
+        }
+    }
+    keyIdentifiersDecoded = true;
+}
+
+static int toDigits(const unsigned char *digits, size_t count) {
+    int value = 0;
+    for (size_t i = 0; i < count; i++) {
+        if ((digits[i] < '0') || (digits[i] > '9')) {
+            throw std::invalid_argument("Certificate: invalid time");
+        }
+        value = value * 10 + (digits[i] - '0');
+    }
+    return value;
+}
+
+std::time_t CertificateView::toTime(const DerElement &time) {
+    const unsigned char *digits = time.content.data;
+    int year;
+    if ((time.tag == DER_UTC_TIME) && (time.content.size == 13)) {
+        year = toDigits(digits, 2);
+        year += (year < 50) ? 2000 : 1900;
+        digits += 2;
+    }
+    else if ((time.tag == DER_GENERALIZED_TIME) && (time.content.size == 15)) {
+        year = toDigits(digits, 4);
+        digits += 4;
+    }
+    else {
+        throw std::invalid_argument("Certificate: unsupported time format");
+    }
+    if (digits[10] != 'Z') {
+        throw std::invalid_argument("Certificate: time is not in UTC");
+    }
+    int month = toDigits(digits, 2);
+    int day = toDigits(digits + 2, 2);
+    int hour = toDigits(digits + 4, 2);
+    int minute = toDigits(digits + 6, 2);
+    int second = toDigits(digits + 8, 2);
+    if ((month < 1) || (month > 12) || (day < 1) || (day > 31)) {
+        throw std::invalid_argument("Certificate: invalid date");
+    }
+
+    // Days since the epoch of the proleptic Gregorian calendar
+    int y = year - (month <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long long days = static_cast<long long>(era) * 146097 + dayOfEra - 719468;
+
+    return static_cast<std::time_t>(days * 86400 + hour * 3600 + minute * 60 + second);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_CERTIFICATEVIEW_H
+#define KSMGMNT_CERTIFICATEVIEW_H
+#include <ctime>
+#include <vector>
+#include "DerReader.h"
+
+// Key usage bits as they are numbered in RFC 5280
+#define KU_DIGITAL_SIGNATURE  0x0001
+#define KU_NON_REPUDIATION    0x0002
+#define KU_KEY_ENCIPHERMENT   0x0004
+#define KU_DATA_ENCIPHERMENT  0x0008
+#define KU_KEY_AGREEMENT      0x0010
+#define KU_KEY_CERT_SIGN      0x0020
+#define KU_CRL_SIGN           0x0040
+#define KU_ENCIPHER_ONLY      0x0080
+#define KU_DECIPHER_ONLY      0x0100
+
+/**
+ * Read-only view on a DER encoded X509 certificate. The certificate is parsed once in the
+ * constructor, the extensions are only decoded when they are asked for and then cached.
+ * The view does not copy the data, so the encoded certificate must outlive the view.
+ */
+class CertificateView {
+public:
+    struct Extension {
+        DerBlob oid;
+        bool critical;
+        DerBlob value;
+    };
+
+    /**
+     * Parse the certificate
+     * @param data DER encoded certificate
+     * @param size length of the encoded certificate
+     * throws std::invalid_argument when the certificate is malformed
+     */
+    CertificateView(const unsigned char *data, size_t size);
+
+    /**
+     * The complete DER encoding of the certificate
+     */
+    const DerBlob &getEncoded() const;
+
+    /**
+     * The DER encoding of the to be signed part of the certificate
+     */
+    const DerBlob &getTBS() const;
+
+    /**
+     * Version of the certificate (1, 2 or 3)
+     */
+    int getVersion() const;
+
+    /**
+     * Content octets of the serial number (big endian, as encoded)
+     */
+    const DerBlob &getSerialNumber() const;
+
+    /**
+     * DER encoded issuer and subject names
+     */
+    const DerBlob &getIssuer() const;
+
+    const DerBlob &getSubject() const;
+
+    /**
+     * Validity period in seconds since the epoch (UTC)
+     */
+    std::time_t getNotBefore() const;
+
+    std::time_t getNotAfter() const;
+
+    /**
+     * DER encoded SubjectPublicKeyInfo
+     */
+    const DerBlob &getSubjectPublicKeyInfo() const;
+
+    const std::vector<Extension> &getExtensions() const;
+
+    /**
+     * Find an extension by its DER encoded OID content
+     * @return nullptr when the extension is not present
+     */
+    const Extension *findExtension(const DerBlob &oid) const;
+
+    /**
+     * Basic constraints, a missing extension is an end entity certificate
+     */
+    bool isCA() const;
+
+    /**
+     * Path length constraint of a CA, -1 when not limited
+     */
+    int getPathLength() const;
+
+    /**
+     * Key usage bits (KU_*), 0 when the extension is not present
+     */
+    unsigned int getKeyUsage() const;
+
+    bool hasKeyUsage() const;
+
+    /**
+     * Subject and authority key identifiers, empty when not present
+     */
+    const DerBlob &getSubjectKeyIdentifier() const;
+
+    const DerBlob &getAuthorityKeyIdentifier() const;
+
+    /**
+     * Convert an UTCTime or GeneralizedTime to seconds since the epoch
+     */
+    static std::time_t toTime(const DerElement &time);
+
+private:
+    void decodeBasicConstraints() const;
+
+    void decodeKeyUsage() const;
+
+    void decodeKeyIdentifiers() const;
+
+    DerBlob encoded;
+    DerBlob tbs;
+    int version;
+    DerBlob serialNumber;
+    DerBlob issuer;
+    DerBlob subject;
+    std::time_t notBefore;
+    std::time_t notAfter;
+    DerBlob subjectPublicKeyInfo;
+    std::vector<Extension> extensions;
+
+    // Lazily decoded extensions
+    mutable bool basicConstraintsDecoded;
+    mutable bool ca;
+    mutable int pathLength;
+    mutable bool keyUsageDecoded;
+    mutable bool keyUsagePresent;
+    mutable unsigned int keyUsage;
+    mutable bool keyIdentifiersDecoded;
+    mutable DerBlob subjectKeyIdentifier;
+    mutable DerBlob authorityKeyIdentifier;
+};
+
+#endif //KSMGMNT_CERTIFICATEVIEW_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
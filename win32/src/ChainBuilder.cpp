@@ -0,0 +1,146 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <algorithm>
+#include "ChainBuilder.h"
+
+ChainBuilder::Issuer::Issuer(const unsigned char *data, size_t size) :
+        encoded(data, data + size),
+        view(encoded.data(), encoded.size()) {
+}
+
+ChainBuilder::ChainBuilder(SignatureVerifier v, size_t cacheCapacity) : verifier(v), chainCache(cacheCapacity) {
+}
+
+bool ChainBuilder::addIssuer(const unsigned char *data, size_t size) {
+    auto issuer = std::make_shared<Issuer>(data, size);
+    if (!issuer->view.isCA()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto &existing : issuers) {
+        if (existing->view.getEncoded() == issuer->view.getEncoded()) {
+            return false;
+        }
+    }
+    bySubject.insert(std::make_pair(issuer->view.getSubject().str(), issuer));
+    if (!issuer->view.getSubjectKeyIdentifier().empty()) {
+        byKeyIdentifier.insert(std::make_pair(issuer->view.getSubjectKeyIdentifier().str(), issuer));
+    }
+    issuers.push_back(issuer);
+    // A new issuer can complete chains which were cached as incomplete
+    chainCache.clear();
+
+    return true;
+}
+
+size_t ChainBuilder::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return issuers.size();
+}
+
+void ChainBuilder::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    issuers.clear();
+    bySubject.clear();
+    byKeyIdentifier.clear();
+    chainCache.clear();
+}
+
+std::shared_ptr<const ChainBuilder::Chain> ChainBuilder::getChain(const CertificateView &certificate) {
+    // Issuer and serial number are chosen by whoever made the certificate, a forged one would get the cached chain
+    std::string key = certificate.getEncoded().str();
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto cached = chainCache.find(key);
+    if (cached) {
+        return cached;
+    }
+    auto chain = buildChain(certificate);
+    chainCache.put(key, chain);
+
+    return chain;
+}
+
+std::shared_ptr<const ChainBuilder::Chain> ChainBuilder::buildChain(const CertificateView &certificate) const {
+    auto chain = std::make_shared<Chain>();
+    chain->complete = false;
+
+    std::vector<std::shared_ptr<Issuer>> path;
+    const CertificateView *current = &certificate;
+    while (path.size() < MAX_CHAIN_DEPTH) {
+        if ((current->getSubject() == current->getIssuer()) && (current != &certificate)) {
+            chain->complete = true;
+            break;
+        }
+        auto issuer = findIssuer(*current, path);
+        if (issuer == nullptr) {
+            break;
+        }
+        path.push_back(issuer);
+        // Aliasing keeps the issuer alive as long as the chain refers to its view
+        chain->issuers.push_back(std::shared_ptr<const CertificateView>(issuer, &issuer->view));
+        current = &issuer->view;
+    }
+
+    return chain;
+}
+
+std::shared_ptr<ChainBuilder::Issuer> ChainBuilder::findIssuer(const CertificateView &certificate,
+                                                               const std::vector<std::shared_ptr<Issuer>> &chain) const {
+    std::vector<std::shared_ptr<Issuer>> candidates;
+    auto &keyIdentifier = certificate.getAuthorityKeyIdentifier();
+    if (!keyIdentifier.empty()) {
+        auto range = byKeyIdentifier.equal_range(keyIdentifier.str());
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->view.getSubject() == certificate.getIssuer()) {
+                candidates.push_back(it->second);
+            }
+        }
+    }
+    if (candidates.empty()) {
+        auto range = bySubject.equal_range(certificate.getIssuer().str());
+        for (auto it = range.first; it != range.second; ++it) {
+            candidates.push_back(it->second);
+        }
+    }
+
+    for (auto &candidate : candidates) {
+        if (std::find(chain.begin(), chain.end(), candidate) != chain.end()) {
+            continue;
+        }
+        if (verifier && !verifier(certificate, candidate->view)) {
+            continue;
+        }
+        return candidate;
+    }
+    return nullptr;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_CHAINBUILDER_H
+#define KSMGMNT_CHAINBUILDER_H
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CertificateView.h"
+#include "LruCache.h"
+
+// Maximum number of issuers above a certificate
+#define MAX_CHAIN_DEPTH 8
+// Maximum number of cached chains
+#define CHAIN_CACHE_CAPACITY 1024
+
+/**
+ * Builds certificate chains from an in-memory index of CA certificates. The CA certificates are
+ * indexed on their subject name and subject key identifier, and the most recently used chains are cached per
+ * certificate (its DER encoding) until the index changes.
+ */
+class ChainBuilder {
+public:
+    /**
+     * Verifies that issuer signed the certificate
+     */
+    typedef std::function<bool(const CertificateView &certificate, const CertificateView &issuer)> SignatureVerifier;
+
+    struct Chain {
+        // Issuers starting with the direct issuer of the certificate, they stay valid when the index is cleared
+        std::vector<std::shared_ptr<const CertificateView>> issuers;
+        // true when the chain ends in a self signed certificate
+        bool complete;
+    };
+
+    /**
+     * @param verifier Optional signature check of a candidate issuer, without it only the names and key
+     * identifiers are matched
+     * @param cacheCapacity maximum number of cached chains
+     */
+    explicit ChainBuilder(SignatureVerifier verifier = nullptr, size_t cacheCapacity = CHAIN_CACHE_CAPACITY);
+
+    /**
+     * Add a CA certificate to the index, other certificates are ignored
+     * @return true if the certificate was added
+     * throws std::invalid_argument when the certificate is malformed
+     */
+    bool addIssuer(const unsigned char *data, size_t size);
+
+    /**
+     * Number of CA certificates in the index
+     */
+    size_t size() const;
+
+    /**
+     * Remove all CA certificates and cached chains
+     */
+    void clear();
+
+    /**
+     * Build the chain of a certificate
+     */
+    std::shared_ptr<const Chain> getChain(const CertificateView &certificate);
+
+private:
+    struct Issuer {
+        Issuer(const unsigned char *data, size_t size);
+
+        std::vector<unsigned char> encoded;
+        CertificateView view;
+    };
+
+    std::shared_ptr<const Chain> buildChain(const CertificateView &certificate) const;
+
+    std::shared_ptr<Issuer> findIssuer(const CertificateView &certificate,
+                                       const std::vector<std::shared_ptr<Issuer>> &chain) const;
+
+    SignatureVerifier verifier;
+    std::vector<std::shared_ptr<Issuer>> issuers;
+    std::multimap<std::string, std::shared_ptr<Issuer>> bySubject;
+    std::multimap<std::string, std::shared_ptr<Issuer>> byKeyIdentifier;
+    LruCache<std::string, const Chain> chainCache;
+    mutable std::mutex lock;
+};
+
+#endif //KSMGMNT_CHAINBUILDER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_DERREADER_H
+#define KSMGMNT_DERREADER_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#define DER_BOOLEAN          0x01
+#define DER_INTEGER          0x02
+#define DER_BIT_STRING       0x03
+#define DER_OCTET_STRING     0x04
+#define DER_NULL             0x05
+#define DER_OID              0x06
+#define DER_UTC_TIME         0x17
+#define DER_GENERALIZED_TIME 0x18
+#define DER_SEQUENCE         0x30
+#define DER_SET              0x31
+#define DER_CONTEXT(n)       (0xA0 | (n))
+#define DER_CONTEXT_PRIM(n)  (0x80 | (n))
+
+/**
+ * Non owning reference to a piece of DER encoded data
+ */
+struct DerBlob {
+    const unsigned char *data;
+    size_t size;
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    std::string str() const {
+        return std::string(reinterpret_cast<const char *>(data), size);
+    }
+
+    bool operator==(const DerBlob &other) const {
+        return (size == other.size) && ((size == 0) || (memcmp(data, other.data, size) == 0));
+    }
+
+    bool operator!=(const DerBlob &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * A single TLV of the DER stream: the complete encoding and its content
+ */
+struct DerElement {
+    unsigned char tag;
+    DerBlob content;
+    DerBlob encoded;
+};
+
+/**
+ * Minimal zero-copy DER reader, it only supports the low tag numbers and definite lengths which
+ * are used in X509 certificates and CRLs. Malformed data throws a std::invalid_argument.
+ */
+class DerReader {
+public:
+    DerReader(const unsigned char *data, size_t size) : current{data}, end{data + size} {
+    }
+
+    explicit DerReader(const DerBlob &blob) : current{blob.data}, end{blob.data + blob.size} {
+    }
+
+    bool atEnd() const {
+        return current == end;
+    }
+
+    unsigned char peekTag() const {
+        if (atEnd()) {
+            throw std::invalid_argument("DER: unexpected end of data");
+        }
+        return *current;
+    }
+
+    DerElement read() {
+        DerElement element;
+        const unsigned char *start = current;
+        element.tag = peekTag();
+        if ((element.tag & 0x1F) == 0x1F) {
+            throw std::invalid_argument("DER: high tag numbers are not supported");
+        }
+        current++;
+        if (atEnd()) {
+            throw std::invalid_argument("DER: missing length");
+        }
+        size_t length = *current++;
+        if (length & 0x80) {
+            size_t lengthBytes = length & 0x7F;
+            if ((lengthBytes == 0) || (lengthBytes > sizeof(uint32_t))) {
+                throw std::invalid_argument("DER: unsupported length encoding");
+            }
+            if (static_cast<size_t>(end - current) < lengthBytes) {
+                throw std::invalid_argument("DER: truncated length");
+            }
+            length = 0;
+            for (size_t i = 0; i < lengthBytes; i++) {
+                length = (length << 8) | *current++;
+            }
+        }
+        if (static_cast<size_t>(end - current) < length) {
+            throw std::invalid_argument("DER: truncated content");
+        }
+        element.content = { current, length };
+        current += length;
+        element.encoded = { start, static_cast<size_t>(current - start) };
+        return element;
+    }
+
+    DerElement read(unsigned char expectedTag) {
+        if (peekTag() != expectedTag) {
+            throw std::invalid_argument("DER: unexpected tag");
+        }
+        return read();
+    }
+
+    bool readOptional(unsigned char tag, DerElement &element) {
+        if (atEnd() || (peekTag() != tag)) {
+            return false;
+        }
+        element = read();
+        return true;
+    }
+
+private:
+    const unsigned char *current;
+    const unsigned char *end;
+};
+
+#endif //KSMGMNT_DERREADER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,107 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+
+#include "Digest.h"
+#include <stdexcept>
+#include "KSException.h"
+
+/**
+ * The providers are never closed, they are shared by all digests of the process
+ */
+static BCRYPT_ALG_HANDLE getAlgorithm(Digest::hashAlgorithm algorithm) {
+    auto open = [](LPCWSTR algorithmId) {
+        BCRYPT_ALG_HANDLE handle = nullptr;
+        NTSTATUS status = BCryptOpenAlgorithmProvider(&handle, algorithmId, nullptr, BCRYPT_HASH_REUSABLE_FLAG);
+        if (!BCRYPT_SUCCESS(status)) {
+            throw KSException("getAlgorithm", __LINE__, (DWORD)status);
+        }
+        return handle;
+    };
+    if (algorithm == Digest::hashAlgorithm::Sha1) {
+        static BCRYPT_ALG_HANDLE sha1 = open(BCRYPT_SHA1_ALGORITHM);
+        return sha1;
+    }
+    static BCRYPT_ALG_HANDLE sha256 = open(BCRYPT_SHA256_ALGORITHM);
+    return sha256;
+}
+
+Digest::Digest(hashAlgorithm algorithm) : handle{nullptr},
+                                          size{algorithm == hashAlgorithm::Sha1 ? 20u : 32u} {
+    // Without a hash object buffer CNG allocates the state itself, and wipes it in BCryptDestroyHash
+    NTSTATUS status = BCryptCreateHash(getAlgorithm(algorithm),
+                                       &handle,
+                                       nullptr,
+                                       0,
+                                       nullptr,
+                                       0,
+                                       BCRYPT_HASH_REUSABLE_FLAG);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+}
+
+Digest::~Digest() {
+    BCryptDestroyHash(handle);
+}
+
+void Digest::update(const unsigned char *data, size_t dataLg) {
+    while (dataLg > 0) {
+        ULONG chunk = dataLg > MAXULONG ? MAXULONG : static_cast<ULONG>(dataLg);
+        NTSTATUS status = BCryptHashData(handle, const_cast<PUCHAR>(data), chunk, 0);
+        if (!BCRYPT_SUCCESS(status)) {
+            throw KSException(__func__, __LINE__, (DWORD)status);
+        }
+        data += chunk;
+        dataLg -= chunk;
+    }
+}
+
+void Digest::finish(unsigned char *result, size_t resultLg) {
+    if (resultLg < size) {
+        throw std::invalid_argument("digest buffer too small");
+    }
+    NTSTATUS status = BCryptFinishHash(handle, result, static_cast<ULONG>(size), 0);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+}
+
+size_t Digest::getSize() const {
+    return size;
+}
+
+std::string Digest::hash(hashAlgorithm algorithm, const unsigned char *data, size_t dataLg) {
+    Digest digest(algorithm);
+    std::string result(digest.getSize(), '\0');
+    digest.update(data, dataLg);
+    digest.finish(reinterpret_cast<unsigned char *>(&result[0]), result.size());
+    return result;
+}
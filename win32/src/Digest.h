@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_DIGEST_H
+#define KSMGMNT_DIGEST_H
+#include <windows.h>
+#include <bcrypt.h>
+#include <cstddef>
+#include <string>
+
+/**
+ * SHA-1 and SHA-256 through CNG, which uses the SHA instructions of the processor when they are there.
+ * The algorithm providers are opened once for the process. The hash state is allocated by CNG and
+ * zeroized when the digest is destroyed, so a digest can be used for key material.
+ */
+class Digest {
+public:
+    enum class hashAlgorithm {
+        Sha1 = 0,
+        Sha256
+    };
+
+    explicit Digest(hashAlgorithm algorithm);
+
+    ~Digest();
+
+    Digest(const Digest &) = delete;
+
+    void operator=(const Digest &) = delete;
+
+    void update(const unsigned char *data, size_t size);
+
+    /**
+     * Write the digest and start a new one
+     * @param resultLg size of result, at least getSize()
+     */
+    void finish(unsigned char *result, size_t resultLg);
+
+    /**
+     * @return 20 for SHA-1, 32 for SHA-256
+     */
+    size_t getSize() const;
+
+    /**
+     * @return the binary digest of one message
+     */
+    static std::string hash(hashAlgorithm algorithm, const unsigned char *data, size_t size);
+
+private:
+    BCRYPT_HASH_HANDLE handle;
+    size_t size;
+};
+
+#endif //KSMGMNT_DIGEST_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
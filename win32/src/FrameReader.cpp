@@ -0,0 +1,74 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "FrameReader.h"
+
+FrameReader::FrameReader(std::istream &input, size_t max) : in(input), maxFrame{max}, frameLg{0} {
+}
+
+FrameReader::frameStatus FrameReader::read() {
+    buffer.clear();
+    frameLg = 0;
+    in.read((char *)&frameLg, 4);
+    if (in.gcount() == 0) {
+        return frameStatus::End;
+    }
+    if (in.gcount() != 4) {
+        return frameStatus::Truncated;
+    }
+    if (frameLg > maxFrame) {
+        in.ignore(frameLg);
+        return frameStatus::Oversized;
+    }
+    // The length is known, so the buffer is allocated at most once per frame size
+    buffer.resize(frameLg);
+    in.read(buffer.data(), frameLg);
+    if ((size_t)in.gcount() != frameLg) {
+        buffer.clear();
+        return frameStatus::Truncated;
+    }
+    return frameStatus::Ok;
+}
+
+const char *FrameReader::data() const {
+    return buffer.data();
+}
+
+size_t FrameReader::size() const {
+    return buffer.size();
+}
+
+uint32_t FrameReader::getFrameLength() const {
+    return frameLg;
+}
+
+size_t FrameReader::capacity() const {
+    return buffer.capacity();
+}
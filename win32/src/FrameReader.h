@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_FRAMEREADER_H
+#define KSMGMNT_FRAMEREADER_H
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <streambuf>
+#include <vector>
+#include "SecureArena.h"
+
+// Largest native messaging frame Firefox exchanges with an application (1 MB)
+#define FRAME_READER_MAX_FRAME (1024 * 1024)
+
+/**
+ * Reads native messaging frames (32 bit length in native byte order, followed by the message) into one
+ * buffer, which is reused for every frame. The length is checked before anything is allocated, an oversized
+ * frame is skipped without buffering it, so the next frame can still be read. Frames carry passwords, the
+ * buffer is taken from the secure arena and zeroized when it is released.
+ */
+class FrameReader {
+public:
+    enum class frameStatus {
+        Ok = 0,
+        End,        // no more frames, the input ended between frames
+        Oversized,  // the frame is skipped, the reader is at the next frame
+        Truncated   // the input ended inside the frame, nothing can be read after it
+    };
+
+    /**
+     * @param maxFrame largest message accepted, without the length
+     */
+    explicit FrameReader(std::istream &in, size_t maxFrame = FRAME_READER_MAX_FRAME);
+
+    FrameReader(const FrameReader &) = delete;
+
+    void operator=(const FrameReader &) = delete;
+
+    /**
+     * Read the next frame, data and size give its message when the status is Ok
+     */
+    frameStatus read();
+
+    const char *data() const;
+
+    size_t size() const;
+
+    /**
+     * Length announced by the last frame, also when it is oversized or truncated
+     */
+    uint32_t getFrameLength() const;
+
+    /**
+     * Bytes allocated by the buffer, it never grows beyond the largest accepted frame
+     */
+    size_t capacity() const;
+
+private:
+    std::istream &in;
+    size_t maxFrame;
+    uint32_t frameLg;
+    std::vector<char, SecureAllocator<char>> buffer;
+};
+
+/**
+ * Reads a frame in place, std::istringstream would keep a copy of it (and of its passwords) which can not
+ * be wiped
+ */
+class FrameBuffer : public std::streambuf {
+public:
+    FrameBuffer(char *data, size_t size) {
+        setg(data, data, data + size);
+    }
+};
+
+#endif //KSMGMNT_FRAMEREADER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
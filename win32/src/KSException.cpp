@@ -10,49 +10,54 @@
  * Author: David Tillemans
  */
 #include <windows.h>
-#include <strsafe.h>
 #include <string>
 #include <exception>
 #include "KSException.h"
 
 using namespace std;
 
-KSException::KSException(const char *fName, int lineNumber, DWORD cd) noexcept : errorNumber{cd} {
-    LPTSTR tmpMsgBuf = NULL;
-    FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-                  nullptr,
-                  cd,
-                  MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-                  (LPSTR)&tmpMsgBuf,
-                  0,
-                  nullptr );
-    result = std::string(fName) + "(" + std::to_string(lineNumber) + ") : error(" + std::to_string(errorNumber) + ") : " + tmpMsgBuf;
-    if (tmpMsgBuf) {
-        LocalFree(tmpMsgBuf);
-    }
+KSException::KSException(const char *fName, int lineNumber, DWORD cd) noexcept : errorStatus(fName, lineNumber, cd) {
+}
+
+KSException::KSException(const char *fName, int lineNumber, const char *error) noexcept : errorStatus(fName,
+                                                                                                     lineNumber,
+                                                                                                     error) {
+}
+
+KSException::KSException(const char *fName, int lineNumber, const std::string &error) noexcept : errorStatus(fName,
+                                                                                                            lineNumber,
+                                                                                                            ""),
+                                                                                                detail(error) {
 }
 
-KSException::KSException(const char *fName, int lineNumber, const std::string &error) noexcept : errorNumber{ 0x90010001 } {
-    result = std::string(fName) + "(" + std::to_string(lineNumber) + ") : " + error;
+KSException::KSException(const KSStatus &status) noexcept : errorStatus(status) {
 }
 
-KSException::KSException(const KSException& from) noexcept : std::exception(from), errorNumber{from.errorNumber} {
-    result = from.result;
-    errorNumber = from.errorNumber;
+KSException::KSException(const KSException& from) noexcept : std::exception(from),
+                                                             errorStatus(from.errorStatus),
+                                                             detail(from.detail),
+                                                             result(from.result) {
 }
 
 
 DWORD KSException::code() const noexcept {
-    return errorNumber;
+    return errorStatus.code();
+}
+
+const KSStatus &KSException::status() const noexcept {
+    return errorStatus;
 }
 
 KSException::~KSException() noexcept {
 }
 
 char const * KSException::what() const {
+    if (result.empty()) {
+        result = errorStatus.message() + detail;
+    }
     return result.c_str();
 }
 
 KSException::operator std::string() const {
-    return result;
+    return what();
 }
\ No newline at end of file
@@ -7,18 +7,31 @@
 #include "common.h"
 #include <exception>
 #include <string>
+#include "KSStatus.h"
 
+/**
+ * The error is kept as a KSStatus, the message is formatted when what() is called the first time
+ */
 class KSException : public std::exception {
 
 public:
 	explicit KSException(const char *funcName, int lineNumber, DWORD cd) noexcept;
 
+    /**
+     * @param error text with static storage, like a string literal
+     */
+    explicit KSException(const char *funcName, int lineNumber, const char *error) noexcept;
+
     explicit KSException(const char *funcName, int lineNumber, const std::string &error) noexcept;
 
+    explicit KSException(const KSStatus &status) noexcept;
+
     KSException(const KSException& from) noexcept;
 
     DWORD code() const noexcept;
 
+    const KSStatus &status() const noexcept;
+
     ~KSException() noexcept override;
 
     virtual char const * what() const;
@@ -26,8 +39,10 @@ public:
     explicit operator std::string() const;
 
 private:
-    DWORD errorNumber;
-    std::string result;
+    KSStatus errorStatus;
+    // Text of an error which is not a string literal
+    std::string detail;
+    mutable std::string result;
 };
 
 #endif // KSEXCEPTION_H
@@ -0,0 +1,78 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "KSStatus.h"
+
+KSStatus::KSStatus() noexcept : function{nullptr}, line{0}, errorNumber{0}, error{nullptr} {
+}
+
+KSStatus::KSStatus(const char *fName, int lineNumber, DWORD cd) noexcept : function{fName},
+                                                                          line{lineNumber},
+                                                                          errorNumber{cd},
+                                                                          error{nullptr} {
+}
+
+KSStatus::KSStatus(const char *fName, int lineNumber, const char *err) noexcept : function{fName},
+                                                                                 line{lineNumber},
+                                                                                 errorNumber{KSSTATUS_APPLICATION_ERROR},
+                                                                                 error{err} {
+}
+
+bool KSStatus::ok() const noexcept {
+    return function == nullptr;
+}
+
+DWORD KSStatus::code() const noexcept {
+    return errorNumber;
+}
+
+std::string KSStatus::message() const {
+    if (ok()) {
+        return std::string();
+    }
+    std::string result = std::string(function) + "(" + std::to_string(line) + ") : ";
+    if (error != nullptr) {
+        return result + error;
+    }
+    LPSTR tmpMsgBuf = nullptr;
+    FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                   nullptr,
+                   errorNumber,
+                   MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                   (LPSTR)&tmpMsgBuf,
+                   0,
+                   nullptr);
+    result += "error(" + std::to_string(errorNumber) + ") : ";
+    if (tmpMsgBuf) {
+        result += tmpMsgBuf;
+        LocalFree(tmpMsgBuf);
+    }
+    return result;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_KSSTATUS_H
+#define KSMGMNT_KSSTATUS_H
+#include "common.h"
+#include <string>
+
+// Error code of the errors with a text instead of a system error code
+#define KSSTATUS_APPLICATION_ERROR 0x90010001
+
+/**
+ * Result of an operation: success, or an error code with the place where it happened. It is cheap to
+ * create and copy, the readable message is only formatted when it is asked for (to log it).
+ */
+class KSStatus {
+public:
+    /**
+     * Success
+     */
+    KSStatus() noexcept;
+
+    /**
+     * System error code, the message comes from FormatMessage
+     * @param function name of the function, with static storage like __func__
+     */
+    KSStatus(const char *function, int line, DWORD code) noexcept;
+
+    /**
+     * Application error
+     * @param error text with static storage, like a string literal
+     */
+    KSStatus(const char *function, int line, const char *error) noexcept;
+
+    bool ok() const noexcept;
+
+    DWORD code() const noexcept;
+
+    /**
+     * "function(line) : error(code) : system message" or "function(line) : error"
+     */
+    std::string message() const;
+
+private:
+    const char *function;
+    int line;
+    DWORD errorNumber;
+    const char *error;
+};
+
+#endif //KSMGMNT_KSSTATUS_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
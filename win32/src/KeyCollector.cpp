@@ -0,0 +1,88 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <exception>
+#include <thread>
+#include "KeyCollector.h"
+#include "CancellationToken.h"
+#include "Metrics.h"
+
+KeyCollector::KeyCollector(Backend &b,
+                           std::chrono::seconds age,
+                           size_t size,
+                           std::chrono::milliseconds pause) : backend(b),
+                                                              minimumAge(age),
+                                                              batchSize{size ? size : 1},
+                                                              batchPause(pause) {
+}
+
+size_t KeyCollector::collect(time_t now) {
+    auto start = std::chrono::steady_clock::now();
+    auto hostKeys = backend.listHostKeys();
+    auto linkedKeys = backend.listLinkedKeys();
+    auto scan = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Metrics::GetInstance().record("gc.scan", static_cast<uint64_t>(scan.count()));
+
+    std::vector<std::wstring> orphans;
+    for (auto &key : hostKeys) {
+        if ((key.created + static_cast<time_t>(minimumAge.count()) <= now) &&
+            (linkedKeys.find(key.name) == linkedKeys.end())) {
+            orphans.push_back(key.name);
+        }
+    }
+    Metrics::GetInstance().set("gc.host_keys", hostKeys.size());
+    Metrics::GetInstance().set("gc.orphans", orphans.size());
+
+    size_t deleted = 0;
+    for (size_t i = 0; i < orphans.size(); i++) {
+        if ((i > 0) && (i % batchSize == 0)) {
+            CancellationToken::checkpoint();
+            std::this_thread::sleep_for(batchPause);
+        }
+        try {
+            if (backend.deleteOrphanKey(orphans[i])) {
+                deleted++;
+                Metrics::GetInstance().increment("gc.deleted");
+            }
+            else {
+                // Its certificate was imported while the collector paused
+                Metrics::GetInstance().increment("gc.linked");
+            }
+        }
+        catch (std::exception &) {
+            // A key which can not be deleted now is tried again in the next collection
+            Metrics::GetInstance().increment("gc.failed");
+        }
+    }
+    Metrics::GetInstance().set("gc.host_keys", hostKeys.size() - deleted);
+    Metrics::GetInstance().set("gc.orphans", orphans.size() - deleted);
+
+    return deleted;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_KEYCOLLECTOR_H
+#define KSMGMNT_KEYCOLLECTOR_H
+#include <chrono>
+#include <ctime>
+#include <set>
+#include <string>
+#include <vector>
+
+// Keys younger than this can still get their certificate
+#define KEY_COLLECTOR_MINIMUM_AGE std::chrono::hours(24 * 7)
+// Lowest minimum age which can be configured, a CSR can wait a day for its certificate
+#define KEY_COLLECTOR_LOWEST_AGE std::chrono::hours(24)
+#define KEY_COLLECTOR_BATCH_SIZE 16
+#define KEY_COLLECTOR_BATCH_PAUSE std::chrono::milliseconds(1000)
+
+/**
+ * Deletes the keys created by create_csr for which no certificate was imported, so they do not slow
+ * down the key lookups of later imports. Only keys marked as created by this host are considered, and
+ * they are deleted in small batches with a pause in between to not hog the key store.
+ */
+class KeyCollector {
+public:
+    struct Key {
+        std::wstring name;
+        time_t created;
+    };
+
+    /**
+     * Access to the key and certificate stores
+     */
+    class Backend {
+    public:
+        virtual ~Backend() = default;
+
+        /**
+         * Keys marked as created by this host
+         */
+        virtual std::vector<Key> listHostKeys() = 0;
+
+        /**
+         * Names of the keys which are linked to a certificate
+         */
+        virtual std::set<std::wstring> listLinkedKeys() = 0;
+
+        /**
+         * Delete the key, unless it was linked to a certificate since listLinkedKeys. The check and the
+         * deletion are atomic for the imports which link keys.
+         * @return false when the key is linked now, it is kept
+         */
+        virtual bool deleteOrphanKey(const std::wstring &name) = 0;
+    };
+
+    KeyCollector(Backend &backend,
+                 std::chrono::seconds minimumAge = KEY_COLLECTOR_MINIMUM_AGE,
+                 size_t batchSize = KEY_COLLECTOR_BATCH_SIZE,
+                 std::chrono::milliseconds batchPause = KEY_COLLECTOR_BATCH_PAUSE);
+
+    /**
+     * Delete the orphaned keys older than the minimum age. The counters gc.host_keys, gc.orphans,
+     * gc.deleted, gc.linked and gc.failed and the timer gc.scan are updated in Metrics.
+     * throws OperationCancelled between batches when the current request is cancelled
+     * @return the number of deleted keys
+     */
+    size_t collect(time_t now = time(nullptr));
+
+private:
+    Backend &backend;
+    std::chrono::seconds minimumAge;
+    size_t batchSize;
+    std::chrono::milliseconds batchPause;
+};
+
+#endif //KSMGMNT_KEYCOLLECTOR_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -5,11 +5,22 @@
  * Date: 09/08/2020
  */
 #include "KeyStore.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdexcept>
 #include <string>
 #include "KSException.h"
 #include "KeyPair.h"
+#include "CancellationToken.h"
+#include "Digest.h"
+#include "Metrics.h"
+#include "Pkcs8.h"
+#include "SecureArena.h"
+#include "Utf8Utils.h"
 
-KeyStore::KeyStore(const wchar_t *keystoreName): cryptoProvider{NULL} {
+KeyStore::KeyStore(const wchar_t *keystoreName): cryptoProvider{NULL},
+                                                  openKeys{KEYSTORE_OPEN_KEYS} {
     DWORD status = STATUS_SUCCESS;
     status = NCryptOpenStorageProvider(&cryptoProvider, keystoreName, 0);
     if (status != STATUS_SUCCESS) {
@@ -17,10 +28,81 @@ KeyStore::KeyStore(const wchar_t *keystoreName): cryptoProvider{NULL} {
     }
 };
 
+namespace {
 
-std::unique_ptr<KeyPair> KeyStore::generateKeyPair(const std::wstring &keyIdentifier,
+/**
+ * In memory key of the PKCS#8 encryption
+ */
+struct EphemeralKey {
+    explicit EphemeralKey(BCRYPT_KEY_HANDLE keyHandle) : handle{keyHandle} {
+    }
+
+    ~EphemeralKey() {
+        BCryptDestroyKey(handle);
+    }
+
+    EphemeralKey(const EphemeralKey &) = delete;
+
+    void operator=(const EphemeralKey &) = delete;
+
+    BCRYPT_KEY_HANDLE handle;
+};
+
+/**
+ * Algorithm provider of the PKCS#8 encryption, which is only opened for an import or export
+ */
+struct Algorithm {
+    Algorithm(LPCWSTR algorithmId, ULONG flags) : handle{nullptr} {
+        NTSTATUS status = BCryptOpenAlgorithmProvider(&handle, algorithmId, nullptr, flags);
+        if (!BCRYPT_SUCCESS(status)) {
+            throw KSException("Algorithm", __LINE__, (DWORD)status);
+        }
+    }
+
+    ~Algorithm() {
+        BCryptCloseAlgorithmProvider(handle, 0);
+    }
+
+    Algorithm(const Algorithm &) = delete;
+
+    void operator=(const Algorithm &) = delete;
+
+    BCRYPT_ALG_HANDLE handle;
+};
+
+}
+
+std::shared_ptr<KeyPair> KeyStore::generateKeyPair(const std::wstring &keyIdentifier,
                                                    u_long bitLength,
                                                    bool forcePasswordProtection) const {
+    auto start = std::chrono::steady_clock::now();
+    // The key is generated inside the key storage provider when it is finalized
+    NCRYPT_KEY_HANDLE rsaKeyHandle = createKey(keyIdentifier, bitLength);
+
+    // Nothing is persisted before the key is finalized, so a cancelled request can still back out
+    try {
+        setKeyPolicy(rsaKeyHandle, forcePasswordProtection);
+        CancellationToken::checkpoint();
+    }
+    catch (...) {
+        NCryptFreeObject(rsaKeyHandle);
+        throw;
+    }
+
+    DWORD status = NCryptFinalizeKey(rsaKeyHandle, NCRYPT_WRITE_KEY_TO_LEGACY_STORE_FLAG );
+    if (status != STATUS_SUCCESS) {
+        NCryptFreeObject(rsaKeyHandle);
+        throw KSException(__func__, __LINE__, status);
+    }
+    auto generation = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Metrics::GetInstance().record("keystore.generate_key", static_cast<uint64_t>(generation.count()));
+
+    auto keyPair = std::make_shared<KeyPair>(rsaKeyHandle, keyIdentifier);
+    openKeys.put(keyIdentifier, keyPair);
+    return keyPair;
+};
+
+NCRYPT_KEY_HANDLE KeyStore::createKey(const std::wstring &keyIdentifier, u_long bitLength) const {
     DWORD status = STATUS_SUCCESS;
     NCRYPT_KEY_HANDLE rsaKeyHandle;
     status = NCryptCreatePersistedKey(cryptoProvider,
@@ -33,30 +115,36 @@ std::unique_ptr<KeyPair> KeyStore::generateKeyPair(const std::wstring &keyIdenti
         throw KSException(__func__, __LINE__, status);
     }
 
-    DWORD exportPolicy = NCRYPT_ALLOW_EXPORT_FLAG;
+    DWORD keyLength = bitLength;
     status = NCryptSetProperty(rsaKeyHandle,
-                               NCRYPT_EXPORT_POLICY_PROPERTY,
-                               reinterpret_cast<PBYTE>(&exportPolicy),
+                               NCRYPT_LENGTH_PROPERTY,
+                               reinterpret_cast<PBYTE>(&keyLength),
                                sizeof(DWORD),
                                NCRYPT_PERSIST_FLAG);
     if (status != STATUS_SUCCESS) {
+        NCryptFreeObject(rsaKeyHandle);
         throw KSException(__func__, __LINE__, status);
     }
 
-    DWORD keyUsage = NCRYPT_ALLOW_SIGNING_FLAG;
+    return rsaKeyHandle;
+}
+
+void KeyStore::setKeyPolicy(NCRYPT_KEY_HANDLE rsaKeyHandle, bool forcePasswordProtection) const {
+    DWORD status = STATUS_SUCCESS;
+    DWORD exportPolicy = NCRYPT_ALLOW_EXPORT_FLAG;
     status = NCryptSetProperty(rsaKeyHandle,
-                               NCRYPT_KEY_USAGE_PROPERTY,
-                               reinterpret_cast<PBYTE>(&keyUsage),
+                               NCRYPT_EXPORT_POLICY_PROPERTY,
+                               reinterpret_cast<PBYTE>(&exportPolicy),
                                sizeof(DWORD),
                                NCRYPT_PERSIST_FLAG);
     if (status != STATUS_SUCCESS) {
         throw KSException(__func__, __LINE__, status);
     }
 
-    DWORD keyLength = bitLength;
+    DWORD keyUsage = NCRYPT_ALLOW_SIGNING_FLAG;
     status = NCryptSetProperty(rsaKeyHandle,
-                               NCRYPT_LENGTH_PROPERTY,
-                               reinterpret_cast<PBYTE>(&keyLength),
+                               NCRYPT_KEY_USAGE_PROPERTY,
+                               reinterpret_cast<PBYTE>(&keyUsage),
                                sizeof(DWORD),
                                NCRYPT_PERSIST_FLAG);
     if (status != STATUS_SUCCESS) {
@@ -79,24 +167,403 @@ std::unique_ptr<KeyPair> KeyStore::generateKeyPair(const std::wstring &keyIdenti
         }
     }
 
-    status = NCryptFinalizeKey(rsaKeyHandle, NCRYPT_WRITE_KEY_TO_LEGACY_STORE_FLAG );
+    // Mark the key as created by this host, so the key collector can find it when no certificate is imported
+    FILETIME created;
+    GetSystemTimeAsFileTime(&created);
+    status = NCryptSetProperty(rsaKeyHandle,
+                               HOST_KEY_CREATED_PROPERTY,
+                               reinterpret_cast<PBYTE>(&created),
+                               sizeof(FILETIME),
+                               NCRYPT_PERSIST_FLAG);
     if (status != STATUS_SUCCESS) {
         throw KSException(__func__, __LINE__, status);
     }
+}
 
-    return std::move(std::make_unique<KeyPair>(rsaKeyHandle, keyIdentifier));
-};
-
-std::unique_ptr<KeyPair> KeyStore::getKeyPair(const std::wstring &keyIdentifier) const {
+std::shared_ptr<KeyPair> KeyStore::getKeyPair(const std::wstring &keyIdentifier) const {
     DWORD status = STATUS_SUCCESS;
     NCRYPT_KEY_HANDLE rsaKeyHandle;
 
+    auto keyPair = openKeys.find(keyIdentifier);
+    if (keyPair) {
+        Metrics::GetInstance().increment("keystore.open_key_hits");
+        return keyPair;
+    }
+    Metrics::GetInstance().increment("keystore.open_key_misses");
+
     status = NCryptOpenKey(cryptoProvider, &rsaKeyHandle, keyIdentifier.c_str(), 0, 0);
     if (status != STATUS_SUCCESS) {
         throw KSException(__func__, __LINE__, status);
     }
 
-    return std::make_unique<KeyPair>(rsaKeyHandle, keyIdentifier);
+    keyPair = std::make_shared<KeyPair>(rsaKeyHandle, keyIdentifier);
+    openKeys.put(keyIdentifier, keyPair);
+    return keyPair;
+}
+
+/**
+ * Passwords, salts and IVs come straight from the system generator, they are not kept in a pool
+ */
+static void generateRandom(unsigned char *data, size_t size) {
+    NTSTATUS status = BCryptGenRandom(nullptr, data, static_cast<ULONG>(size), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException("generateRandom", __LINE__, (DWORD)status);
+    }
+}
+
+/**
+ * PBKDF2 of PBES2, the password is UTF-8 like openssl uses it
+ */
+static void deriveKey(const wchar_t *password,
+                      const Pkcs8::Encryption &encryption,
+                      unsigned char *key,
+                      size_t keyLg) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "UTF-16 wide strings");
+    size_t passwordLg = wcslen(password);
+    SecureBuffer utf8Password(3 * passwordLg + 1);
+    utf8Password.resize(Utf8Utils::toUtf8(reinterpret_cast<const char16_t *>(password),
+                                          passwordLg,
+                                          reinterpret_cast<char *>(utf8Password.data())));
+
+    Algorithm hmac((encryption.prf == Pkcs8::prfAlgorithm::HmacSha256) ? BCRYPT_SHA256_ALGORITHM : BCRYPT_SHA1_ALGORITHM,
+                   BCRYPT_ALG_HANDLE_HMAC_FLAG);
+    NTSTATUS status = BCryptDeriveKeyPBKDF2(hmac.handle,
+                                            utf8Password.data(),
+                                            static_cast<ULONG>(utf8Password.size()),
+                                            const_cast<PUCHAR>(encryption.salt.data()),
+                                            static_cast<ULONG>(encryption.salt.size()),
+                                            encryption.iterations,
+                                            key,
+                                            static_cast<ULONG>(keyLg),
+                                            0);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+}
+
+void KeyStore::pkcs12DeriveKey(const unsigned char *password,
+                               size_t passwordLg,
+                               const std::vector<unsigned char> &salt,
+                               uint32_t iterations,
+                               unsigned char id,
+                               unsigned char *output,
+                               size_t outputLg) {
+    // SHA-1 produces u = 20 bytes and hashes blocks of v = 64 bytes
+    const size_t u = 20;
+    const size_t v = 64;
+    if (iterations == 0) {
+        throw std::invalid_argument("PKCS8: unsupported number of iterations");
+    }
+
+    // I = S || P, the salt and the password repeated to a multiple of v bytes
+    size_t saltLg = v * ((salt.size() + v - 1) / v);
+    size_t repeatedPasswordLg = v * ((passwordLg + v - 1) / v);
+    // The password and the digests derived from it only live in the secure arena
+    SecureBuffer input(v + saltLg + repeatedPasswordLg, id);
+    unsigned char *i = input.data() + v;
+    for (size_t k = 0; k < saltLg; k++) {
+        i[k] = salt[k % salt.size()];
+    }
+    for (size_t k = 0; k < repeatedPasswordLg; k++) {
+        i[saltLg + k] = password[k % passwordLg];
+    }
+
+    Digest sha1(Digest::hashAlgorithm::Sha1);
+    SecureBuffer a(u);
+    size_t produced = 0;
+    while (true) {
+        // A = H^c(D || I)
+        sha1.update(input.data(), input.size());
+        sha1.finish(a.data(), a.size());
+        for (uint32_t c = 1; c < iterations; c++) {
+            sha1.update(a.data(), a.size());
+            sha1.finish(a.data(), a.size());
+        }
+        size_t copyLg = (std::min)(u, outputLg - produced);
+        std::copy(a.begin(), a.begin() + copyLg, output + produced);
+        produced += copyLg;
+        if (produced == outputLg) {
+            break;
+        }
+        // I_j = (I_j + B + 1) mod 2^(8v), with B the digest repeated to v bytes
+        for (size_t block = 0; block < saltLg + repeatedPasswordLg; block += v) {
+            unsigned int carry = 1;
+            for (size_t k = v; k > 0; k--) {
+                carry += i[block + k - 1] + a[(k - 1) % u];
+                i[block + k - 1] = static_cast<unsigned char>(carry);
+                carry >>= 8;
+            }
+        }
+    }
+}
+
+/**
+ * Encrypt or decrypt in CBC mode with PKCS#7 padding
+ */
+static SecureBuffer cbcCrypt(LPCWSTR algorithmId,
+                             const unsigned char *key,
+                             size_t keyLg,
+                             const std::vector<unsigned char> &iv,
+                             const unsigned char *input,
+                             size_t inputLg,
+                             bool encrypt) {
+    Algorithm cipher(algorithmId, 0);
+    NTSTATUS status = BCryptSetProperty(cipher.handle,
+                                        BCRYPT_CHAINING_MODE,
+                                        reinterpret_cast<PUCHAR>(const_cast<wchar_t *>(BCRYPT_CHAIN_MODE_CBC)),
+                                        sizeof(BCRYPT_CHAIN_MODE_CBC),
+                                        0);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+    BCRYPT_KEY_HANDLE keyHandle = nullptr;
+    status = BCryptGenerateSymmetricKey(cipher.handle,
+                                        &keyHandle,
+                                        nullptr,
+                                        0,
+                                        const_cast<PUCHAR>(key),
+                                        static_cast<ULONG>(keyLg),
+                                        0);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+    EphemeralKey cipherKey(keyHandle);
+
+    // The IV is updated in place
+    std::vector<unsigned char> chainingIv(iv);
+    // Room for a block of padding
+    SecureBuffer output(inputLg + 16);
+    ULONG outputLg = 0;
+    if (encrypt) {
+        status = BCryptEncrypt(cipherKey.handle,
+                               const_cast<PUCHAR>(input),
+                               static_cast<ULONG>(inputLg),
+                               nullptr,
+                               chainingIv.data(),
+                               static_cast<ULONG>(chainingIv.size()),
+                               output.data(),
+                               static_cast<ULONG>(output.size()),
+                               &outputLg,
+                               BCRYPT_BLOCK_PADDING);
+    }
+    else {
+        status = BCryptDecrypt(cipherKey.handle,
+                               const_cast<PUCHAR>(input),
+                               static_cast<ULONG>(inputLg),
+                               nullptr,
+                               chainingIv.data(),
+                               static_cast<ULONG>(chainingIv.size()),
+                               output.data(),
+                               static_cast<ULONG>(output.size()),
+                               &outputLg,
+                               BCRYPT_BLOCK_PADDING);
+    }
+    // A wrong password mostly ends up here, as invalid padding
+    if (!BCRYPT_SUCCESS(status)) {
+        throw KSException(__func__, __LINE__, (DWORD)status);
+    }
+    output.resize(outputLg);
+    return output;
+}
+
+std::shared_ptr<KeyPair> KeyStore::importPkcs8(const std::wstring &keyIdentifier,
+                                               const unsigned char *pkcs8,
+                                               size_t pkcs8Lg,
+                                               const wchar_t *password,
+                                               bool forcePasswordProtection) const {
+    auto start = std::chrono::steady_clock::now();
+    auto encryptedKey = Pkcs8::decode(pkcs8, pkcs8Lg);
+
+    NCryptBuffer buffers[2] = {
+            {
+                    static_cast<ULONG>((keyIdentifier.size() + 1) * sizeof(wchar_t)),
+                    NCRYPTBUFFER_PKCS_KEY_NAME,
+                    const_cast<wchar_t *>(keyIdentifier.c_str())
+            },
+            {
+                    static_cast<ULONG>((wcslen(password) + 1) * sizeof(wchar_t)),
+                    NCRYPTBUFFER_PKCS_SECRET,
+                    const_cast<wchar_t *>(password)
+            }
+    };
+    NCryptBufferDesc parameters = {NCRYPTBUFFER_VERSION, 1, buffers};
+    const unsigned char *blob = pkcs8;
+    size_t blobLg = pkcs8Lg;
+    SecureBuffer privateKeyInfo;
+    if (encryptedKey.encryption.scheme == Pkcs8::encryptionScheme::Pbes2) {
+        // The provider does not know PBES2, the key is imported unencrypted
+        SecureBuffer key(encryptedKey.encryption.keyLength);
+        deriveKey(password, encryptedKey.encryption, key.data(), key.size());
+        privateKeyInfo = cbcCrypt(BCRYPT_AES_ALGORITHM,
+                                  key.data(),
+                                  key.size(),
+                                  encryptedKey.encryption.iv,
+                                  encryptedKey.encryptedData.data,
+                                  encryptedKey.encryptedData.size,
+                                  false);
+        blob = privateKeyInfo.data();
+        blobLg = privateKeyInfo.size();
+    }
+    else {
+        parameters.cBuffers = 2;
+    }
+    CancellationToken::checkpoint();
+
+    NCRYPT_KEY_HANDLE keyHandle = 0;
+    DWORD status = NCryptImportKey(cryptoProvider,
+                                   0,
+                                   NCRYPT_PKCS8_PRIVATE_KEY_BLOB,
+                                   &parameters,
+                                   &keyHandle,
+                                   const_cast<PBYTE>(blob),
+                                   static_cast<DWORD>(blobLg),
+                                   NCRYPT_DO_NOT_FINALIZE_FLAG);
+    if (status != STATUS_SUCCESS) {
+        throw KSException(__func__, __LINE__, status);
+    }
+
+    try {
+        setKeyPolicy(keyHandle, forcePasswordProtection);
+    }
+    catch (...) {
+        NCryptFreeObject(keyHandle);
+        throw;
+    }
+    // Only RSA keys can be written to the legacy store
+    wchar_t algorithmGroup[16] = {0};
+    DWORD algorithmGroupLg = 0;
+    DWORD finalizeFlags = 0;
+    if ((NCryptGetProperty(keyHandle,
+                           NCRYPT_ALGORITHM_GROUP_PROPERTY,
+                           reinterpret_cast<PBYTE>(algorithmGroup),
+                           sizeof(algorithmGroup) - sizeof(wchar_t),
+                           &algorithmGroupLg,
+                           0) == STATUS_SUCCESS) &&
+        (wcscmp(algorithmGroup, NCRYPT_RSA_ALGORITHM_GROUP) == 0)) {
+        finalizeFlags = NCRYPT_WRITE_KEY_TO_LEGACY_STORE_FLAG;
+    }
+    status = NCryptFinalizeKey(keyHandle, finalizeFlags);
+    if (status != STATUS_SUCCESS) {
+        NCryptFreeObject(keyHandle);
+        throw KSException(__func__, __LINE__, status);
+    }
+    auto import = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Metrics::GetInstance().record("keystore.import_pkcs8", static_cast<uint64_t>(import.count()));
+
+    auto keyPair = std::make_shared<KeyPair>(keyHandle, keyIdentifier);
+    openKeys.put(keyIdentifier, keyPair);
+    return keyPair;
+}
+
+std::vector<unsigned char> KeyStore::exportPkcs8(const std::wstring &keyIdentifier,
+                                                 const wchar_t *password,
+                                                 uint32_t iterations) const {
+    if ((iterations < PKCS8_MIN_ITERATIONS) || (iterations > PKCS8_MAX_ITERATIONS)) {
+        throw KSException(__func__, __LINE__, "Invalid number of iterations");
+    }
+    auto keyPair = getKeyPair(keyIdentifier);
+
+    // A random password for the triple DES export, which only protects the key on its way out of the provider
+    unsigned char secret[16];
+    generateRandom(secret, sizeof(secret));
+    SecureWideString exportPassword(2 * sizeof(secret) + 1, L'\0');
+    static const wchar_t hexDigits[] = L"0123456789ABCDEF";
+    for (size_t i = 0; i < sizeof(secret); i++) {
+        exportPassword[2 * i] = hexDigits[secret[i] >> 4];
+        exportPassword[2 * i + 1] = hexDigits[secret[i] & 0x0F];
+    }
+    SecureZeroMemory(secret, sizeof(secret));
+    std::vector<unsigned char> exportSalt(8);
+    generateRandom(exportSalt.data(), exportSalt.size());
+    auto exportParameters = Pkcs8::encodePkcs12Parameters(exportSalt, 1);
+
+    NCryptBuffer buffers[3] = {
+            {
+                    static_cast<ULONG>(strlen(Pkcs8::getPkcs12TripleDesOid()) + 1),
+                    NCRYPTBUFFER_PKCS_ALG_OID,
+                    const_cast<char *>(Pkcs8::getPkcs12TripleDesOid())
+            },
+            {
+                    static_cast<ULONG>(exportParameters.size()),
+                    NCRYPTBUFFER_PKCS_ALG_PARAM,
+                    exportParameters.data()
+            },
+            {
+                    static_cast<ULONG>(exportPassword.size() * sizeof(wchar_t)),
+                    NCRYPTBUFFER_PKCS_SECRET,
+                    exportPassword.data()
+            }
+    };
+    NCryptBufferDesc parameters = {NCRYPTBUFFER_VERSION, 3, buffers};
+    DWORD exportedLg = 0;
+    DWORD status = NCryptExportKey(keyPair->getHandle(),
+                                   0,
+                                   NCRYPT_PKCS8_PRIVATE_KEY_BLOB,
+                                   &parameters,
+                                   nullptr,
+                                   0,
+                                   &exportedLg,
+                                   0);
+    if (status != STATUS_SUCCESS) {
+        throw KSException(__func__, __LINE__, status);
+    }
+    std::vector<unsigned char> exported(exportedLg);
+    status = NCryptExportKey(keyPair->getHandle(),
+                             0,
+                             NCRYPT_PKCS8_PRIVATE_KEY_BLOB,
+                             &parameters,
+                             exported.data(),
+                             exportedLg,
+                             &exportedLg,
+                             0);
+    if (status != STATUS_SUCCESS) {
+        throw KSException(__func__, __LINE__, status);
+    }
+    exported.resize(exportedLg);
+
+    auto tripleDesKey = Pkcs8::decode(exported.data(), exported.size());
+    if (tripleDesKey.encryption.scheme != Pkcs8::encryptionScheme::Pkcs12TripleDes) {
+        throw KSException(__func__, __LINE__, "Unexpected PKCS8 encryption");
+    }
+    // The PKCS12 key derivation uses the password as BMPString: big endian with 2 terminating zero bytes
+    SecureBuffer bmpPassword(exportPassword.size() * 2);
+    for (size_t i = 0; i < exportPassword.size(); i++) {
+        bmpPassword[2 * i] = static_cast<unsigned char>(exportPassword[i] >> 8);
+        bmpPassword[2 * i + 1] = static_cast<unsigned char>(exportPassword[i]);
+    }
+    SecureBuffer tripleDesSecret(24 + 8);
+    pkcs12DeriveKey(bmpPassword.data(), bmpPassword.size(), tripleDesKey.encryption.salt,
+                    tripleDesKey.encryption.iterations, 1, tripleDesSecret.data(), 24);
+    pkcs12DeriveKey(bmpPassword.data(), bmpPassword.size(), tripleDesKey.encryption.salt,
+                    tripleDesKey.encryption.iterations, 2, tripleDesSecret.data() + 24, 8);
+    auto privateKeyInfo = cbcCrypt(BCRYPT_3DES_ALGORITHM,
+                                   tripleDesSecret.data(),
+                                   24,
+                                   std::vector<unsigned char>(tripleDesSecret.begin() + 24, tripleDesSecret.end()),
+                                   tripleDesKey.encryptedData.data,
+                                   tripleDesKey.encryptedData.size,
+                                   false);
+    CancellationToken::checkpoint();
+
+    Pkcs8::Encryption encryption;
+    encryption.scheme = Pkcs8::encryptionScheme::Pbes2;
+    encryption.salt.resize(16);
+    generateRandom(encryption.salt.data(), encryption.salt.size());
+    encryption.iterations = iterations;
+    encryption.prf = Pkcs8::prfAlgorithm::HmacSha256;
+    encryption.keyLength = 32;
+    encryption.iv.resize(16);
+    generateRandom(encryption.iv.data(), encryption.iv.size());
+    SecureBuffer key(encryption.keyLength);
+    deriveKey(password, encryption, key.data(), key.size());
+    auto encryptedData = cbcCrypt(BCRYPT_AES_ALGORITHM,
+                                  key.data(),
+                                  key.size(),
+                                  encryption.iv,
+                                  privateKeyInfo.data(),
+                                  privateKeyInfo.size(),
+                                  true);
+    return Pkcs8::encode(encryption, encryptedData.data(), encryptedData.size());
 }
 
 bool KeyStore::compareCNGKeyWithPublicKey(NCRYPT_KEY_HANDLE rsaKeyHandle, const CERT_PUBLIC_KEY_INFO &toTestPublicKeyInfo) const {
@@ -124,12 +591,31 @@ bool KeyStore::compareCNGKeyWithPublicKey(NCRYPT_KEY_HANDLE rsaKeyHandle, const
     return result;
 }
 
-std::unique_ptr<KeyPair> KeyStore::getKeyPair(const CERT_PUBLIC_KEY_INFO &publicKeyInfo) const {
+std::shared_ptr<KeyPair> KeyStore::getKeyPair(const CERT_PUBLIC_KEY_INFO &publicKeyInfo) const {
     DWORD status = STATUS_SUCCESS;
     NCryptKeyName *nCryptKeyName = NULL;
     NCRYPT_KEY_HANDLE rsaKeyHandle = 0;
     void *ptr = NULL;
 
+    // The certificate of a request is usually imported shortly after its key was generated
+    auto openKeyPair = openKeys.findIf([&publicKeyInfo](KeyPair &keyPair) {
+        return CertComparePublicKeyInfo(X509_ASN_ENCODING,
+                                        const_cast<CERT_PUBLIC_KEY_INFO *>(keyPair.getPublicKeyInfo()),
+                                        const_cast<CERT_PUBLIC_KEY_INFO *>(&publicKeyInfo)) != FALSE;
+    });
+    if (openKeyPair) {
+        Metrics::GetInstance().increment("keystore.open_key_hits");
+        return openKeyPair;
+    }
+    Metrics::GetInstance().increment("keystore.open_key_misses");
+
+    // Every key of the store is opened, this is what orphaned keys make slow
+    auto start = std::chrono::steady_clock::now();
+    auto recordScan = [start] {
+        auto scan = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        Metrics::GetInstance().record("keystore.public_key_scan", static_cast<uint64_t>(scan.count()));
+    };
+
     while (true) {
         status = NCryptEnumKeys(cryptoProvider, NULL, &nCryptKeyName, &ptr, 0);
         if (status == NTE_NO_MORE_ITEMS) {
@@ -146,9 +632,11 @@ std::unique_ptr<KeyPair> KeyStore::getKeyPair(const CERT_PUBLIC_KEY_INFO &public
 
         if (compareCNGKeyWithPublicKey(rsaKeyHandle, publicKeyInfo)) {
             std::wstring keyName = std::wstring(nCryptKeyName->pszName);
-            auto keyPair = std::make_unique<KeyPair>(rsaKeyHandle, keyName);
+            auto keyPair = std::make_shared<KeyPair>(rsaKeyHandle, keyName);
+            openKeys.put(keyName, keyPair);
             NCryptFreeBuffer(nCryptKeyName);
             NCryptFreeBuffer(ptr);
+            recordScan();
             return keyPair;
         }
 
@@ -157,13 +645,101 @@ std::unique_ptr<KeyPair> KeyStore::getKeyPair(const CERT_PUBLIC_KEY_INFO &public
 
     NCryptFreeBuffer(nCryptKeyName);
     NCryptFreeBuffer(ptr);
+    recordScan();
     return nullptr;
 }
 
+std::vector<std::pair<std::wstring, std::wstring>> KeyStore::listKeys() const {
+    std::vector<std::pair<std::wstring, std::wstring>> keys;
+    DWORD status = STATUS_SUCCESS;
+    NCryptKeyName *nCryptKeyName = NULL;
+    void *ptr = NULL;
+
+    while (true) {
+        status = NCryptEnumKeys(cryptoProvider, NULL, &nCryptKeyName, &ptr, 0);
+        if (status == NTE_NO_MORE_ITEMS) {
+            break;
+        }
+        if (status != STATUS_SUCCESS) {
+            NCryptFreeBuffer(ptr);
+            throw KSException(__func__, __LINE__, status);
+        }
+        keys.push_back(std::make_pair(std::wstring(nCryptKeyName->pszName),
+                                      std::wstring(nCryptKeyName->pszAlgid ? nCryptKeyName->pszAlgid : L"")));
+        NCryptFreeBuffer(nCryptKeyName);
+        nCryptKeyName = NULL;
+    }
+    NCryptFreeBuffer(ptr);
+
+    return keys;
+}
+
+size_t KeyStore::closeDeletedKeys() const {
+    std::set<std::wstring> names;
+    for (auto &key : listKeys()) {
+        names.insert(key.first);
+    }
+    return openKeys.eraseIf([&names](const std::wstring &name) {
+        return names.find(name) == names.end();
+    });
+}
+
+std::vector<KeyCollector::Key> KeyStore::listHostKeys() const {
+    std::vector<KeyCollector::Key> keys;
+    DWORD status = STATUS_SUCCESS;
+    NCryptKeyName *nCryptKeyName = NULL;
+    NCRYPT_KEY_HANDLE keyHandle = 0;
+    void *ptr = NULL;
+
+    while (true) {
+        status = NCryptEnumKeys(cryptoProvider, NULL, &nCryptKeyName, &ptr, 0);
+        if (status == NTE_NO_MORE_ITEMS) {
+            break;
+        }
+        if (status != STATUS_SUCCESS) {
+            NCryptFreeBuffer(ptr);
+            throw KSException(__func__, __LINE__, status);
+        }
+        std::wstring keyName(nCryptKeyName->pszName);
+        NCryptFreeBuffer(nCryptKeyName);
+        nCryptKeyName = NULL;
+
+        status = NCryptOpenKey(cryptoProvider, &keyHandle, keyName.c_str(), 0, 0);
+        if (status != STATUS_SUCCESS) {
+            continue;
+        }
+        FILETIME created;
+        DWORD createdLg = 0;
+        status = NCryptGetProperty(keyHandle,
+                                   HOST_KEY_CREATED_PROPERTY,
+                                   reinterpret_cast<PBYTE>(&created),
+                                   sizeof(FILETIME),
+                                   &createdLg,
+                                   0);
+        NCryptFreeObject(keyHandle);
+        // Keys without the property are not created by this host
+        if ((status != STATUS_SUCCESS) || (createdLg != sizeof(FILETIME))) {
+            continue;
+        }
+        ULARGE_INTEGER ticks;
+        ticks.LowPart = created.dwLowDateTime;
+        ticks.HighPart = created.dwHighDateTime;
+        // FILETIME counts 100ns since 1601, time_t seconds since 1970
+        keys.push_back(KeyCollector::Key{keyName,
+                                         static_cast<time_t>(ticks.QuadPart / 10000000ULL - 11644473600ULL)});
+    }
+    NCryptFreeBuffer(ptr);
+
+    return keys;
+}
+
 void KeyStore::deleteKeyPair(const std::wstring &keyIdentifier) {
     DWORD status = STATUS_SUCCESS;
     NCRYPT_KEY_HANDLE keyHandle;
 
+    // The handle which is kept open must not outlive the key
+    openKeys.erase(keyIdentifier);
+
     status = NCryptOpenKey(cryptoProvider, &keyHandle, keyIdentifier.c_str(), 0, 0);
     if (status != STATUS_SUCCESS) {
         throw KSException(__func__, __LINE__, status);
@@ -179,5 +755,7 @@ void KeyStore::deleteKeyPair(const std::wstring &keyIdentifier) {
 }
 
 KeyStore::~KeyStore() {
+    // The keys are closed before their provider
+    openKeys.clear();
     NCryptFreeObject(cryptoProvider);
 };
\ No newline at end of file
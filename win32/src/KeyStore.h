@@ -5,9 +5,19 @@
 #ifndef KEYSTORE_HPP
 #define KEYSTORE_HPP
 #include "common.h"
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "KeyPair.h"
+#include "KeyCollector.h"
+#include "LruCache.h"
+
+// Persisted key property with the creation time (FILETIME) of the keys generated by this host
+#define HOST_KEY_CREATED_PROPERTY L"org.cryptable.pki.keymgmnt.created"
+// Number of opened keys which are kept for the next signature, a CSR batch fits in it
+#define KEYSTORE_OPEN_KEYS 16
 
 /**
  * @brief      This class gives access to the keystore(s) where 
@@ -29,24 +39,65 @@ public:
      * @param keyIdentifier Name of the key
      * @param bitLength length for the RSA key
      * @param  Force protection password/PIN protection
+     * @return the opened key, which is kept open for the next use of the key
      */
-    std::unique_ptr<KeyPair> generateKeyPair(const std::wstring &keyIdentifier,
+    std::shared_ptr<KeyPair> generateKeyPair(const std::wstring &keyIdentifier,
                                              u_long bitLength,
                                              bool forcePasswordProtection=false) const;
 
     /**
-     * Get the Key Pair with the corresponding name
+     * Get the Key Pair with the corresponding name, a recently used key is not opened again
      * @param keyIdentifier
-     * @return unique pointer of the asymmetric key pair
+     * @return shared pointer of the asymmetric key pair
      */
-    std::unique_ptr<KeyPair> getKeyPair(const std::wstring &keyIdentifier) const;
+    std::shared_ptr<KeyPair> getKeyPair(const std::wstring &keyIdentifier) const;
 
     /**
-     * Get the CNG key pair using the public key
+     * Get the CNG key pair using the public key. The recently used keys are compared first, before every key of
+     * the store is opened.
      * @param publicKeyInfo
      * @return
      */
-    std::unique_ptr<KeyPair> getKeyPair(const CERT_PUBLIC_KEY_INFO &publicKeyInfo) const;
+    std::shared_ptr<KeyPair> getKeyPair(const CERT_PUBLIC_KEY_INFO &publicKeyInfo) const;
+
+    /**
+     * Import an encrypted PKCS#8 private key, which is decrypted in locked memory. PBES2 keys (PBKDF2 with AES-CBC)
+     * are decrypted here, PKCS12 triple DES keys by the key storage provider.
+     * @param keyIdentifier Name of the key
+     * @param pkcs8 DER encoded EncryptedPrivateKeyInfo
+     * @param password zero terminated
+     * @param forcePasswordProtection Force protection password/PIN protection
+     * @return the opened key, which is kept open for the next use of the key
+     */
+    std::shared_ptr<KeyPair> importPkcs8(const std::wstring &keyIdentifier,
+                                         const unsigned char *pkcs8,
+                                         size_t pkcs8Lg,
+                                         const wchar_t *password,
+                                         bool forcePasswordProtection=false) const;
+
+    /**
+     * Export a key as encrypted PKCS#8 with PBES2, PBKDF2-HMAC-SHA256 and AES256-CBC. The provider only exports
+     * PKCS12 triple DES, with a random password, which is decrypted and encrypted again in locked memory.
+     * @param password zero terminated
+     * @param iterations PBKDF2 iterations, PKCS8_MIN_ITERATIONS up to PKCS8_MAX_ITERATIONS
+     * @return DER encoded EncryptedPrivateKeyInfo
+     */
+    std::vector<unsigned char> exportPkcs8(const std::wstring &keyIdentifier,
+                                           const wchar_t *password,
+                                           uint32_t iterations) const;
+
+    /**
+     * Key derivation of RFC 7292 appendix B with SHA-1, which decrypts the PKCS12 triple DES export of CNG
+     * @param password BMPString with its 2 terminating zero bytes
+     * @param id 1 for the key, 2 for the IV
+     */
+    static void pkcs12DeriveKey(const unsigned char *password,
+                                size_t passwordLg,
+                                const std::vector<unsigned char> &salt,
+                                uint32_t iterations,
+                                unsigned char id,
+                                unsigned char *output,
+                                size_t outputLg);
 
     /**
      * Delete the Key Pair with the corresponding name
@@ -54,15 +105,38 @@ public:
      */
     void deleteKeyPair(const std::wstring &keyIdentifier);
 
+    /**
+     * Close the opened keys which were deleted from the store by another process
+     * @return the number of closed keys
+     */
+    size_t closeDeletedKeys() const;
+
+    /**
+     * Names and algorithms of all keys, the keys are not opened
+     */
+    std::vector<std::pair<std::wstring, std::wstring>> listKeys() const;
+
+    /**
+     * The keys generated by this host, with their creation time
+     */
+    std::vector<KeyCollector::Key> listHostKeys() const;
+
     /**
      * @brief      Destroys the Keystore object and all it references.
      */
     ~KeyStore();
 
 private:
+    NCRYPT_KEY_HANDLE createKey(const std::wstring &keyIdentifier, u_long bitLength) const;
+
+    void setKeyPolicy(NCRYPT_KEY_HANDLE rsaKeyHandle, bool forcePasswordProtection) const;
+
     bool compareCNGKeyWithPublicKey(NCRYPT_KEY_HANDLE rsaKeyHandle, const CERT_PUBLIC_KEY_INFO &toTestPublicKeyInfo) const;
 
     NCRYPT_PROV_HANDLE cryptoProvider;
+
+    // Opening a key loads and checks the private key in the provider, which is done again for every handle
+    mutable LruCache<std::wstring, KeyPair> openKeys;
 };
 #endif // KEYSTORE_HPP
 /**********************************************************************************/
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_LRUCACHE_H
+#define KSMGMNT_LRUCACHE_H
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Thread safe cache which keeps the most recently used values and drops the least recently used one when it is
+ * full. The values are shared: a value which is dropped while a caller still uses it, is destroyed when the
+ * caller releases it.
+ */
+template <typename Key, typename Value>
+class LruCache {
+public:
+    /**
+     * @param capacity maximum number of values, a cache of capacity 0 keeps nothing
+     */
+    explicit LruCache(size_t capacity) : capacity{capacity} {
+    }
+
+    LruCache(const LruCache &) = delete;
+
+    void operator=(const LruCache &) = delete;
+
+    /**
+     * @return the value of the key, which becomes the most recently used one, or nullptr
+     */
+    std::shared_ptr<Value> find(const Key &key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto position = positions.find(key);
+        if (position == positions.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, position->second);
+        return position->second->second;
+    }
+
+    /**
+     * Search the values from the most to the least recently used one
+     * @param predicate called with the lock held, with a reference to the value
+     * @return the first value which matches, which becomes the most recently used one, or nullptr
+     */
+    template <typename Predicate>
+    std::shared_ptr<Value> findIf(Predicate predicate) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+            if (predicate(*entry->second)) {
+                entries.splice(entries.begin(), entries, entry);
+                return entry->second;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Add or replace the value of the key as the most recently used one
+     */
+    void put(const Key &key, std::shared_ptr<Value> value) {
+        // A dropped value is destroyed after the lock is released, its destructor can be slow
+        std::shared_ptr<Value> dropped;
+        std::lock_guard<std::mutex> guard(lock);
+        auto position = positions.find(key);
+        if (position != positions.end()) {
+            dropped = std::move(position->second->second);
+            position->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, position->second);
+            return;
+        }
+        if (capacity == 0) {
+            return;
+        }
+        if (entries.size() == capacity) {
+            dropped = std::move(entries.back().second);
+            positions.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        positions[key] = entries.begin();
+    }
+
+    /**
+     * Drop the value of the key
+     * @return true when the key was in the cache
+     */
+    bool erase(const Key &key) {
+        std::shared_ptr<Value> dropped;
+        std::lock_guard<std::mutex> guard(lock);
+        auto position = positions.find(key);
+        if (position == positions.end()) {
+            return false;
+        }
+        dropped = std::move(position->second->second);
+        entries.erase(position->second);
+        positions.erase(position);
+        return true;
+    }
+
+    /**
+     * Drop the values of the keys which match
+     * @param predicate called with the lock held, with a reference to the key
+     * @return the number of dropped values
+     */
+    template <typename Predicate>
+    size_t eraseIf(Predicate predicate) {
+        Entries dropped;
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto entry = entries.begin(); entry != entries.end();) {
+            auto next = std::next(entry);
+            if (predicate(entry->first)) {
+                positions.erase(entry->first);
+                dropped.splice(dropped.end(), entries, entry);
+            }
+            entry = next;
+        }
+        return dropped.size();
+    }
+
+    /**
+     * Drop all values
+     */
+    void clear() {
+        std::list<std::pair<Key, std::shared_ptr<Value>>> dropped;
+        std::lock_guard<std::mutex> guard(lock);
+        dropped.swap(entries);
+        positions.clear();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard(lock);
+        return entries.size();
+    }
+
+private:
+    typedef std::list<std::pair<Key, std::shared_ptr<Value>>> Entries;
+
+    const size_t capacity;
+    std::mutex lock;
+    // Most recently used value first
+    Entries entries;
+    std::unordered_map<Key, typename Entries::iterator> positions;
+};
+
+#endif //KSMGMNT_LRUCACHE_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,72 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "Metrics.h"
+
+Metrics &Metrics::GetInstance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::increment(const std::string &counter, uint64_t value) {
+    std::lock_guard<std::mutex> guard(lock);
+    counters[counter] += value;
+}
+
+void Metrics::set(const std::string &counter, uint64_t value) {
+    std::lock_guard<std::mutex> guard(lock);
+    counters[counter] = value;
+}
+
+void Metrics::record(const std::string &timer, uint64_t microseconds) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto &entry = timers[timer];
+    entry.count++;
+    entry.totalMicroseconds += microseconds;
+    if (microseconds > entry.maxMicroseconds) {
+        entry.maxMicroseconds = microseconds;
+    }
+}
+
+std::map<std::string, uint64_t> Metrics::getCounters() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return counters;
+}
+
+std::map<std::string, Metrics::Timer> Metrics::getTimers() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return timers;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    counters.clear();
+    timers.clear();
+}
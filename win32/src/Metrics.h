@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_METRICS_H
+#define KSMGMNT_METRICS_H
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * Process wide counters and timings, reported by the get_metrics request
+ */
+class Metrics {
+public:
+    struct Timer {
+        uint64_t count;
+        uint64_t totalMicroseconds;
+        uint64_t maxMicroseconds;
+    };
+
+    static Metrics &GetInstance();
+
+    Metrics(Metrics const&)          = delete;
+
+    void operator=(Metrics const&)   = delete;
+
+    void increment(const std::string &counter, uint64_t value = 1);
+
+    /**
+     * Set a counter which reports a current size instead of a total
+     */
+    void set(const std::string &counter, uint64_t value);
+
+    void record(const std::string &timer, uint64_t microseconds);
+
+    std::map<std::string, uint64_t> getCounters() const;
+
+    std::map<std::string, Timer> getTimers() const;
+
+    void reset();
+
+private:
+    Metrics() = default;
+
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, Timer> timers;
+    mutable std::mutex lock;
+};
+
+#endif //KSMGMNT_METRICS_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
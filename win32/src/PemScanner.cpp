@@ -0,0 +1,162 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+
+#include "PemScanner.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+static const char PEM_BEGIN[] = "-----BEGIN ";
+static const char PEM_END[] = "-----END ";
+static const char PEM_DASHES[] = "-----";
+
+static const char *find(const char *begin, const char *end, const char *text) {
+    const char *found = std::search(begin, end, text, text + strlen(text));
+    return (found == end) ? nullptr : found;
+}
+
+static int sextet(char c) {
+    if ((c >= 'A') && (c <= 'Z')) {
+        return c - 'A';
+    }
+    if ((c >= 'a') && (c <= 'z')) {
+        return c - 'a' + 26;
+    }
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+static bool isSpace(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+PemScanner::PemScanner(const char *pem, size_t size) : position{pem},
+                                                       end{pem + size},
+                                                       blockSize{0} {
+}
+
+bool PemScanner::next() {
+    blockSize = 0;
+    const char *begin = find(position, end, PEM_BEGIN);
+    if (begin == nullptr) {
+        position = end;
+        return false;
+    }
+    const char *labelBegin = begin + strlen(PEM_BEGIN);
+    const char *labelEnd = find(labelBegin, end, PEM_DASHES);
+    if ((labelEnd == nullptr) || (std::find(labelBegin, labelEnd, '\n') != labelEnd)) {
+        throw std::invalid_argument("PEM begin line without end");
+    }
+    blockLabel.assign(labelBegin, labelEnd);
+
+    const char *body = labelEnd + strlen(PEM_DASHES);
+    const char *bodyEnd = find(body, end, PEM_END);
+    if (bodyEnd == nullptr) {
+        throw std::invalid_argument("PEM block without end line");
+    }
+    const char *endLabel = bodyEnd + strlen(PEM_END);
+    if ((static_cast<size_t>(end - endLabel) < blockLabel.size() + strlen(PEM_DASHES)) ||
+        (blockLabel.compare(0, blockLabel.size(), endLabel, blockLabel.size()) != 0) ||
+        (strncmp(endLabel + blockLabel.size(), PEM_DASHES, strlen(PEM_DASHES)) != 0)) {
+        throw std::invalid_argument("PEM end line of another block");
+    }
+
+    decode(body, bodyEnd);
+    position = endLabel + blockLabel.size() + strlen(PEM_DASHES);
+    return true;
+}
+
+void PemScanner::decode(const char *body, const char *bodyEnd) {
+    // Base64 never decodes to more than 3 bytes per 4 characters
+    size_t maximum = (static_cast<size_t>(bodyEnd - body) / 4) * 3;
+    if (buffer.size() < maximum) {
+        buffer.resize(maximum);
+    }
+
+    uint32_t group = 0;
+    size_t groupLg = 0;
+    size_t padding = 0;
+    for (const char *c = body; c < bodyEnd; c++) {
+        if (isSpace(*c)) {
+            continue;
+        }
+        if (*c == '=') {
+            padding++;
+            group <<= 6;
+        }
+        else {
+            int value = sextet(*c);
+            // Nothing follows the padding
+            if ((value < 0) || (padding > 0)) {
+                throw std::invalid_argument("Invalid base64 in PEM block");
+            }
+            group = (group << 6) | static_cast<uint32_t>(value);
+        }
+        if (++groupLg == 4) {
+            if (padding > 2) {
+                throw std::invalid_argument("Invalid base64 in PEM block");
+            }
+            buffer[blockSize++] = static_cast<unsigned char>(group >> 16);
+            if (padding < 2) {
+                buffer[blockSize++] = static_cast<unsigned char>(group >> 8);
+            }
+            if (padding < 1) {
+                buffer[blockSize++] = static_cast<unsigned char>(group);
+            }
+            group = 0;
+            groupLg = 0;
+        }
+    }
+    if (groupLg != 0) {
+        throw std::invalid_argument("Invalid base64 in PEM block");
+    }
+}
+
+const std::string &PemScanner::label() const {
+    return blockLabel;
+}
+
+const unsigned char *PemScanner::data() const {
+    return buffer.data();
+}
+
+size_t PemScanner::size() const {
+    return blockSize;
+}
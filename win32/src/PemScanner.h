@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_PEMSCANNER_H
+#define KSMGMNT_PEMSCANNER_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Reads the blocks of a PEM file, like a bundle of certificates, one at a time (RFC 7468). The scanner does
+ * not copy the text: every block is decoded straight from the text of the caller into one buffer, which is
+ * reused for the next block. The text around the blocks, like the bag attributes written by openssl, is skipped.
+ */
+class PemScanner {
+public:
+    /**
+     * @param pem text of the caller, which must outlive the scanner
+     */
+    PemScanner(const char *pem, size_t size);
+
+    /**
+     * Decode the next block, data() and label() are valid until the next call
+     * @return false when there are no more blocks
+     * throws std::invalid_argument on a block without end line, with another label at its end line or with
+     * invalid base64
+     */
+    bool next();
+
+    /**
+     * The label of the begin line, like CERTIFICATE or PKCS7
+     */
+    const std::string &label() const;
+
+    const unsigned char *data() const;
+
+    size_t size() const;
+
+private:
+    void decode(const char *body, const char *bodyEnd);
+
+    const char *position;
+    const char *end;
+    std::string blockLabel;
+    // Grows to the largest block
+    std::vector<unsigned char> buffer;
+    size_t blockSize;
+};
+
+#endif //KSMGMNT_PEMSCANNER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
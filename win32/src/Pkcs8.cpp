@@ -0,0 +1,274 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "Pkcs8.h"
+#include <stdexcept>
+
+static const unsigned char OID_PBES2[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x05, 0x0D };
+static const unsigned char OID_PBKDF2[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x05, 0x0C };
+static const unsigned char OID_HMAC_SHA1[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x02, 0x07 };
+static const unsigned char OID_HMAC_SHA256[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x02, 0x09 };
+static const unsigned char OID_AES128_CBC[] = { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x01, 0x02 };
+static const unsigned char OID_AES192_CBC[] = { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x01, 0x16 };
+static const unsigned char OID_AES256_CBC[] = { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x01, 0x2A };
+static const unsigned char OID_PKCS12_3DES[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x0C, 0x01, 0x03 };
+
+#define PKCS8_AES_BLOCK 16
+#define PKCS8_3DES_BLOCK 8
+
+static bool isOid(const DerBlob &oid, const unsigned char *expected, size_t expectedLg) {
+    return oid == DerBlob{ expected, expectedLg };
+}
+
+static uint32_t decodeUnsigned(const DerBlob &integer) {
+    if (integer.empty() || (integer.data[0] & 0x80)) {
+        throw std::invalid_argument("PKCS8: negative or empty integer");
+    }
+    size_t start = (integer.data[0] == 0) ? 1 : 0;
+    if (integer.size - start > sizeof(uint32_t)) {
+        throw std::invalid_argument("PKCS8: integer too large");
+    }
+    uint32_t value = 0;
+    for (size_t i = start; i < integer.size; i++) {
+        value = (value << 8) | integer.data[i];
+    }
+    return value;
+}
+
+static uint32_t decodeIterations(const DerBlob &integer) {
+    uint32_t iterations = decodeUnsigned(integer);
+    if ((iterations == 0) || (iterations > PKCS8_MAX_ITERATIONS)) {
+        throw std::invalid_argument("PKCS8: unsupported number of iterations");
+    }
+    return iterations;
+}
+
+static void decodePbes2(const DerBlob &parameters, Pkcs8::Encryption &encryption) {
+    DerReader reader(parameters);
+    DerReader kdfReader(reader.read(DER_SEQUENCE).content);
+    DerReader schemeReader(reader.read(DER_SEQUENCE).content);
+
+    if (!isOid(kdfReader.read(DER_OID).content, OID_PBKDF2, sizeof(OID_PBKDF2))) {
+        throw std::invalid_argument("PKCS8: unsupported key derivation");
+    }
+    DerReader pbkdf2Reader(kdfReader.read(DER_SEQUENCE).content);
+    auto salt = pbkdf2Reader.read(DER_OCTET_STRING).content;
+    encryption.salt.assign(salt.data, salt.data + salt.size);
+    encryption.iterations = decodeIterations(pbkdf2Reader.read(DER_INTEGER).content);
+    DerElement element;
+    size_t keyLength = 0;
+    if (pbkdf2Reader.readOptional(DER_INTEGER, element)) {
+        keyLength = decodeUnsigned(element.content);
+    }
+    encryption.prf = Pkcs8::prfAlgorithm::HmacSha1;
+    if (pbkdf2Reader.readOptional(DER_SEQUENCE, element)) {
+        DerReader prfReader(element.content);
+        auto prf = prfReader.read(DER_OID).content;
+        if (isOid(prf, OID_HMAC_SHA256, sizeof(OID_HMAC_SHA256))) {
+            encryption.prf = Pkcs8::prfAlgorithm::HmacSha256;
+        }
+        else if (!isOid(prf, OID_HMAC_SHA1, sizeof(OID_HMAC_SHA1))) {
+            throw std::invalid_argument("PKCS8: unsupported pseudo random function");
+        }
+    }
+
+    auto cipher = schemeReader.read(DER_OID).content;
+    if (isOid(cipher, OID_AES128_CBC, sizeof(OID_AES128_CBC))) {
+        encryption.keyLength = 16;
+    }
+    else if (isOid(cipher, OID_AES192_CBC, sizeof(OID_AES192_CBC))) {
+        encryption.keyLength = 24;
+    }
+    else if (isOid(cipher, OID_AES256_CBC, sizeof(OID_AES256_CBC))) {
+        encryption.keyLength = 32;
+    }
+    else {
+        throw std::invalid_argument("PKCS8: unsupported cipher");
+    }
+    if ((keyLength != 0) && (keyLength != encryption.keyLength)) {
+        throw std::invalid_argument("PKCS8: key length does not match the cipher");
+    }
+    auto iv = schemeReader.read(DER_OCTET_STRING).content;
+    if (iv.size != PKCS8_AES_BLOCK) {
+        throw std::invalid_argument("PKCS8: invalid IV");
+    }
+    encryption.iv.assign(iv.data, iv.data + iv.size);
+}
+
+Pkcs8::EncryptedKey Pkcs8::decode(const unsigned char *data, size_t size) {
+    EncryptedKey key;
+    DerReader reader(data, size);
+    DerReader infoReader(reader.read(DER_SEQUENCE).content);
+    if (!reader.atEnd()) {
+        throw std::invalid_argument("PKCS8: data after the key");
+    }
+    DerReader algorithmReader(infoReader.read(DER_SEQUENCE).content);
+    key.encryptedData = infoReader.read(DER_OCTET_STRING).content;
+
+    auto algorithm = algorithmReader.read(DER_OID).content;
+    auto parameters = algorithmReader.read(DER_SEQUENCE).content;
+    size_t blockSize;
+    if (isOid(algorithm, OID_PBES2, sizeof(OID_PBES2))) {
+        key.encryption.scheme = encryptionScheme::Pbes2;
+        decodePbes2(parameters, key.encryption);
+        blockSize = PKCS8_AES_BLOCK;
+    }
+    else if (isOid(algorithm, OID_PKCS12_3DES, sizeof(OID_PKCS12_3DES))) {
+        key.encryption.scheme = encryptionScheme::Pkcs12TripleDes;
+        DerReader parametersReader(parameters);
+        auto salt = parametersReader.read(DER_OCTET_STRING).content;
+        key.encryption.salt.assign(salt.data, salt.data + salt.size);
+        key.encryption.iterations = decodeIterations(parametersReader.read(DER_INTEGER).content);
+        key.encryption.prf = prfAlgorithm::HmacSha1;
+        key.encryption.keyLength = 24;
+        blockSize = PKCS8_3DES_BLOCK;
+    }
+    else {
+        throw std::invalid_argument("PKCS8: unsupported encryption");
+    }
+    // CBC with padding always produces whole blocks
+    if (key.encryptedData.empty() || (key.encryptedData.size % blockSize != 0)) {
+        throw std::invalid_argument("PKCS8: invalid encrypted data");
+    }
+    return key;
+}
+
+static void appendElement(std::vector<unsigned char> &output,
+                          unsigned char tag,
+                          const unsigned char *content,
+                          size_t contentLg) {
+    output.push_back(tag);
+    if (contentLg < 0x80) {
+        output.push_back(static_cast<unsigned char>(contentLg));
+    }
+    else {
+        unsigned char length[sizeof(size_t)];
+        size_t lengthBytes = 0;
+        for (size_t value = contentLg; value > 0; value >>= 8) {
+            length[lengthBytes++] = static_cast<unsigned char>(value);
+        }
+        output.push_back(static_cast<unsigned char>(0x80 | lengthBytes));
+        while (lengthBytes > 0) {
+            output.push_back(length[--lengthBytes]);
+        }
+    }
+    output.insert(output.end(), content, content + contentLg);
+}
+
+static void appendElement(std::vector<unsigned char> &output,
+                          unsigned char tag,
+                          const std::vector<unsigned char> &content) {
+    appendElement(output, tag, content.data(), content.size());
+}
+
+static void appendUnsigned(std::vector<unsigned char> &output, uint32_t value) {
+    unsigned char integer[sizeof(uint32_t) + 1];
+    size_t integerLg = 0;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        unsigned char byte = static_cast<unsigned char>(value >> shift);
+        // Minimal encoding, with a leading zero when the high bit is set
+        if ((integerLg == 0) && (byte == 0) && (shift > 0)) {
+            continue;
+        }
+        if ((integerLg == 0) && (byte & 0x80)) {
+            integer[integerLg++] = 0;
+        }
+        integer[integerLg++] = byte;
+    }
+    appendElement(output, DER_INTEGER, integer, integerLg);
+}
+
+std::vector<unsigned char> Pkcs8::encode(const Encryption &encryption,
+                                         const unsigned char *encryptedData,
+                                         size_t encryptedDataLg) {
+    std::vector<unsigned char> algorithm;
+    if (encryption.scheme == encryptionScheme::Pbes2) {
+        std::vector<unsigned char> pbkdf2;
+        appendElement(pbkdf2, DER_OCTET_STRING, encryption.salt);
+        appendUnsigned(pbkdf2, encryption.iterations);
+        // HMAC-SHA1 is the default, which DER leaves out
+        if (encryption.prf == prfAlgorithm::HmacSha256) {
+            std::vector<unsigned char> prf;
+            appendElement(prf, DER_OID, OID_HMAC_SHA256, sizeof(OID_HMAC_SHA256));
+            appendElement(prf, DER_NULL, nullptr, 0);
+            appendElement(pbkdf2, DER_SEQUENCE, prf);
+        }
+        std::vector<unsigned char> kdf;
+        appendElement(kdf, DER_OID, OID_PBKDF2, sizeof(OID_PBKDF2));
+        appendElement(kdf, DER_SEQUENCE, pbkdf2);
+
+        std::vector<unsigned char> scheme;
+        if (encryption.keyLength == 16) {
+            appendElement(scheme, DER_OID, OID_AES128_CBC, sizeof(OID_AES128_CBC));
+        }
+        else if (encryption.keyLength == 24) {
+            appendElement(scheme, DER_OID, OID_AES192_CBC, sizeof(OID_AES192_CBC));
+        }
+        else if (encryption.keyLength == 32) {
+            appendElement(scheme, DER_OID, OID_AES256_CBC, sizeof(OID_AES256_CBC));
+        }
+        else {
+            throw std::invalid_argument("PKCS8: unsupported cipher");
+        }
+        appendElement(scheme, DER_OCTET_STRING, encryption.iv);
+
+        std::vector<unsigned char> pbes2;
+        appendElement(pbes2, DER_SEQUENCE, kdf);
+        appendElement(pbes2, DER_SEQUENCE, scheme);
+        appendElement(algorithm, DER_OID, OID_PBES2, sizeof(OID_PBES2));
+        appendElement(algorithm, DER_SEQUENCE, pbes2);
+    }
+    else {
+        appendElement(algorithm, DER_OID, OID_PKCS12_3DES, sizeof(OID_PKCS12_3DES));
+        auto parameters = encodePkcs12Parameters(encryption.salt, encryption.iterations);
+        algorithm.insert(algorithm.end(), parameters.begin(), parameters.end());
+    }
+
+    std::vector<unsigned char> info;
+    appendElement(info, DER_SEQUENCE, algorithm);
+    appendElement(info, DER_OCTET_STRING, encryptedData, encryptedDataLg);
+    std::vector<unsigned char> encoded;
+    appendElement(encoded, DER_SEQUENCE, info);
+    return encoded;
+}
+
+const char *Pkcs8::getPkcs12TripleDesOid() {
+    return "1.2.840.113549.1.12.1.3";
+}
+
+std::vector<unsigned char> Pkcs8::encodePkcs12Parameters(const std::vector<unsigned char> &salt,
+                                                         uint32_t iterations) {
+    std::vector<unsigned char> parameters;
+    appendElement(parameters, DER_OCTET_STRING, salt);
+    appendUnsigned(parameters, iterations);
+    std::vector<unsigned char> encoded;
+    appendElement(encoded, DER_SEQUENCE, parameters);
+    return encoded;
+}
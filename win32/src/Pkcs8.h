@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_PKCS8_H
+#define KSMGMNT_PKCS8_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DerReader.h"
+
+// PBKDF2 iterations of an exported key when the request does not set them
+#define PKCS8_DEFAULT_ITERATIONS 100000
+// Bounds of the iterations, more than the maximum lets a request keep a core busy for minutes
+#define PKCS8_MIN_ITERATIONS 1000
+#define PKCS8_MAX_ITERATIONS 10000000
+
+/**
+ * Encoding and decoding of encrypted PKCS#8 private keys (EncryptedPrivateKeyInfo, RFC 5958), without the
+ * cryptography. Two encryptions are supported:
+ * - PBES2 (RFC 8018) with PBKDF2 (HMAC-SHA1 or HMAC-SHA256) and AES-CBC, which is what openssl writes
+ * - pbeWithSHAAnd3-KeyTripleDES-CBC (RFC 7292), the only encryption which CNG uses to export a key
+ * Malformed or unsupported data throws a std::invalid_argument.
+ */
+class Pkcs8 {
+public:
+    enum class encryptionScheme {
+        Pbes2 = 0,
+        Pkcs12TripleDes
+    };
+
+    enum class prfAlgorithm {
+        HmacSha1 = 0,
+        HmacSha256
+    };
+
+    struct Encryption {
+        encryptionScheme scheme;
+        std::vector<unsigned char> salt;
+        uint32_t iterations;
+        // PBES2 only
+        prfAlgorithm prf;
+        size_t keyLength;                   // 16, 24 or 32 bytes of AES
+        std::vector<unsigned char> iv;
+    };
+
+    struct EncryptedKey {
+        Encryption encryption;
+        DerBlob encryptedData;              // points into the decoded data
+    };
+
+    /**
+     * @param data DER encoded EncryptedPrivateKeyInfo
+     */
+    static EncryptedKey decode(const unsigned char *data, size_t size);
+
+    /**
+     * @return DER encoded EncryptedPrivateKeyInfo
+     */
+    static std::vector<unsigned char> encode(const Encryption &encryption,
+                                             const unsigned char *encryptedData,
+                                             size_t encryptedDataLg);
+
+    /**
+     * The object identifier of pbeWithSHAAnd3-KeyTripleDES-CBC in dotted form, for the export of CNG
+     */
+    static const char *getPkcs12TripleDesOid();
+
+    /**
+     * @return DER encoded pkcs-12PbeParams, for the export of CNG
+     */
+    static std::vector<unsigned char> encodePkcs12Parameters(const std::vector<unsigned char> &salt,
+                                                             uint32_t iterations);
+};
+
+#endif //KSMGMNT_PKCS8_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,77 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "RequestRegistry.h"
+
+static bool hasType(const nlohmann::json &value, RequestSchema::fieldType type) {
+    switch (type) {
+        case RequestSchema::fieldType::String:
+            return value.is_string();
+        case RequestSchema::fieldType::Unsigned:
+            return value.is_number_unsigned();
+        case RequestSchema::fieldType::Integer:
+            return value.is_number_integer();
+        case RequestSchema::fieldType::Boolean:
+            return value.is_boolean();
+        case RequestSchema::fieldType::Array:
+            return value.is_array();
+        default:
+            return true;
+    }
+}
+
+const char *RequestSchema::validate(nlohmann::json &request,
+                                    const Field *fields,
+                                    size_t fieldCount,
+                                    Values &values) {
+    if (!request.is_object()) {
+        return "Request is not an object";
+    }
+    values = Values();
+    for (auto item = request.begin(); item != request.end(); ++item) {
+        const std::string &key = item.key();
+        uint32_t keyHash = hash(key.data(), key.size());
+        for (size_t i = 0; i < fieldCount; i++) {
+            if ((fields[i].hash == keyHash) && (key == fields[i].name)) {
+                if (!hasType(item.value(), fields[i].type)) {
+                    return "Invalid Parameter type";
+                }
+                values.values[i] = &item.value();
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < fieldCount; i++) {
+        if (fields[i].required && (values.values[i] == nullptr)) {
+            return "Missing Parameters";
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_REQUESTREGISTRY_H
+#define KSMGMNT_REQUESTREGISTRY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "RequestScheduler.h"
+
+// Maximum number of fields of a request type, request and request_id are not counted
+#define REQUEST_MAX_FIELDS 8
+// Seeds tried to find a collision free slot for every request type
+#define REQUEST_MAX_SEEDS 4096
+
+/**
+ * Fields of a request type, and the validation of a request against them in one pass over the request.
+ */
+class RequestSchema {
+public:
+    enum class fieldType {
+        String = 0,
+        Unsigned,
+        Integer,
+        Boolean,
+        Array,
+        Any
+    };
+
+    struct Field {
+        constexpr Field(const char *fieldName, fieldType valueType, bool isRequired) :
+                name{fieldName}, hash{RequestSchema::hash(fieldName)}, type{valueType}, required{isRequired} {
+        }
+
+        const char *name;
+        uint32_t hash;
+        fieldType type;
+        bool required;
+    };
+
+    /**
+     * Fields of a validated request, in the order of the schema, nullptr when an optional field is absent.
+     * The values point into the request.
+     */
+    class Values {
+    public:
+        Values() : values{} {
+        }
+
+        nlohmann::json *operator[](size_t field) const {
+            return values[field];
+        }
+
+    private:
+        friend class RequestSchema;
+
+        nlohmann::json *values[REQUEST_MAX_FIELDS];
+    };
+
+    /**
+     * FNV-1a
+     */
+    static constexpr uint32_t hash(const char *text, uint32_t seed = 2166136261u) {
+        uint32_t value = seed;
+        for (; *text != '\0'; text++) {
+            value = (value ^ static_cast<unsigned char>(*text)) * 16777619u;
+        }
+        return value;
+    }
+
+    static constexpr uint32_t hash(const char *text, size_t size, uint32_t seed = 2166136261u) {
+        uint32_t value = seed;
+        for (size_t i = 0; i < size; i++) {
+            value = (value ^ static_cast<unsigned char>(text[i])) * 16777619u;
+        }
+        return value;
+    }
+
+    /**
+     * Look up the fields of a request, fields which are not in the schema are ignored
+     * @param request JSON object
+     * @return nullptr when the request is valid, otherwise the error (a static string)
+     */
+    static const char *validate(nlohmann::json &request, const Field *fields, size_t fieldCount, Values &values);
+};
+
+/**
+ * A request type: its name, fields, the function which runs it and the workers which run it
+ */
+template <typename Handler>
+struct RequestType {
+    constexpr RequestType() :
+            name{nullptr}, fields{nullptr}, fieldCount{0}, handler{nullptr},
+            cost{RequestScheduler::costClass::Interactive}, cached{false} {
+    }
+
+    constexpr RequestType(const char *typeName,
+                          Handler typeHandler,
+                          RequestScheduler::costClass typeCost = RequestScheduler::costClass::Interactive,
+                          bool typeCached = false) :
+            name{typeName}, fields{nullptr}, fieldCount{0}, handler{typeHandler}, cost{typeCost},
+            cached{typeCached} {
+    }
+
+    template <size_t M>
+    constexpr RequestType(const char *typeName,
+                          const RequestSchema::Field (&typeFields)[M],
+                          Handler typeHandler,
+                          RequestScheduler::costClass typeCost = RequestScheduler::costClass::Interactive,
+                          bool typeCached = false) :
+            name{typeName}, fields{typeFields}, fieldCount{M}, handler{typeHandler}, cost{typeCost},
+            cached{typeCached} {
+        static_assert(M <= REQUEST_MAX_FIELDS, "too many fields, raise REQUEST_MAX_FIELDS");
+    }
+
+    const char *validate(nlohmann::json &request, RequestSchema::Values &values) const {
+        return RequestSchema::validate(request, fields, fieldCount, values);
+    }
+
+    const char *name;
+    const RequestSchema::Field *fields;
+    size_t fieldCount;
+    Handler handler;
+    // Key generation and password based key derivation take seconds, everything else milliseconds
+    RequestScheduler::costClass cost;
+    // The response is kept for retries, for requests which change the store and must not run twice
+    bool cached;
+};
+
+/**
+ * Smallest power of two which is not below minimum
+ */
+constexpr size_t requestSlotCount(size_t minimum) {
+    size_t count = 1;
+    while (count < minimum) {
+        count <<= 1;
+    }
+    return count;
+}
+
+/**
+ * Dispatch table of the request types, built at compile time. The names are hashed with a seed for which
+ * every request type gets its own slot, so a lookup is one hash and one string compare.
+ */
+template <typename Handler, size_t N>
+class RequestDispatcher {
+public:
+    static_assert(N < 256, "slots hold 8 bit indexes");
+
+    static constexpr size_t SLOT_COUNT = requestSlotCount(N * 4);
+
+    constexpr explicit RequestDispatcher(const RequestType<Handler> (&requestTypes)[N]) :
+            types{}, slots{}, seed{findSeed(requestTypes)} {
+        for (size_t i = 0; i < N; i++) {
+            types[i] = requestTypes[i];
+            slots[RequestSchema::hash(requestTypes[i].name, seed) & (SLOT_COUNT - 1)] = static_cast<uint8_t>(i + 1);
+        }
+    }
+
+    /**
+     * false when no seed was found, for instance because a name is registered twice
+     */
+    constexpr bool isPerfect() const {
+        return seed != 0;
+    }
+
+    /**
+     * @return nullptr for an unknown request
+     */
+    const RequestType<Handler> *find(const std::string &name) const {
+        uint8_t slot = slots[RequestSchema::hash(name.data(), name.size(), seed) & (SLOT_COUNT - 1)];
+        if ((slot == 0) || (name != types[slot - 1].name)) {
+            return nullptr;
+        }
+        return &types[slot - 1];
+    }
+
+private:
+    static constexpr uint32_t findSeed(const RequestType<Handler> (&requestTypes)[N]) {
+        for (uint32_t candidate = 1; candidate <= REQUEST_MAX_SEEDS; candidate++) {
+            bool used[SLOT_COUNT] = {};
+            bool collision = false;
+            for (size_t i = 0; (i < N) && !collision; i++) {
+                size_t slot = RequestSchema::hash(requestTypes[i].name, candidate) & (SLOT_COUNT - 1);
+                collision = used[slot];
+                used[slot] = true;
+            }
+            if (!collision) {
+                return candidate;
+            }
+        }
+        return 0;
+    }
+
+    RequestType<Handler> types[N];
+    uint8_t slots[SLOT_COUNT];
+    uint32_t seed;
+};
+
+template <typename Handler, size_t N>
+constexpr RequestDispatcher<Handler, N> makeRequestDispatcher(const RequestType<Handler> (&requestTypes)[N]) {
+    return RequestDispatcher<Handler, N>(requestTypes);
+}
+
+#endif //KSMGMNT_REQUESTREGISTRY_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
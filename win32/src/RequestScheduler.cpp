@@ -0,0 +1,110 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <stdexcept>
+#include "RequestScheduler.h"
+#include "Metrics.h"
+
+RequestScheduler::RequestScheduler(size_t heavyWorkers, size_t interactiveWorkers) : stopping{false} {
+    if ((heavyWorkers == 0) || (interactiveWorkers == 0)) {
+        throw std::invalid_argument("every cost class needs a worker");
+    }
+    for (size_t i = 0; i < heavyWorkers; i++) {
+        workers.emplace_back(&RequestScheduler::work, this, true);
+    }
+    for (size_t i = 0; i < interactiveWorkers; i++) {
+        workers.emplace_back(&RequestScheduler::work, this, false);
+    }
+}
+
+RequestScheduler::~RequestScheduler() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<void> RequestScheduler::submit(costClass cost, std::function<void()> request) {
+    Task task{std::packaged_task<void()>(request), std::chrono::steady_clock::now()};
+    auto result = task.request.get_future();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (cost == costClass::Heavy) {
+            heavyQueue.push_back(std::move(task));
+        }
+        else {
+            interactiveQueue.push_back(std::move(task));
+        }
+    }
+    // Interactive requests can be run by both kinds of workers
+    available.notify_all();
+
+    return result;
+}
+
+size_t RequestScheduler::getQueueLength(costClass cost) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return (cost == costClass::Heavy) ? heavyQueue.size() : interactiveQueue.size();
+}
+
+void RequestScheduler::work(bool heavyWorker) {
+    for (;;) {
+        Task task;
+        const char *timer;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            available.wait(guard, [this, heavyWorker] {
+                return stopping || !interactiveQueue.empty() || (heavyWorker && !heavyQueue.empty());
+            });
+            if (heavyWorker && !heavyQueue.empty()) {
+                task = std::move(heavyQueue.front());
+                heavyQueue.pop_front();
+                timer = "queue_wait.heavy";
+            }
+            else if (!interactiveQueue.empty()) {
+                task = std::move(interactiveQueue.front());
+                interactiveQueue.pop_front();
+                timer = "queue_wait.interactive";
+            }
+            else {
+                // Stopping with nothing left to run
+                return;
+            }
+        }
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - task.queued);
+        Metrics::GetInstance().record(timer, static_cast<uint64_t>(wait.count()));
+        task.request();
+    }
+}
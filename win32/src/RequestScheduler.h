@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_REQUESTSCHEDULER_H
+#define KSMGMNT_REQUESTSCHEDULER_H
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs requests on a worker pool with a queue per cost class, so cheap requests the user waits for
+ * are not queued behind key generations. Heavy workers run heavy requests first and help with the
+ * interactive queue when there is no heavy work, interactive workers only run interactive requests.
+ * The queue wait per class is recorded in Metrics as queue_wait.heavy and queue_wait.interactive.
+ */
+class RequestScheduler {
+public:
+    enum class costClass {
+        Interactive = 0,
+        Heavy
+    };
+
+    /**
+     * throws std::invalid_argument when a class has no workers
+     */
+    RequestScheduler(size_t heavyWorkers, size_t interactiveWorkers);
+
+    /**
+     * Runs the queued requests and stops the workers
+     */
+    ~RequestScheduler();
+
+    RequestScheduler(const RequestScheduler &) = delete;
+
+    void operator=(const RequestScheduler &) = delete;
+
+    std::future<void> submit(costClass cost, std::function<void()> request);
+
+    size_t getQueueLength(costClass cost) const;
+
+private:
+    struct Task {
+        std::packaged_task<void()> request;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    void work(bool heavyWorker);
+
+    std::deque<Task> heavyQueue;
+    std::deque<Task> interactiveQueue;
+    mutable std::mutex lock;
+    std::condition_variable available;
+    bool stopping;
+    std::vector<std::thread> workers;
+};
+
+#endif //KSMGMNT_REQUESTSCHEDULER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
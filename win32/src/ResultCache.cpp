@@ -0,0 +1,122 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "ResultCache.h"
+
+ResultCache::ResultCache(size_t e, size_t b, Clock::duration t) : maxEntries{e}, maxBytes{b}, ttl(t), bytes{0} {
+}
+
+std::string ResultCache::getOrRun(const std::string &key, const Producer &producer) {
+    std::promise<std::string> promise;
+    std::shared_future<std::string> response;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        evict(Clock::now());
+        auto existing = entries.find(key);
+        if (existing != entries.end()) {
+            response = existing->second.response;
+        }
+        else {
+            order.push_back(key);
+            Entry &entry = entries[key];
+            entry.response = promise.get_future().share();
+            entry.ready = false;
+            entry.bytes = 0;
+            entry.position = std::prev(order.end());
+        }
+    }
+    if (response.valid()) {
+        // A duplicate, wait for the first request outside the lock
+        return response.get();
+    }
+
+    bool cacheable = true;
+    std::string result;
+    try {
+        result = producer(cacheable);
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (cacheable) {
+            Entry &entry = entries[key];
+            entry.ready = true;
+            entry.expires = Clock::now() + ttl;
+            entry.bytes = result.size();
+            bytes += result.size();
+            evict(Clock::now());
+        }
+        else {
+            erase(key);
+        }
+    }
+    // Duplicates which are already waiting get the response, also when it is not cached
+    promise.set_value(result);
+
+    return result;
+}
+
+size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+void ResultCache::evict(Clock::time_point now) {
+    // Expiry follows the completion of a request, not the order, so check all entries
+    auto it = order.begin();
+    while (it != order.end()) {
+        auto entry = entries.find(*it);
+        ++it;
+        // Running requests are never evicted, their duplicates must find them
+        if (!entry->second.ready) {
+            continue;
+        }
+        if ((entry->second.expires <= now) || (entries.size() > maxEntries) || (bytes > maxBytes)) {
+            erase(entry->first);
+        }
+    }
+}
+
+void ResultCache::erase(const std::string &key) {
+    auto entry = entries.find(key);
+    if (entry == entries.end()) {
+        return;
+    }
+    bytes -= entry->second.bytes;
+    order.erase(entry->second.position);
+    entries.erase(entry);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_RESULTCACHE_H
+#define KSMGMNT_RESULTCACHE_H
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Default bounds of the cache of the request handler
+#define RESULT_CACHE_MAX_ENTRIES 256
+#define RESULT_CACHE_MAX_BYTES (64 * 1024 * 1024)
+#define RESULT_CACHE_TTL std::chrono::minutes(10)
+
+/**
+ * Responses of recent requests, so a retried request returns the first response instead of running
+ * again (and generating a second key). Concurrent duplicates wait for the first one to finish.
+ */
+class ResultCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Runs the request, sets cacheable to false for responses which must not be reused
+     */
+    typedef std::function<std::string(bool &cacheable)> Producer;
+
+    ResultCache(size_t maxEntries = RESULT_CACHE_MAX_ENTRIES,
+                size_t maxBytes = RESULT_CACHE_MAX_BYTES,
+                Clock::duration ttl = RESULT_CACHE_TTL);
+
+    /**
+     * Return the cached response of key, or run the producer and cache its response
+     * throws the exception of the producer, to all callers waiting for it
+     */
+    std::string getOrRun(const std::string &key, const Producer &producer);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::shared_future<std::string> response;
+        bool ready;
+        Clock::time_point expires;
+        size_t bytes;
+        std::list<std::string>::iterator position;
+    };
+
+    void evict(Clock::time_point now);
+
+    void erase(const std::string &key);
+
+    size_t maxEntries;
+    size_t maxBytes;
+    Clock::duration ttl;
+    size_t bytes;
+    std::map<std::string, Entry> entries;
+    // Keys from old to new
+    std::list<std::string> order;
+    mutable std::mutex lock;
+};
+
+#endif //KSMGMNT_RESULTCACHE_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
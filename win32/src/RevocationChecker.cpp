@@ -0,0 +1,272 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "RevocationChecker.h"
+#include <shlwapi.h>
+#include <wincrypt.h>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "KSException.h"
+#include "LogEvent.h"
+
+#define CRL_INDEX_DIRECTORY "org.cryptable.pki.keymgmnt"
+
+/**
+ * Name of the index of a CRL directory, several CRL directories can share the index directory
+ */
+static std::string getIndexName(const std::string &crlDirectory) {
+    // FNV-1a, the name only has to be stable between the processes
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : crlDirectory) {
+        hash = (hash ^ static_cast<unsigned char>(tolower(static_cast<unsigned char>(c)))) * 1099511628211ull;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "crl-%016llx.idx", static_cast<unsigned long long>(hash));
+    return name;
+}
+
+RevocationChecker::RevocationChecker(const std::string &crlDirectory,
+                                     const std::string &indexDirectory) : directory(crlDirectory),
+                                                                          fileHandle{INVALID_HANDLE_VALUE},
+                                                                          mappingHandle{nullptr},
+                                                                          mappedIndex{nullptr} {
+    indexFilename = (indexDirectory.empty() ? directory : indexDirectory) + "\\" + getIndexName(directory);
+}
+
+RevocationChecker::~RevocationChecker() {
+    unmapIndex();
+}
+
+std::string RevocationChecker::getDefaultDirectory() {
+    CHAR path[MAX_PATH];
+    if (!GetModuleFileName(nullptr, path, MAX_PATH)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    PathRemoveFileSpec(path);
+    return std::string(path) + "\\crl";
+}
+
+std::string RevocationChecker::getDefaultIndexDirectory() {
+    // The directory of the executable is usually not writable for the user
+    CHAR localAppData[MAX_PATH];
+    DWORD localAppDataLg = GetEnvironmentVariableA("LOCALAPPDATA", localAppData, MAX_PATH);
+    if ((localAppDataLg == 0) || (localAppDataLg >= MAX_PATH)) {
+        return std::string();
+    }
+    std::string indexDirectory = std::string(localAppData) + "\\" CRL_INDEX_DIRECTORY;
+    if (!CreateDirectoryA(indexDirectory.c_str(), nullptr) && (GetLastError() != ERROR_ALREADY_EXISTS)) {
+        return std::string();
+    }
+    return indexDirectory;
+}
+
+RevocationIndex::revocationStatus RevocationChecker::check(const DerBlob &issuer, const DerBlob &serialNumber) {
+    std::lock_guard<std::mutex> guard(lock);
+    // The checker lives as long as the process, so CRLs which are added or replaced are looked for regularly
+    auto now = std::chrono::steady_clock::now();
+    if (!index || (now >= nextScan)) {
+        refresh();
+        nextScan = now + std::chrono::milliseconds(CRL_RESCAN_INTERVAL_MS);
+    }
+    return index->check(issuer, serialNumber);
+}
+
+void RevocationChecker::refresh() {
+    uint32_t count = 0;
+    uint64_t stamp = 0;
+    scanDirectory(count, stamp);
+    if (index && (index->getSourceCount() == count) && (index->getSourceStamp() == stamp)) {
+        return;
+    }
+
+    // Another process can have rebuilt the index already
+    unmapIndex();
+    if (mapIndex(indexFilename)) {
+        if ((index->getSourceCount() == count) && (index->getSourceStamp() == stamp)) {
+            return;
+        }
+        unmapIndex();
+    }
+    rebuild(indexFilename, count, stamp);
+}
+
+void RevocationChecker::scanDirectory(uint32_t &count, uint64_t &stamp) {
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((directory + "\\*.crl").c_str(), &findData);
+    if (findHandle == INVALID_HANDLE_VALUE) {
+        if (GetLastError() == ERROR_FILE_NOT_FOUND) {
+            return;
+        }
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    do {
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            continue;
+        }
+        uint64_t lastWrite = (static_cast<uint64_t>(findData.ftLastWriteTime.dwHighDateTime) << 32) |
+                             findData.ftLastWriteTime.dwLowDateTime;
+        count++;
+        if (lastWrite > stamp) {
+            stamp = lastWrite;
+        }
+    } while (FindNextFileA(findHandle, &findData));
+    FindClose(findHandle);
+}
+
+bool RevocationChecker::mapIndex(const std::string &indexFilename) {
+    fileHandle = CreateFileA(indexFilename.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || (fileSize.QuadPart == 0)) {
+        unmapIndex();
+        return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        unmapIndex();
+        return false;
+    }
+    mappedIndex = static_cast<const unsigned char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mappedIndex == nullptr) {
+        unmapIndex();
+        return false;
+    }
+    try {
+        index.reset(new RevocationIndex(mappedIndex, static_cast<size_t>(fileSize.QuadPart)));
+    }
+    catch (std::invalid_argument &e) {
+        LogEvent::GetInstance().warning(0, std::string("Corrupt CRL index: ") + e.what());
+        unmapIndex();
+        return false;
+    }
+    return true;
+}
+
+void RevocationChecker::unmapIndex() {
+    index.reset();
+    if (mappedIndex != nullptr) {
+        UnmapViewOfFile(mappedIndex);
+        mappedIndex = nullptr;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+}
+
+void RevocationChecker::rebuild(const std::string &indexFilename, uint32_t count, uint64_t stamp) {
+    std::vector<std::vector<unsigned char>> crls;
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileA((directory + "\\*.crl").c_str(), &findData);
+    if (findHandle != INVALID_HANDLE_VALUE) {
+        do {
+            if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                continue;
+            }
+            std::string crlFilename = directory + "\\" + findData.cFileName;
+            std::ifstream crlFile(crlFilename, std::ios::binary);
+            std::vector<unsigned char> crl((std::istreambuf_iterator<char>(crlFile)),
+                                           std::istreambuf_iterator<char>());
+            if ((crl.size() > 10) && (memcmp(crl.data(), "-----BEGIN", 10) == 0)) {
+                DWORD crlLg = 0;
+                if (!CryptStringToBinaryA(reinterpret_cast<const char *>(crl.data()),
+                                          (DWORD)crl.size(),
+                                          CRYPT_STRING_BASE64HEADER,
+                                          nullptr,
+                                          &crlLg,
+                                          nullptr,
+                                          nullptr)) {
+                    LogEvent::GetInstance().warning(0, std::string("Skipped invalid PEM CRL ") + crlFilename);
+                    continue;
+                }
+                std::vector<unsigned char> derCrl(crlLg);
+                if (!CryptStringToBinaryA(reinterpret_cast<const char *>(crl.data()),
+                                          (DWORD)crl.size(),
+                                          CRYPT_STRING_BASE64HEADER,
+                                          derCrl.data(),
+                                          &crlLg,
+                                          nullptr,
+                                          nullptr)) {
+                    LogEvent::GetInstance().warning(0, std::string("Skipped invalid PEM CRL ") + crlFilename);
+                    continue;
+                }
+                crl.swap(derCrl);
+            }
+            // One bad file must not stop the revocation checks of the other issuers
+            try {
+                RevocationIndex::validate(crl);
+            }
+            catch (std::invalid_argument &e) {
+                LogEvent::GetInstance().warning(0, std::string("Skipped invalid CRL ") + crlFilename + ": " + e.what());
+                continue;
+            }
+            crls.push_back(std::move(crl));
+        } while (FindNextFileA(findHandle, &findData));
+        FindClose(findHandle);
+    }
+
+    std::vector<unsigned char> data;
+    try {
+        data = RevocationIndex::build(crls, count, stamp);
+    }
+    catch (std::invalid_argument &e) {
+        throw KSException(__func__, __LINE__, std::string("Invalid CRL in ") + directory + ": " + e.what());
+    }
+
+    // Write a new index next to the old one and swap it in, processes which have the old index mapped keep using it
+    std::string tmpFilename = indexFilename + "." + std::to_string(GetCurrentProcessId());
+    {
+        std::ofstream indexFile(tmpFilename, std::ios::binary | std::ios::trunc);
+        indexFile.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+    if (MoveFileExA(tmpFilename.c_str(), indexFilename.c_str(), MOVEFILE_REPLACE_EXISTING) &&
+        mapIndex(indexFilename)) {
+        return;
+    }
+    DeleteFileA(tmpFilename.c_str());
+    memoryIndex.swap(data);
+    index.reset(new RevocationIndex(memoryIndex.data(), memoryIndex.size()));
+}
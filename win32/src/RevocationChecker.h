@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_REVOCATIONCHECKER_H
+#define KSMGMNT_REVOCATIONCHECKER_H
+#include "common.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RevocationIndex.h"
+
+// Minimum time between two scans of the CRL directory for added or replaced CRLs
+#define CRL_RESCAN_INTERVAL_MS 60000
+
+/**
+ * Local revocation checks against the CRL files (*.crl, DER or PEM) of a directory. The CRLs are
+ * ingested once into an index file in a directory the user can write, which is rebuilt when the CRL
+ * files change and memory mapped by every process which checks a certificate.
+ */
+class RevocationChecker {
+public:
+    /**
+     * @param crlDirectory directory with the CRL files
+     * @param indexDirectory directory of the index file, empty for the CRL directory
+     */
+    explicit RevocationChecker(const std::string &crlDirectory,
+                               const std::string &indexDirectory = getDefaultIndexDirectory());
+
+    ~RevocationChecker();
+
+    RevocationChecker(const RevocationChecker &) = delete;
+
+    void operator=(const RevocationChecker &) = delete;
+
+    /**
+     * The crl directory next to the executable
+     */
+    static std::string getDefaultDirectory();
+
+    /**
+     * The directory of the application in the local application data of the user, empty when there is none
+     */
+    static std::string getDefaultIndexDirectory();
+
+    /**
+     * @param issuer DER encoded issuer name
+     * @param serialNumber content octets of the serial number
+     */
+    RevocationIndex::revocationStatus check(const DerBlob &issuer, const DerBlob &serialNumber);
+
+private:
+    void refresh();
+
+    void scanDirectory(uint32_t &count, uint64_t &stamp);
+
+    bool mapIndex(const std::string &indexFilename);
+
+    void unmapIndex();
+
+    void rebuild(const std::string &indexFilename, uint32_t count, uint64_t stamp);
+
+    std::string directory;
+    std::string indexFilename;
+    std::chrono::steady_clock::time_point nextScan;
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+    const unsigned char *mappedIndex;
+    // Used when the index file could not be replaced, because another process has it mapped
+    std::vector<unsigned char> memoryIndex;
+    std::unique_ptr<RevocationIndex> index;
+    std::mutex lock;
+};
+
+#endif //KSMGMNT_REVOCATIONCHECKER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,290 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include "RevocationIndex.h"
+#include "CertificateView.h"
+
+#define INDEX_MAGIC        "KSCRLIX2"
+#define INDEX_HEADER_SIZE  32
+#define INDEX_ISSUER_SIZE  24
+// nextUpdate of a CRL without one
+#define INDEX_NO_NEXT_UPDATE UINT64_MAX
+
+typedef std::array<unsigned char, REVOCATION_SERIAL_WIDTH> IndexSerial;
+
+static void put32(std::vector<unsigned char> &out, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+static uint32_t get32(const unsigned char *in) {
+    return static_cast<uint32_t>(in[0]) |
+           (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) |
+           (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static uint64_t get64(const unsigned char *in) {
+    return get32(in) | (static_cast<uint64_t>(get32(in + 4)) << 32);
+}
+
+/*
+ * Strip the leading zeros and right align, so memcmp orders the serials numerically.
+ * Returns false for serials which do not fit in the index.
+ */
+static bool normalizeSerial(const DerBlob &serialNumber, IndexSerial &serial) {
+    size_t start = 0;
+    while ((start < serialNumber.size) && (serialNumber.data[start] == 0x00)) {
+        start++;
+    }
+    size_t length = serialNumber.size - start;
+    if (length > REVOCATION_SERIAL_WIDTH) {
+        return false;
+    }
+    serial.fill(0x00);
+    if (length > 0) {
+        memcpy(serial.data() + REVOCATION_SERIAL_WIDTH - length, serialNumber.data + start, length);
+    }
+    return true;
+}
+
+static int compareNames(const unsigned char *name, size_t nameLength, const DerBlob &issuer) {
+    int result = memcmp(name, issuer.data, (std::min)(nameLength, issuer.size));
+    if (result != 0) {
+        return result;
+    }
+    if (nameLength == issuer.size) {
+        return 0;
+    }
+    return (nameLength < issuer.size) ? -1 : 1;
+}
+
+struct IndexIssuer {
+    IndexIssuer() : nextUpdate{0} {}
+
+    std::vector<IndexSerial> serials;
+    uint64_t nextUpdate;
+};
+
+/*
+ * Add the revoked serials of a CRL to its issuer, the latest nextUpdate of the CRLs of an issuer is kept
+ */
+static void readCrl(const std::vector<unsigned char> &crl, std::map<std::string, IndexIssuer> &revoked) {
+    DerReader outer(crl.data(), crl.size());
+    DerReader crlReader(outer.read(DER_SEQUENCE).content);
+    DerReader tbsReader(crlReader.read(DER_SEQUENCE).content);
+    DerElement element;
+    tbsReader.readOptional(DER_INTEGER, element);   // version
+    tbsReader.read(DER_SEQUENCE);                   // signature
+    std::string issuerName = tbsReader.read(DER_SEQUENCE).encoded.str();
+    tbsReader.read();                               // thisUpdate
+    uint64_t nextUpdate = INDEX_NO_NEXT_UPDATE;
+    if (tbsReader.readOptional(DER_UTC_TIME, element) || tbsReader.readOptional(DER_GENERALIZED_TIME, element)) {
+        std::time_t time = CertificateView::toTime(element);
+        nextUpdate = (time < 0) ? 0 : static_cast<uint64_t>(time);
+    }
+    std::vector<IndexSerial> serials;
+    if (tbsReader.readOptional(DER_SEQUENCE, element)) {
+        DerReader entriesReader(element.content);
+        while (!entriesReader.atEnd()) {
+            DerReader entryReader(entriesReader.read(DER_SEQUENCE).content);
+            IndexSerial serial;
+            if (normalizeSerial(entryReader.read(DER_INTEGER).content, serial)) {
+                serials.push_back(serial);
+            }
+        }
+    }
+
+    auto &issuer = revoked[issuerName];
+    issuer.serials.insert(issuer.serials.end(), serials.begin(), serials.end());
+    issuer.nextUpdate = (std::max)(issuer.nextUpdate, nextUpdate);
+}
+
+void RevocationIndex::validate(const std::vector<unsigned char> &crl) {
+    std::map<std::string, IndexIssuer> revoked;
+    readCrl(crl, revoked);
+}
+
+std::vector<unsigned char> RevocationIndex::build(const std::vector<std::vector<unsigned char>> &crls,
+                                                  uint32_t sourceCount,
+                                                  uint64_t sourceStamp) {
+    // std::string keys order the names like memcmp
+    std::map<std::string, IndexIssuer> revoked;
+    for (auto &crl : crls) {
+        readCrl(crl, revoked);
+    }
+
+    size_t totalSerials = 0;
+    size_t namesSize = 0;
+    for (auto &issuer : revoked) {
+        auto &serials = issuer.second.serials;
+        std::sort(serials.begin(), serials.end());
+        serials.erase(std::unique(serials.begin(), serials.end()), serials.end());
+        totalSerials += serials.size();
+        namesSize += issuer.first.size();
+    }
+
+    size_t serialsOffset = INDEX_HEADER_SIZE + revoked.size() * INDEX_ISSUER_SIZE;
+    size_t namesOffset = serialsOffset + totalSerials * REVOCATION_SERIAL_WIDTH;
+    if (namesOffset + namesSize > UINT32_MAX) {
+        throw std::invalid_argument("RevocationIndex: too many revoked certificates");
+    }
+    std::vector<unsigned char> index(namesOffset + namesSize);
+    memcpy(index.data(), INDEX_MAGIC, 8);
+    put32(index, 8, static_cast<uint32_t>(revoked.size()));
+    put32(index, 12, static_cast<uint32_t>(totalSerials));
+    put32(index, 16, sourceCount);
+    put32(index, 20, 0);
+    put32(index, 24, static_cast<uint32_t>(sourceStamp));
+    put32(index, 28, static_cast<uint32_t>(sourceStamp >> 32));
+
+    size_t issuerOffset = INDEX_HEADER_SIZE;
+    size_t serialIndex = 0;
+    size_t nameOffset = namesOffset;
+    for (auto &issuer : revoked) {
+        put32(index, issuerOffset, static_cast<uint32_t>(nameOffset));
+        put32(index, issuerOffset + 4, static_cast<uint32_t>(issuer.first.size()));
+        put32(index, issuerOffset + 8, static_cast<uint32_t>(serialIndex));
+        put32(index, issuerOffset + 12, static_cast<uint32_t>(issuer.second.serials.size()));
+        put32(index, issuerOffset + 16, static_cast<uint32_t>(issuer.second.nextUpdate));
+        put32(index, issuerOffset + 20, static_cast<uint32_t>(issuer.second.nextUpdate >> 32));
+        memcpy(index.data() + nameOffset, issuer.first.data(), issuer.first.size());
+        for (auto &serial : issuer.second.serials) {
+            memcpy(index.data() + serialsOffset + serialIndex * REVOCATION_SERIAL_WIDTH,
+                   serial.data(),
+                   REVOCATION_SERIAL_WIDTH);
+            serialIndex++;
+        }
+        issuerOffset += INDEX_ISSUER_SIZE;
+        nameOffset += issuer.first.size();
+    }
+
+    return index;
+}
+
+RevocationIndex::RevocationIndex(const unsigned char *d, size_t s) : data{d}, size{s} {
+    if ((size < INDEX_HEADER_SIZE) || (memcmp(data, INDEX_MAGIC, 8) != 0)) {
+        throw std::invalid_argument("RevocationIndex: invalid header");
+    }
+    issuerCount = get32(data + 8);
+    serialCount = get32(data + 12);
+    sourceCount = get32(data + 16);
+    sourceStamp = get64(data + 24);
+    size_t serialsOffset = INDEX_HEADER_SIZE + static_cast<size_t>(issuerCount) * INDEX_ISSUER_SIZE;
+    if (serialsOffset + static_cast<size_t>(serialCount) * REVOCATION_SERIAL_WIDTH > size) {
+        throw std::invalid_argument("RevocationIndex: truncated index");
+    }
+    for (size_t i = 0; i < issuerCount; i++) {
+        const unsigned char *issuer = data + INDEX_HEADER_SIZE + i * INDEX_ISSUER_SIZE;
+        if ((static_cast<size_t>(get32(issuer)) + get32(issuer + 4) > size) ||
+            (static_cast<size_t>(get32(issuer + 8)) + get32(issuer + 12) > serialCount)) {
+            throw std::invalid_argument("RevocationIndex: corrupt issuer table");
+        }
+    }
+}
+
+const unsigned char *RevocationIndex::findIssuer(const DerBlob &issuer) const {
+    size_t low = 0;
+    size_t high = issuerCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const unsigned char *entry = data + INDEX_HEADER_SIZE + middle * INDEX_ISSUER_SIZE;
+        int result = compareNames(data + get32(entry), get32(entry + 4), issuer);
+        if (result == 0) {
+            return entry;
+        }
+        if (result < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return nullptr;
+}
+
+RevocationIndex::revocationStatus RevocationIndex::check(const DerBlob &issuer, const DerBlob &serialNumber) const {
+    return check(issuer, serialNumber, std::time(nullptr));
+}
+
+RevocationIndex::revocationStatus RevocationIndex::check(const DerBlob &issuer,
+                                                         const DerBlob &serialNumber,
+                                                         std::time_t now) const {
+    const unsigned char *entry = findIssuer(issuer);
+    if (entry == nullptr) {
+        return revocationStatus::Unknown;
+    }
+    IndexSerial serial;
+    if (!normalizeSerial(serialNumber, serial)) {
+        return revocationStatus::Unknown;
+    }
+    const unsigned char *serials = data + INDEX_HEADER_SIZE + static_cast<size_t>(issuerCount) * INDEX_ISSUER_SIZE;
+    size_t low = get32(entry + 8);
+    size_t high = low + get32(entry + 12);
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int result = memcmp(serials + middle * REVOCATION_SERIAL_WIDTH, serial.data(), REVOCATION_SERIAL_WIDTH);
+        if (result == 0) {
+            return revocationStatus::Revoked;
+        }
+        if (result < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    // A revoked certificate stays revoked, but a CRL which passed its nextUpdate cannot tell it is still good
+    if ((now < 0) || (static_cast<uint64_t>(now) > get64(entry + 16))) {
+        return revocationStatus::Unknown;
+    }
+    return revocationStatus::Good;
+}
+
+size_t RevocationIndex::getIssuerCount() const {
+    return issuerCount;
+}
+
+size_t RevocationIndex::getSerialCount() const {
+    return serialCount;
+}
+
+uint32_t RevocationIndex::getSourceCount() const {
+    return sourceCount;
+}
+
+uint64_t RevocationIndex::getSourceStamp() const {
+    return sourceStamp;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_REVOCATIONINDEX_H
+#define KSMGMNT_REVOCATIONINDEX_H
+#include <cstdint>
+#include <ctime>
+#include <vector>
+#include "DerReader.h"
+
+// Serial numbers are stored right aligned in 20 bytes, the maximum of RFC 5280
+#define REVOCATION_SERIAL_WIDTH 20
+
+/**
+ * Read-only view on a revocation index: the revoked serial numbers of all CRLs, sorted per issuer, in
+ * one flat buffer so it can be memory mapped and searched without parsing or copying anything.
+ *
+ * Layout (little endian):
+ *   header     magic "KSCRLIX1", issuer count, serial count, source count, reserved, source stamp (64 bit)
+ *   issuers    per issuer, sorted on the DER encoded name: name offset, name length, first serial, serial count,
+ *              nextUpdate (64 bit, seconds since the epoch)
+ *   serials    REVOCATION_SERIAL_WIDTH bytes each, sorted per issuer
+ *   names      DER encoded issuer names
+ */
+class RevocationIndex {
+public:
+    enum class revocationStatus {
+        Good = 0,
+        Revoked,
+        Unknown     // no CRL of the issuer in the index, or its CRL passed its nextUpdate
+    };
+
+    /**
+     * Build an index from DER encoded CRLs. The CRL signatures are not verified, only put CRLs of trusted
+     * sources in the index.
+     * @param crls DER encoded CRLs
+     * @param sourceCount number of CRL files the index is built from
+     * @param sourceStamp last modification of the CRL files the index is built from
+     * throws std::invalid_argument when a CRL is malformed
+     */
+    static std::vector<unsigned char> build(const std::vector<std::vector<unsigned char>> &crls,
+                                            uint32_t sourceCount = 0,
+                                            uint64_t sourceStamp = 0);
+
+    /**
+     * throws std::invalid_argument when the DER encoded CRL cannot be put in an index
+     */
+    static void validate(const std::vector<unsigned char> &crl);
+
+    /**
+     * @param data the index as created by build, it must outlive the view
+     * throws std::invalid_argument when the index is corrupt
+     */
+    RevocationIndex(const unsigned char *data, size_t size);
+
+    /**
+     * @param issuer DER encoded issuer name
+     * @param serialNumber content octets of the serial number
+     */
+    revocationStatus check(const DerBlob &issuer, const DerBlob &serialNumber) const;
+
+    /**
+     * @param now seconds since the epoch, compared with the nextUpdate of the CRL
+     */
+    revocationStatus check(const DerBlob &issuer, const DerBlob &serialNumber, std::time_t now) const;
+
+    size_t getIssuerCount() const;
+
+    size_t getSerialCount() const;
+
+    uint32_t getSourceCount() const;
+
+    uint64_t getSourceStamp() const;
+
+private:
+    const unsigned char *findIssuer(const DerBlob &issuer) const;
+
+    const unsigned char *data;
+    size_t size;
+    uint32_t issuerCount;
+    uint32_t serialCount;
+    uint32_t sourceCount;
+    uint64_t sourceStamp;
+};
+
+#endif //KSMGMNT_REVOCATIONINDEX_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
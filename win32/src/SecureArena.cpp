@@ -0,0 +1,153 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "common.h"
+#include "SecureArena.h"
+
+SecureArena &SecureArena::GetInstance() {
+    // Never destroyed, secrets in static objects can be released after the other statics are gone
+    static SecureArena *secureArena = new SecureArena();
+    return *secureArena;
+}
+
+SecureArena::SecureArena() : blockCursor{nullptr},
+                             blockRemaining{0},
+                             allocationCount{0},
+                             reservedBytes{0},
+                             unlockedPages{0} {
+    size_t classes = 0;
+    for (size_t chunk = SECURE_ARENA_MIN_CHUNK; chunk <= SECURE_ARENA_MAX_CHUNK; chunk *= 2) {
+        classes++;
+    }
+    freeChunks.resize(classes, nullptr);
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    pageSize = systemInfo.dwPageSize;
+}
+
+void *SecureArena::allocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    if (size > SECURE_ARENA_MAX_CHUNK) {
+        void *pages = allocatePages(size);
+        allocationCount++;
+        return pages;
+    }
+
+    size_t chunkClass = getChunkClass(size);
+    size_t chunkSize = static_cast<size_t>(SECURE_ARENA_MIN_CHUNK) << chunkClass;
+    void *chunk = freeChunks[chunkClass];
+    if (chunk != nullptr) {
+        freeChunks[chunkClass] = *static_cast<void **>(chunk);
+        *static_cast<void **>(chunk) = nullptr;
+    }
+    else {
+        if (blockRemaining < chunkSize) {
+            // The rest of the current block is too small for this class, it stays unused
+            blockCursor = static_cast<unsigned char *>(allocatePages(SECURE_ARENA_BLOCK_SIZE));
+            blockRemaining = SECURE_ARENA_BLOCK_SIZE;
+            blocks.push_back(blockCursor);
+        }
+        chunk = blockCursor;
+        blockCursor += chunkSize;
+        blockRemaining -= chunkSize;
+    }
+    allocationCount++;
+
+    return chunk;
+}
+
+void SecureArena::deallocate(void *ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    allocationCount--;
+    if (size > SECURE_ARENA_MAX_CHUNK) {
+        releasePages(ptr, size);
+        return;
+    }
+
+    size_t chunkClass = getChunkClass(size);
+    SecureZeroMemory(ptr, static_cast<size_t>(SECURE_ARENA_MIN_CHUNK) << chunkClass);
+    *static_cast<void **>(ptr) = freeChunks[chunkClass];
+    freeChunks[chunkClass] = ptr;
+}
+
+size_t SecureArena::getAllocationCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return allocationCount;
+}
+
+size_t SecureArena::getReservedBytes() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return reservedBytes;
+}
+
+size_t SecureArena::getUnlockedPages() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return unlockedPages;
+}
+
+void *SecureArena::allocatePages(size_t size) {
+    size_t pages = (size + pageSize - 1) / pageSize;
+    void *ptr = VirtualAlloc(nullptr, pages * pageSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    if (!VirtualLock(ptr, pages * pageSize)) {
+        unlockedPages += pages;
+    }
+    reservedBytes += pages * pageSize;
+
+    return ptr;
+}
+
+void SecureArena::releasePages(void *ptr, size_t size) {
+    size_t pages = (size + pageSize - 1) / pageSize;
+    SecureZeroMemory(ptr, pages * pageSize);
+    // Fails for pages which could not be locked, they are released all the same
+    VirtualUnlock(ptr, pages * pageSize);
+    VirtualFree(ptr, 0, MEM_RELEASE);
+    reservedBytes -= pages * pageSize;
+}
+
+size_t SecureArena::getChunkClass(size_t size) {
+    size_t chunkClass = 0;
+    for (size_t chunk = SECURE_ARENA_MIN_CHUNK; chunk < size; chunk *= 2) {
+        chunkClass++;
+    }
+    return chunkClass;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_SECUREARENA_H
+#define KSMGMNT_SECUREARENA_H
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Locked memory taken from the system at once, carved up for the small allocations
+#define SECURE_ARENA_BLOCK_SIZE (64 * 1024)
+// Allocations up to this size come from the pooled blocks, larger ones get their own locked pages
+#define SECURE_ARENA_MAX_CHUNK 4096
+#define SECURE_ARENA_MIN_CHUNK 16
+
+/**
+ * Memory for passwords and key material. The pages are locked, so they are not written to the page file,
+ * and every allocation is zeroized when it is released. Locking pages is expensive, so the small
+ * allocations are served from a pool of locked blocks which is kept for the lifetime of the process and
+ * shared by all requests.
+ */
+class SecureArena {
+public:
+    static SecureArena &GetInstance();
+
+    SecureArena(const SecureArena &) = delete;
+
+    void operator=(const SecureArena &) = delete;
+
+    /**
+     * throws std::bad_alloc when no memory is available
+     */
+    void *allocate(size_t size);
+
+    /**
+     * Zeroize and release an allocation
+     * @param size the size passed to allocate
+     */
+    void deallocate(void *ptr, size_t size);
+
+    /**
+     * Number of allocations which are not released
+     */
+    size_t getAllocationCount() const;
+
+    /**
+     * Bytes taken from the system, pooled blocks and large allocations
+     */
+    size_t getReservedBytes() const;
+
+    /**
+     * Pages which could not be locked since the start of the process, because the working set of the
+     * process is too small. They are still zeroized.
+     */
+    size_t getUnlockedPages() const;
+
+private:
+    SecureArena();
+
+    void *allocatePages(size_t size);
+
+    void releasePages(void *ptr, size_t size);
+
+    static size_t getChunkClass(size_t size);
+
+    // Free chunks per size class (16, 32, ... SECURE_ARENA_MAX_CHUNK), linked through their first bytes
+    std::vector<void *> freeChunks;
+    std::vector<unsigned char *> blocks;
+    unsigned char *blockCursor;
+    size_t blockRemaining;
+    size_t allocationCount;
+    size_t reservedBytes;
+    size_t unlockedPages;
+    size_t pageSize;
+    mutable std::mutex lock;
+};
+
+/**
+ * Allocator for containers with secrets
+ */
+template<class T>
+class SecureAllocator {
+public:
+    typedef T value_type;
+
+    SecureAllocator() = default;
+
+    template<class U>
+    SecureAllocator(const SecureAllocator<U> &) {
+    }
+
+    T *allocate(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max)() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(SecureArena::GetInstance().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t n) {
+        SecureArena::GetInstance().deallocate(ptr, n * sizeof(T));
+    }
+};
+
+template<class T, class U>
+bool operator==(const SecureAllocator<T> &, const SecureAllocator<U> &) {
+    return true;
+}
+
+template<class T, class U>
+bool operator!=(const SecureAllocator<T> &, const SecureAllocator<U> &) {
+    return false;
+}
+
+// Vectors instead of strings: a short string is stored in the string object itself, outside the arena
+typedef std::vector<unsigned char, SecureAllocator<unsigned char>> SecureBuffer;
+// Zero terminated wide string, like the passwords of the PFX functions
+typedef std::vector<wchar_t, SecureAllocator<wchar_t>> SecureWideString;
+
+#endif //KSMGMNT_SECUREARENA_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
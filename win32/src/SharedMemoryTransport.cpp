@@ -0,0 +1,244 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "SharedMemoryTransport.h"
+#include <new>
+#include <stdexcept>
+#include "Broker.h"
+#include "KSException.h"
+
+#define SHM_MAGIC 0x4D48534B
+// The header is followed by the request ring and the response ring
+#define SHM_HEADER_SIZE 64
+
+static std::string objectName(const std::string &name, const char *suffix) {
+    return std::string("Local\\org.cryptable.pki.keymgmnt.") + name + suffix;
+}
+
+SharedMemoryTransport::SharedMemoryTransport() : mapping{nullptr},
+                                                 view{nullptr},
+                                                 header{nullptr},
+                                                 host{false},
+                                                 inData{nullptr},
+                                                 inSpace{nullptr},
+                                                 outData{nullptr},
+                                                 outSpace{nullptr},
+                                                 peerProcess{nullptr} {
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    if (header != nullptr) {
+        close();
+    }
+    for (HANDLE handle : {inData, inSpace, outData, outSpace, peerProcess}) {
+        if (handle != nullptr) {
+            CloseHandle(handle);
+        }
+    }
+    if (view != nullptr) {
+        UnmapViewOfFile(view);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+}
+
+std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::create(const std::string &name, uint32_t capacity) {
+    std::unique_ptr<SharedMemoryTransport> transport(new SharedMemoryTransport());
+    size_t ringSize = SpscRing::requiredSize(capacity);
+    uint64_t size = SHM_HEADER_SIZE + 2 * (uint64_t)ringSize;
+    transport->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                            nullptr,
+                                            PAGE_READWRITE,
+                                            (DWORD)(size >> 32),
+                                            (DWORD)size,
+                                            objectName(name, "").c_str());
+    if (transport->mapping == nullptr) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        throw KSException(__func__, __LINE__, "Shared memory already in use");
+    }
+    transport->view = static_cast<unsigned char *>(MapViewOfFile(transport->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (transport->view == nullptr) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    Header *header = new (transport->view) Header;
+    header->clientProcessId = GetCurrentProcessId();
+    header->hostProcessId = 0;
+    transport->out = SpscRing::create(transport->view + SHM_HEADER_SIZE, capacity);
+    transport->in = SpscRing::create(transport->view + SHM_HEADER_SIZE + ringSize, capacity);
+    header->magic = SHM_MAGIC;
+
+    transport->outData = CreateEventA(nullptr, FALSE, FALSE, objectName(name, ".request.data").c_str());
+    transport->outSpace = CreateEventA(nullptr, FALSE, FALSE, objectName(name, ".request.space").c_str());
+    transport->inData = CreateEventA(nullptr, FALSE, FALSE, objectName(name, ".response.data").c_str());
+    transport->inSpace = CreateEventA(nullptr, FALSE, FALSE, objectName(name, ".response.space").c_str());
+    if ((transport->outData == nullptr) ||
+        (transport->outSpace == nullptr) ||
+        (transport->inData == nullptr) ||
+        (transport->inSpace == nullptr)) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    transport->header = header;
+
+    return transport;
+}
+
+std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::open(const std::string &name) {
+    std::unique_ptr<SharedMemoryTransport> transport(new SharedMemoryTransport());
+    transport->host = true;
+    transport->mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, objectName(name, "").c_str());
+    if (transport->mapping == nullptr) {
+        return nullptr;
+    }
+    transport->view = static_cast<unsigned char *>(MapViewOfFile(transport->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (transport->view == nullptr) {
+        return nullptr;
+    }
+    MEMORY_BASIC_INFORMATION memoryInfo;
+    if (!VirtualQuery(transport->view, &memoryInfo, sizeof(memoryInfo)) ||
+        (memoryInfo.RegionSize < SHM_HEADER_SIZE)) {
+        return nullptr;
+    }
+    Header *header = reinterpret_cast<Header *>(transport->view);
+    if (header->magic != SHM_MAGIC) {
+        return nullptr;
+    }
+    try {
+        size_t remaining = memoryInfo.RegionSize - SHM_HEADER_SIZE;
+        transport->in = SpscRing::attach(transport->view + SHM_HEADER_SIZE, remaining);
+        size_t ringSize = SpscRing::requiredSize(transport->in.getCapacity());
+        transport->out = SpscRing::attach(transport->view + SHM_HEADER_SIZE + ringSize, remaining - ringSize);
+    }
+    catch (std::invalid_argument &) {
+        return nullptr;
+    }
+
+    DWORD access = EVENT_MODIFY_STATE | SYNCHRONIZE;
+    transport->inData = OpenEventA(access, FALSE, objectName(name, ".request.data").c_str());
+    transport->inSpace = OpenEventA(access, FALSE, objectName(name, ".request.space").c_str());
+    transport->outData = OpenEventA(access, FALSE, objectName(name, ".response.data").c_str());
+    transport->outSpace = OpenEventA(access, FALSE, objectName(name, ".response.space").c_str());
+    if ((transport->inData == nullptr) ||
+        (transport->inSpace == nullptr) ||
+        (transport->outData == nullptr) ||
+        (transport->outSpace == nullptr)) {
+        return nullptr;
+    }
+    transport->peerProcess = OpenProcess(SYNCHRONIZE, FALSE, header->clientProcessId);
+    InterlockedExchange(&header->hostProcessId, (LONG)GetCurrentProcessId());
+    transport->header = header;
+
+    return transport;
+}
+
+bool SharedMemoryTransport::readFrame(std::string &frame) {
+    uint32_t frameLg = 0;
+    if (!readExact((char *)&frameLg, 4)) {
+        return false;
+    }
+    if (frameLg > BROKER_MAX_FRAME) {
+        throw KSException(__func__, __LINE__, "Frame too large");
+    }
+    frame.resize(4 + frameLg);
+    memcpy(&frame[0], &frameLg, 4);
+    if (!readExact(&frame[4], frameLg)) {
+        throw KSException(__func__, __LINE__, "Truncated frame");
+    }
+    return true;
+}
+
+void SharedMemoryTransport::writeFrame(const std::string &frame) {
+    size_t offset = 0;
+    try {
+        while (offset < frame.size()) {
+            size_t written = out.write(frame.data() + offset, frame.size() - offset);
+            if (written > 0) {
+                offset += written;
+                SetEvent(outData);
+                continue;
+            }
+            waitFor(outSpace);
+        }
+    }
+    catch (std::runtime_error &e) {
+        // The ring was corrupted by the peer
+        throw KSException(__func__, __LINE__, std::string(e.what()));
+    }
+}
+
+void SharedMemoryTransport::close() {
+    out.close();
+    SetEvent(outData);
+}
+
+bool SharedMemoryTransport::readExact(char *data, size_t size) {
+    size_t offset = 0;
+    try {
+        while (offset < size) {
+            size_t read = in.read(data + offset, size - offset);
+            if (read > 0) {
+                offset += read;
+                SetEvent(inSpace);
+                continue;
+            }
+            if (in.isClosed()) {
+                // The peer can have written its last data just before it closed the ring
+                read = in.read(data + offset, size - offset);
+                if (read == 0) {
+                    return false;
+                }
+                offset += read;
+                continue;
+            }
+            waitFor(inData);
+        }
+    }
+    catch (std::runtime_error &e) {
+        // The ring was corrupted by the peer
+        throw KSException(__func__, __LINE__, std::string(e.what()));
+    }
+    return true;
+}
+
+void SharedMemoryTransport::waitFor(HANDLE event) {
+    if ((peerProcess == nullptr) && !host && (header->hostProcessId != 0)) {
+        peerProcess = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)header->hostProcessId);
+    }
+    HANDLE handles[2] = { event, peerProcess };
+    DWORD result = WaitForMultipleObjects(peerProcess == nullptr ? 1 : 2, handles, FALSE, SHM_WAIT_TIMEOUT);
+    if (result == WAIT_FAILED) {
+        throw KSException(__func__, __LINE__, GetLastError());
+    }
+    if (result == WAIT_OBJECT_0 + 1) {
+        throw KSException(__func__, __LINE__, "Peer process stopped");
+    }
+}
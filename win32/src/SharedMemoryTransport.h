@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_SHAREDMEMORYTRANSPORT_H
+#define KSMGMNT_SHAREDMEMORYTRANSPORT_H
+#include "common.h"
+#include <memory>
+#include <string>
+#include "SpscRing.h"
+
+// Size of each ring, frames larger than the ring are streamed through it
+#define SHM_RING_CAPACITY (4 * 1024 * 1024)
+// Interval to check for a stopped peer while waiting for data or space
+#define SHM_WAIT_TIMEOUT 1000
+
+/**
+ * Native messaging frames (length + JSON) over shared memory for local tools, which avoids copying
+ * large PFX frames through pipes. The client creates a file mapping with a request ring and a response
+ * ring and starts the host with --shm <name>, events signal new data and free space in the rings.
+ */
+class SharedMemoryTransport {
+public:
+    /**
+     * Client side: create the shared memory and events
+     */
+    static std::unique_ptr<SharedMemoryTransport> create(const std::string &name,
+                                                         uint32_t capacity = SHM_RING_CAPACITY);
+
+    /**
+     * Host side: open the shared memory created by a client
+     * @return nullptr when there is no such shared memory, the host should fall back to stdio
+     */
+    static std::unique_ptr<SharedMemoryTransport> open(const std::string &name);
+
+    ~SharedMemoryTransport();
+
+    SharedMemoryTransport(const SharedMemoryTransport &) = delete;
+
+    void operator=(const SharedMemoryTransport &) = delete;
+
+    /**
+     * @return false when the peer closed the transport
+     */
+    bool readFrame(std::string &frame);
+
+    void writeFrame(const std::string &frame);
+
+    /**
+     * No more frames will be written
+     */
+    void close();
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t clientProcessId;
+        volatile LONG hostProcessId;
+    };
+
+    SharedMemoryTransport();
+
+    bool readExact(char *data, size_t size);
+
+    void waitFor(HANDLE event);
+
+    HANDLE mapping;
+    unsigned char *view;
+    Header *header;
+    bool host;
+    SpscRing in;
+    SpscRing out;
+    HANDLE inData;
+    HANDLE inSpace;
+    HANDLE outData;
+    HANDLE outSpace;
+    HANDLE peerProcess;
+};
+
+#endif //KSMGMNT_SHAREDMEMORYTRANSPORT_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
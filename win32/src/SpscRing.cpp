@@ -0,0 +1,134 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "SpscRing.h"
+
+#define SPSC_RING_MAGIC 0x474E5253
+
+// The header is shared between processes, so its atomics must not fall back to a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64 bit atomics must be lock free");
+
+static size_t headerSize() {
+    // Keep the data cache line aligned
+    return 64;
+}
+
+size_t SpscRing::requiredSize(uint32_t capacity) {
+    return headerSize() + capacity;
+}
+
+SpscRing SpscRing::create(void *memory, uint32_t capacity) {
+    static_assert(sizeof(Header) <= 64, "ring header must fit in a cache line");
+    if ((capacity == 0) || (capacity & (capacity - 1))) {
+        throw std::invalid_argument("ring capacity must be a power of 2");
+    }
+    Header *header = new (memory) Header;
+    header->capacity = capacity;
+    header->head.store(0);
+    header->tail.store(0);
+    header->closed.store(0);
+    header->magic = SPSC_RING_MAGIC;
+
+    return SpscRing(header, static_cast<unsigned char *>(memory) + headerSize(), capacity);
+}
+
+SpscRing SpscRing::attach(void *memory, size_t size) {
+    if (size < headerSize()) {
+        throw std::invalid_argument("no ring");
+    }
+    Header *header = static_cast<Header *>(memory);
+    // The peer can change the header, so the capacity is read once
+    uint32_t capacity = header->capacity;
+    if ((header->magic != SPSC_RING_MAGIC) ||
+        (capacity == 0) ||
+        (capacity & (capacity - 1)) ||
+        (requiredSize(capacity) > size)) {
+        throw std::invalid_argument("no ring");
+    }
+    return SpscRing(header, static_cast<unsigned char *>(memory) + headerSize(), capacity);
+}
+
+SpscRing::SpscRing() : header{nullptr}, buffer{nullptr}, capacity{0} {
+}
+
+SpscRing::SpscRing(Header *h, unsigned char *b, uint32_t c) : header{h}, buffer{b}, capacity{c} {
+}
+
+size_t SpscRing::write(const void *data, size_t size) {
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    checkPositions(head, tail);
+    size_t count = (std::min)(size, static_cast<size_t>(capacity - (head - tail)));
+    size_t position = static_cast<size_t>(head & (capacity - 1));
+    size_t first = (std::min)(count, capacity - position);
+    memcpy(buffer + position, data, first);
+    memcpy(buffer, static_cast<const unsigned char *>(data) + first, count - first);
+    header->head.store(head + count, std::memory_order_release);
+
+    return count;
+}
+
+size_t SpscRing::read(void *data, size_t size) {
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    checkPositions(head, tail);
+    size_t count = (std::min)(size, static_cast<size_t>(head - tail));
+    size_t position = static_cast<size_t>(tail & (capacity - 1));
+    size_t first = (std::min)(count, capacity - position);
+    memcpy(data, buffer + position, first);
+    memcpy(static_cast<unsigned char *>(data) + first, buffer, count - first);
+    header->tail.store(tail + count, std::memory_order_release);
+
+    return count;
+}
+
+void SpscRing::close() {
+    header->closed.store(1, std::memory_order_release);
+}
+
+bool SpscRing::isClosed() const {
+    return header->closed.load(std::memory_order_acquire) != 0;
+}
+
+uint32_t SpscRing::getCapacity() const {
+    return capacity;
+}
+
+void SpscRing::checkPositions(uint64_t head, uint64_t tail) {
+    // More data than fits in the ring, or a tail past the head, was written by a broken or hostile peer
+    if (head - tail > capacity) {
+        close();
+        throw std::runtime_error("corrupt ring");
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_SPSCRING_H
+#define KSMGMNT_SPSCRING_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Single producer, single consumer byte ring in a caller provided memory block, for example a file
+ * mapping shared by two processes. The ring only moves bytes and never blocks, the waiting for data
+ * or free space is left to the transport using it.
+ */
+class SpscRing {
+public:
+    /**
+     * Memory needed for a ring of capacity bytes
+     */
+    static size_t requiredSize(uint32_t capacity);
+
+    /**
+     * Initialize a new ring in memory
+     * @param capacity must be a power of 2
+     * throws std::invalid_argument when the capacity is not a power of 2
+     */
+    static SpscRing create(void *memory, uint32_t capacity);
+
+    /**
+     * Use a ring initialized by create, possibly in another process
+     * throws std::invalid_argument when memory does not contain a ring or the ring does not fit in size
+     */
+    static SpscRing attach(void *memory, size_t size);
+
+    SpscRing();
+
+    /**
+     * Producer: copy as much of data as fits
+     * @return the number of bytes written
+     * throws std::runtime_error and closes the ring when the peer corrupted the positions
+     */
+    size_t write(const void *data, size_t size);
+
+    /**
+     * Consumer: copy as much as available into data
+     * @return the number of bytes read
+     * throws std::runtime_error and closes the ring when the peer corrupted the positions
+     */
+    size_t read(void *data, size_t size);
+
+    /**
+     * Producer: no more data will be written
+     */
+    void close();
+
+    bool isClosed() const;
+
+    uint32_t getCapacity() const;
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t capacity;
+        // Total bytes written and read, the ring position is the total modulo the capacity
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        std::atomic<uint32_t> closed;
+    };
+
+    SpscRing(Header *header, unsigned char *buffer, uint32_t capacity);
+
+    void checkPositions(uint64_t head, uint64_t tail);
+
+    Header *header;
+    unsigned char *buffer;
+    uint32_t capacity;
+};
+
+#endif //KSMGMNT_SPSCRING_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
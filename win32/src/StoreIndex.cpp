@@ -0,0 +1,173 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <algorithm>
+#include <cctype>
+#include "StoreIndex.h"
+
+void StoreIndex::setCertificates(const std::vector<Certificate> &entries) {
+    std::map<std::string, IndexedCertificate> indexed;
+    std::set<std::pair<std::string, std::string>> issuers;
+    for (auto &certificate : entries) {
+        indexed[certificate.thumbprint] = IndexedCertificate{certificate, toLower(certificate.subject)};
+        issuers.insert(std::make_pair(certificate.issuer, certificate.thumbprint));
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    certificates.swap(indexed);
+    byIssuer.swap(issuers);
+}
+
+void StoreIndex::setKeys(const std::vector<Key> &entries) {
+    std::map<std::string, Key> indexed;
+    for (auto &key : entries) {
+        indexed[key.name] = key;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    keys.swap(indexed);
+}
+
+bool StoreIndex::getCertificate(const std::string &thumbprint, Certificate &certificate) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = certificates.find(thumbprint);
+    if (found == certificates.end()) {
+        return false;
+    }
+    certificate = found->second.certificate;
+    return true;
+}
+
+size_t StoreIndex::getCertificateCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return certificates.size();
+}
+
+size_t StoreIndex::getKeyCount() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return keys.size();
+}
+
+StoreIndex::Page<StoreIndex::Certificate> StoreIndex::listCertificates(const CertificateFilter &filter,
+                                                                      const std::string &cursor,
+                                                                      size_t pageSize) const {
+    Page<Certificate> page;
+    pageSize = limitPageSize(pageSize);
+    std::string subject = toLower(filter.subject);
+
+    // Stops after one entry more than the page, to know whether there is a next page
+    std::lock_guard<std::mutex> guard(lock);
+    auto add = [&](const IndexedCertificate &indexed) {
+        if (!matches(indexed, filter, subject)) {
+            return true;
+        }
+        if (page.entries.size() == pageSize) {
+            page.cursor = page.entries.back().thumbprint;
+            return false;
+        }
+        page.entries.push_back(indexed.certificate);
+        return true;
+    };
+    if (filter.issuer.empty()) {
+        auto it = cursor.empty() ? certificates.begin() : certificates.upper_bound(cursor);
+        for (; (it != certificates.end()) && add(it->second); ++it) {
+        }
+    }
+    else {
+        auto it = byIssuer.upper_bound(std::make_pair(filter.issuer, cursor));
+        for (; (it != byIssuer.end()) && (it->first == filter.issuer); ++it) {
+            if (!add(certificates.at(it->second))) {
+                break;
+            }
+        }
+    }
+
+    return page;
+}
+
+StoreIndex::Page<StoreIndex::Key> StoreIndex::listKeys(const KeyFilter &filter,
+                                                      const std::string &cursor,
+                                                      size_t pageSize) const {
+    Page<Key> page;
+    pageSize = limitPageSize(pageSize);
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = cursor.empty() ? keys.begin() : keys.upper_bound(cursor);
+    for (; it != keys.end(); ++it) {
+        auto &key = it->second;
+        if (((filter.certificate == presence::With) && key.thumbprint.empty()) ||
+            ((filter.certificate == presence::Without) && !key.thumbprint.empty())) {
+            continue;
+        }
+        if (page.entries.size() == pageSize) {
+            page.cursor = page.entries.back().name;
+            break;
+        }
+        page.entries.push_back(key);
+    }
+
+    return page;
+}
+
+bool StoreIndex::matches(const IndexedCertificate &indexed, const CertificateFilter &filter, const std::string &subject) {
+    auto &certificate = indexed.certificate;
+    if ((!filter.issuer.empty()) && (certificate.issuer != filter.issuer)) {
+        return false;
+    }
+    if ((!subject.empty()) && (indexed.lowerSubject.find(subject) == std::string::npos)) {
+        return false;
+    }
+    if ((filter.expiresFrom != 0) && (certificate.notAfter < filter.expiresFrom)) {
+        return false;
+    }
+    if ((filter.expiresTo != 0) && (certificate.notAfter > filter.expiresTo)) {
+        return false;
+    }
+    if (((filter.privateKey == presence::With) && certificate.keyName.empty()) ||
+        ((filter.privateKey == presence::Without) && !certificate.keyName.empty())) {
+        return false;
+    }
+    return true;
+}
+
+size_t StoreIndex::limitPageSize(size_t pageSize) {
+    if (pageSize == 0) {
+        return STORE_INDEX_PAGE_SIZE;
+    }
+    return (std::min)(pageSize, static_cast<size_t>(STORE_INDEX_MAX_PAGE_SIZE));
+}
+
+std::string StoreIndex::toLower(const std::string &value) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return lower;
+}
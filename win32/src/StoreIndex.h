@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_STOREINDEX_H
+#define KSMGMNT_STOREINDEX_H
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Entries returned by one list request when no page size is given, and the maximum
+#define STORE_INDEX_PAGE_SIZE 50
+#define STORE_INDEX_MAX_PAGE_SIZE 500
+
+/**
+ * Compact projection of the certificates and keys of the stores, so they can be listed with filters
+ * and in pages without decoding every certificate again. Certificates are ordered on their thumbprint,
+ * keys on their name, and the cursor of a page is the last returned thumbprint or name.
+ */
+class StoreIndex {
+public:
+    // Filter on whether a certificate has a private key, or whether a key has a certificate
+    enum class presence {
+        Any = 0,
+        With,
+        Without
+    };
+
+    struct Certificate {
+        std::string thumbprint;     // hex SHA1 of the certificate
+        std::string subject;
+        std::string issuer;
+        std::string serialNumber;   // hex, big endian
+        std::time_t notBefore;
+        std::time_t notAfter;
+        std::string keyName;        // empty without a private key
+        std::string fingerprint;    // hex SHA-256 of the certificate
+    };
+
+    struct Key {
+        std::string name;
+        std::string algorithm;
+        std::string thumbprint;     // certificate linked to the key, empty when there is none
+    };
+
+    struct CertificateFilter {
+        std::string issuer;                     // exact issuer name, empty for all issuers
+        std::string subject;                    // case insensitive part of the subject name
+        std::time_t expiresFrom = 0;            // notAfter at or after, 0 for no lower bound
+        std::time_t expiresTo = 0;              // notAfter at or before, 0 for no upper bound
+        presence privateKey = presence::Any;
+    };
+
+    struct KeyFilter {
+        presence certificate = presence::Any;
+    };
+
+    template<class T>
+    struct Page {
+        std::vector<T> entries;
+        // Pass to the next list call, empty on the last page
+        std::string cursor;
+    };
+
+    /**
+     * Replace the indexed certificates, entries with the same thumbprint replace each other
+     */
+    void setCertificates(const std::vector<Certificate> &certificates);
+
+    void setKeys(const std::vector<Key> &keys);
+
+    /**
+     * Copy an indexed certificate, so it does not have to be decoded again when the index is rebuilt
+     * @return false when the certificate is not indexed
+     */
+    bool getCertificate(const std::string &thumbprint, Certificate &certificate) const;
+
+    size_t getCertificateCount() const;
+
+    size_t getKeyCount() const;
+
+    /**
+     * @param cursor empty for the first page
+     * @param pageSize 0 for STORE_INDEX_PAGE_SIZE, limited to STORE_INDEX_MAX_PAGE_SIZE
+     */
+    Page<Certificate> listCertificates(const CertificateFilter &filter,
+                                       const std::string &cursor = std::string(),
+                                       size_t pageSize = 0) const;
+
+    Page<Key> listKeys(const KeyFilter &filter,
+                       const std::string &cursor = std::string(),
+                       size_t pageSize = 0) const;
+
+private:
+    struct IndexedCertificate {
+        Certificate certificate;
+        std::string lowerSubject;
+    };
+
+    static bool matches(const IndexedCertificate &indexed, const CertificateFilter &filter, const std::string &subject);
+
+    static size_t limitPageSize(size_t pageSize);
+
+    static std::string toLower(const std::string &value);
+
+    std::map<std::string, IndexedCertificate> certificates;
+    // (issuer, thumbprint), so the certificates of one issuer are listed without scanning the others
+    std::set<std::pair<std::string, std::string>> byIssuer;
+    std::map<std::string, Key> keys;
+    mutable std::mutex lock;
+};
+
+#endif //KSMGMNT_STOREINDEX_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
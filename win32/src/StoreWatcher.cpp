@@ -0,0 +1,71 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "StoreWatcher.h"
+#include "Metrics.h"
+
+static const char *generationCounters[STORE_WATCHER_STORES] = {
+        "store.certificates_generation",
+        "store.issuers_generation",
+        "store.keys_generation"
+};
+
+StoreWatcher::StoreWatcher() : generations{0, 0, 0} {
+}
+
+void StoreWatcher::watch(watchedStore store, std::unique_ptr<Source> source) {
+    std::lock_guard<std::mutex> guard(lock);
+    sources.push_back(std::make_pair(store, std::move(source)));
+}
+
+bool StoreWatcher::poll() {
+    std::lock_guard<std::mutex> guard(lock);
+    bool changed[STORE_WATCHER_STORES] = {false, false, false};
+    // Every source is asked, so each one waits for its next change again
+    for (auto &source : sources) {
+        if (source.second->changed()) {
+            changed[static_cast<size_t>(source.first)] = true;
+        }
+    }
+    bool anyChanged = false;
+    for (size_t store = 0; store < STORE_WATCHER_STORES; store++) {
+        if (changed[store]) {
+            generations[store]++;
+            Metrics::GetInstance().set(generationCounters[store], generations[store]);
+            anyChanged = true;
+        }
+    }
+    return anyChanged;
+}
+
+uint64_t StoreWatcher::getGeneration(watchedStore store) const {
+    std::lock_guard<std::mutex> guard(lock);
+    return generations[static_cast<size_t>(store)];
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_STOREWATCHER_H
+#define KSMGMNT_STOREWATCHER_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define STORE_WATCHER_STORES 3
+
+/**
+ * Keeps a generation per store, which moves on every time another process (certmgr, other applications) changes
+ * the store. A cache remembers the generation it was built at, and is only rebuilt when the generation moved on,
+ * instead of on every request. The generations are reported as the counters store.certificates_generation,
+ * store.issuers_generation and store.keys_generation in Metrics.
+ */
+class StoreWatcher {
+public:
+    enum class watchedStore {
+        Certificates = 0,   // MY store
+        Issuers,            // CA and ROOT stores
+        Keys                // key store
+    };
+
+    /**
+     * Change notification of a store
+     */
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        /**
+         * Whether the store changed since the previous call, which waits for the next change again
+         */
+        virtual bool changed() = 0;
+    };
+
+    StoreWatcher();
+
+    StoreWatcher(const StoreWatcher &) = delete;
+
+    void operator=(const StoreWatcher &) = delete;
+
+    /**
+     * A store can have several sources, a store without sources keeps its generation
+     */
+    void watch(watchedStore store, std::unique_ptr<Source> source);
+
+    /**
+     * Ask every source whether its store changed, without waiting
+     * @return true when a generation moved on
+     */
+    bool poll();
+
+    uint64_t getGeneration(watchedStore store) const;
+
+private:
+    std::vector<std::pair<watchedStore, std::unique_ptr<Source>>> sources;
+    uint64_t generations[STORE_WATCHER_STORES];
+    mutable std::mutex lock;
+};
+
+#endif //KSMGMNT_STOREWATCHER_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
@@ -0,0 +1,178 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "Utf8Utils.h"
+
+#define UTF8_ASCII_MASK 0x8080808080808080ULL
+#define UTF16_ASCII_MASK 0xFF80FF80FF80FF80ULL
+
+static bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+size_t Utf8Utils::toUtf16(const char *input, size_t size, char16_t *output) {
+    auto in = reinterpret_cast<const unsigned char *>(input);
+    size_t i = 0;
+    size_t written = 0;
+    while (i < size) {
+        // 8 ASCII bytes at once
+        if (size - i >= 8) {
+            uint64_t block;
+            memcpy(&block, in + i, sizeof(block));
+            if ((block & UTF8_ASCII_MASK) == 0) {
+                for (size_t j = 0; j < 8; j++) {
+                    output[written++] = in[i + j];
+                }
+                i += 8;
+                continue;
+            }
+        }
+        unsigned char lead = in[i];
+        if (lead < 0x80) {
+            output[written++] = lead;
+            i++;
+            continue;
+        }
+        uint32_t codePoint;
+        size_t length;
+        unsigned char min = 0x80;
+        unsigned char max = 0xBF;
+        if ((lead >= 0xC2) && (lead <= 0xDF)) {
+            codePoint = lead & 0x1F;
+            length = 2;
+        }
+        else if ((lead >= 0xE0) && (lead <= 0xEF)) {
+            codePoint = lead & 0x0F;
+            length = 3;
+            // No overlong encodings and no surrogates
+            min = (lead == 0xE0) ? 0xA0 : 0x80;
+            max = (lead == 0xED) ? 0x9F : 0xBF;
+        }
+        else if ((lead >= 0xF0) && (lead <= 0xF4)) {
+            codePoint = lead & 0x07;
+            length = 4;
+            // No overlong encodings and nothing above U+10FFFF
+            min = (lead == 0xF0) ? 0x90 : 0x80;
+            max = (lead == 0xF4) ? 0x8F : 0xBF;
+        }
+        else {
+            throw std::invalid_argument("Invalid UTF-8 lead byte");
+        }
+        if (size - i < length) {
+            throw std::invalid_argument("Truncated UTF-8 sequence");
+        }
+        if ((in[i + 1] < min) || (in[i + 1] > max)) {
+            throw std::invalid_argument("Invalid UTF-8 sequence");
+        }
+        for (size_t j = 1; j < length; j++) {
+            if (!isContinuation(in[i + j])) {
+                throw std::invalid_argument("Invalid UTF-8 sequence");
+            }
+            codePoint = (codePoint << 6) | (in[i + j] & 0x3F);
+        }
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            output[written++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            output[written++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+        else {
+            output[written++] = static_cast<char16_t>(codePoint);
+        }
+        i += length;
+    }
+
+    return written;
+}
+
+size_t Utf8Utils::toUtf8(const char16_t *input, size_t size, char *output) {
+    auto out = reinterpret_cast<unsigned char *>(output);
+    size_t i = 0;
+    size_t written = 0;
+    while (i < size) {
+        // 4 ASCII code units at once
+        if (size - i >= 4) {
+            uint64_t block;
+            memcpy(&block, input + i, sizeof(block));
+            if ((block & UTF16_ASCII_MASK) == 0) {
+                for (size_t j = 0; j < 4; j++) {
+                    out[written++] = static_cast<unsigned char>(input[i + j]);
+                }
+                i += 4;
+                continue;
+            }
+        }
+        uint32_t codePoint = input[i++];
+        if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF)) {
+            if ((i == size) || (input[i] < 0xDC00) || (input[i] > 0xDFFF)) {
+                throw std::invalid_argument("Unpaired UTF-16 surrogate");
+            }
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (input[i++] - 0xDC00);
+        }
+        else if ((codePoint >= 0xDC00) && (codePoint <= 0xDFFF)) {
+            throw std::invalid_argument("Unpaired UTF-16 surrogate");
+        }
+
+        if (codePoint < 0x80) {
+            out[written++] = static_cast<unsigned char>(codePoint);
+        }
+        else if (codePoint < 0x800) {
+            out[written++] = static_cast<unsigned char>(0xC0 | (codePoint >> 6));
+            out[written++] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000) {
+            out[written++] = static_cast<unsigned char>(0xE0 | (codePoint >> 12));
+            out[written++] = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out[written++] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+        }
+        else {
+            out[written++] = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+            out[written++] = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out[written++] = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out[written++] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    return written;
+}
+
+std::u16string Utf8Utils::toUtf16(const std::string &utf8) {
+    std::u16string utf16(utf8.size(), u'\0');
+    utf16.resize(toUtf16(utf8.data(), utf8.size(), &utf16[0]));
+    return utf16;
+}
+
+std::string Utf8Utils::toUtf8(const std::u16string &utf16) {
+    std::string utf8(utf16.size() * 3, '\0');
+    utf8.resize(toUtf8(utf16.data(), utf16.size(), &utf8[0]));
+    return utf8;
+}
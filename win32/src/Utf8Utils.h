@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_UTF8UTILS_H
+#define KSMGMNT_UTF8UTILS_H
+#include <cstddef>
+#include <string>
+
+/**
+ * Validating UTF-8 <-> UTF-16 conversion into buffers of the caller, without allocations. ASCII, which
+ * is most of the names and passwords, is converted 8 bytes at a time.
+ */
+class Utf8Utils {
+public:
+    /**
+     * Convert UTF-8 to UTF-16
+     * @param output room for size code units, UTF-16 never needs more code units than UTF-8 bytes
+     * @return the number of UTF-16 code units written
+     * throws std::invalid_argument on invalid UTF-8 (truncated, overlong, surrogates or above U+10FFFF)
+     */
+    static size_t toUtf16(const char *input, size_t size, char16_t *output);
+
+    /**
+     * Convert UTF-16 to UTF-8
+     * @param output room for 3 * size bytes
+     * @return the number of UTF-8 bytes written
+     * throws std::invalid_argument on unpaired surrogates
+     */
+    static size_t toUtf8(const char16_t *input, size_t size, char *output);
+
+    static std::u16string toUtf16(const std::string &utf8);
+
+    static std::string toUtf8(const std::u16string &utf16);
+};
+
+#endif //KSMGMNT_UTF8UTILS_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
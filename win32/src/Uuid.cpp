@@ -0,0 +1,103 @@
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#include "common.h"
+#include <bcrypt.h>
+#include <chrono>
+#include <cstring>
+#include "Uuid.h"
+#include "KSException.h"
+
+void Uuid::generate(uuidVersion version, unsigned char uuid[16]) {
+    if (version == uuidVersion::V7) {
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch());
+        generate(static_cast<uint64_t>(now.count()), uuid);
+        return;
+    }
+    random(uuid, 16);
+    uuid[6] = static_cast<unsigned char>((uuid[6] & 0x0F) | 0x40);
+    uuid[8] = static_cast<unsigned char>((uuid[8] & 0x3F) | 0x80);
+}
+
+void Uuid::generate(uint64_t unixMilliseconds, unsigned char uuid[16]) {
+    // 48 bit big endian timestamp followed by 74 random bits
+    for (int i = 0; i < 6; i++) {
+        uuid[i] = static_cast<unsigned char>(unixMilliseconds >> (40 - 8 * i));
+    }
+    random(uuid + 6, 10);
+    uuid[6] = static_cast<unsigned char>((uuid[6] & 0x0F) | 0x70);
+    uuid[8] = static_cast<unsigned char>((uuid[8] & 0x3F) | 0x80);
+}
+
+template<class T>
+static void formatUuid(const unsigned char uuid[16], T text[UUID_STRING_LENGTH + 1]) {
+    static const char digits[] = "0123456789abcdef";
+    size_t position = 0;
+    for (int i = 0; i < 16; i++) {
+        if ((i == 4) || (i == 6) || (i == 8) || (i == 10)) {
+            text[position++] = '-';
+        }
+        text[position++] = digits[uuid[i] >> 4];
+        text[position++] = digits[uuid[i] & 0x0F];
+    }
+    text[position] = 0;
+}
+
+void Uuid::format(const unsigned char uuid[16], char text[UUID_STRING_LENGTH + 1]) {
+    formatUuid(uuid, text);
+}
+
+void Uuid::format(const unsigned char uuid[16], wchar_t text[UUID_STRING_LENGTH + 1]) {
+    formatUuid(uuid, text);
+}
+
+void Uuid::random(unsigned char *data, size_t size) {
+    // One system call per UUID_RANDOM_POOL bytes, every byte is handed out once and wiped
+    thread_local unsigned char pool[UUID_RANDOM_POOL];
+    thread_local size_t available = 0;
+
+    while (size > 0) {
+        if (available == 0) {
+            NTSTATUS status = BCryptGenRandom(nullptr, pool, sizeof(pool), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+            if (status != STATUS_SUCCESS) {
+                throw KSException(__func__, __LINE__, static_cast<DWORD>(status));
+            }
+            available = sizeof(pool);
+        }
+        size_t chunk = (size < available) ? size : available;
+        unsigned char *source = pool + sizeof(pool) - available;
+        memcpy(data, source, chunk);
+        SecureZeroMemory(source, chunk);
+        data += chunk;
+        size -= chunk;
+        available -= chunk;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_UUID_H
+#define KSMGMNT_UUID_H
+#include <cstdint>
+#include <cstddef>
+
+// Characters of the text form, without the terminating zero
+#define UUID_STRING_LENGTH 36
+// Random bytes fetched from the system at once per thread
+#define UUID_RANDOM_POOL 256
+
+/**
+ * RFC 9562 UUIDs from the system CSPRNG, without the RPC runtime. Version 7 UUIDs start with the time in
+ * milliseconds, so key names generated later sort after earlier ones.
+ */
+class Uuid {
+public:
+    enum class uuidVersion {
+        V4 = 4,     // random
+        V7 = 7      // unix time in milliseconds + random
+    };
+
+    /**
+     * @param uuid receives the 16 bytes of the UUID
+     * throws KSException when the system random generator fails
+     */
+    static void generate(uuidVersion version, unsigned char uuid[16]);
+
+    /**
+     * Version 7 UUID at the given time
+     */
+    static void generate(uint64_t unixMilliseconds, unsigned char uuid[16]);
+
+    /**
+     * Lower case text form (8-4-4-4-12) with a terminating zero
+     */
+    static void format(const unsigned char uuid[16], char text[UUID_STRING_LENGTH + 1]);
+
+    static void format(const unsigned char uuid[16], wchar_t text[UUID_STRING_LENGTH + 1]);
+
+private:
+    static void random(unsigned char *data, size_t size);
+};
+
+#endif //KSMGMNT_UUID_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/
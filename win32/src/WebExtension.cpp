@@ -5,121 +5,644 @@
  * Date: 09/08/2020
  */
 
+#include <algorithm>
 #include <iomanip>
-#include <locale>
-#include <codecvt>
+#include <map>
+#include <vector>
+#include <mutex>
 #include "WebExtension.h"
 #include "sstream"
 #include "CertificateStore.h"
 #include "Base64Utils.h"
 #include "KSException.h"
+#include "RevocationChecker.h"
+#include "RequestScheduler.h"
+#include "Metrics.h"
+#include "CancellationToken.h"
+#include "ResultCache.h"
+#include "Digest.h"
+#include "SecureArena.h"
+#include "Utf8Utils.h"
+#include "RequestRegistry.h"
+#include "FrameReader.h"
+#include <shlwapi.h>
 
 using namespace std;
 
-WebExtension::WebExtension() : inDataLg{0}, passwordProtect{true} {
+static ResultCache &getResultCache() {
+    static ResultCache resultCache;
+    return resultCache;
 }
 
-void WebExtension::runFunction(std::ostream &out) {
-    nlohmann::json outData;
+static std::string toRequestId(const nlohmann::json &requestId) {
+    return requestId.is_string() ? requestId.get<std::string>() : requestId.dump();
+}
+
+static void writeResponse(std::ostream &out, const nlohmann::json &outData) {
+    std::string tmpOut = outData.dump();
+    uint32_t tmpOutLg = tmpOut.size();
+    out.write((char *)&tmpOutLg, 4);
+    out << tmpOut;
+}
+
+/**
+ * Convert the UTF-8 password of a request to a wide string in the secure arena, and wipe it from the request
+ */
+static SecureWideString takePassword(nlohmann::json &password) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "UTF-16 wide strings");
+    auto &utf8 = password.get_ref<std::string &>();
+    SecureWideString wide(utf8.size() + 1, L'\0');
     try {
-        if ((!inData.contains("request_id")) ||
-            (!inData.contains("request"))){
-            throw KSException(__func__, __LINE__, "Missing Parameters");
+        size_t passwordLg = Utf8Utils::toUtf16(utf8.data(), utf8.size(), reinterpret_cast<char16_t *>(wide.data()));
+        wide.resize(passwordLg + 1);
+    }
+    catch (...) {
+        SecureZeroMemory(&utf8[0], utf8.size());
+        throw;
+    }
+    SecureZeroMemory(&utf8[0], utf8.size());
+    utf8.clear();
+    return wide;
+}
+
+/**
+ * Client, request_id and SHA-256 of the fields of a request. The password is left out, so it is not copied
+ * into a serialized request.
+ */
+static std::string getCacheKey(const std::string &client, const nlohmann::json &request) {
+    Digest digest(Digest::hashAlgorithm::Sha256);
+    for (auto &field : request.items()) {
+        if (field.key() == "password") {
+            continue;
         }
-        string function = inData["request"];
-        outData["request_id"] = inData["request_id"];
-        CertificateStore certificateStore;
-        if (function == "create_csr") {
-            auto data = certificateStore.createCertificateRequest(
-                    inData["subject_name"],
-                    inData["rsa_key_length"],
-                    passwordProtect);
-            std::vector<unsigned char> vecData(data.begin(), data.end());
-            outData["response"] = Base64Utils::toBase64(vecData);
-            outData["result"] = "OK";
+        std::string value = field.key() + "=" + field.value().dump() + "\n";
+        digest.update(reinterpret_cast<const unsigned char *>(value.data()), value.size());
+    }
+    unsigned char fingerprint[32];
+    digest.finish(fingerprint, sizeof(fingerprint));
+    return client + "\n" + toRequestId(request.at("request_id")) + "\n" +
+           std::string(reinterpret_cast<const char *>(fingerprint), sizeof(fingerprint));
+}
+
+/**
+ * One checker per CRL directory, so the index stays mapped between requests
+ */
+static std::shared_ptr<RevocationChecker> getRevocationChecker(const std::string &crlDirectory) {
+    static std::mutex checkersLock;
+    static std::map<std::string, std::shared_ptr<RevocationChecker>> checkers;
+
+    if (!PathIsDirectoryA(crlDirectory.c_str())) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(checkersLock);
+    auto &checker = checkers[crlDirectory];
+    if (!checker) {
+        checker = std::make_shared<RevocationChecker>(crlDirectory);
+    }
+    return checker;
+}
+
+WebExtension::WebExtension() : inDataLg{0}, passwordProtect{true} {
+}
+
+void WebExtension::runFunction(std::ostream &out) {
+    runFunction(out, nullptr);
+}
+
+void WebExtension::runFunction(std::ostream &out, CertificateStore &certificateStore) {
+    runFunction(out, &certificateStore);
+}
+
+namespace {
+
+struct RequestContext {
+    CertificateStore &certificateStore;
+    const RequestSchema::Values &values;
+    bool passwordProtect;
+    const std::string &client;
+};
+
+typedef void (*RequestHandler)(RequestContext &context, nlohmann::json &outData);
+
+}
+
+static constexpr RequestSchema::Field createCsrFields[] = {
+        {"subject_name", RequestSchema::fieldType::String, true},
+        {"rsa_key_length", RequestSchema::fieldType::Unsigned, true}
+};
+
+static void createCsr(RequestContext &context, nlohmann::json &outData) {
+    auto data = context.certificateStore.createCertificateRequest(
+            context.values[0]->get_ref<const std::string &>(),
+            context.values[1]->get<size_t>(),
+            context.passwordProtect);
+    std::vector<unsigned char> vecData(data.begin(), data.end());
+    outData["response"] = Base64Utils::toBase64(vecData);
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field createCsrBatchFields[] = {
+        {"requests", RequestSchema::fieldType::Array, true}
+};
+
+static void createCsrBatch(RequestContext &context, nlohmann::json &outData) {
+    std::vector<CertificateStore::RequestTemplate> templates;
+    for (auto &request : *context.values[0]) {
+        RequestSchema::Values values;
+        const char *error = RequestSchema::validate(request,
+                                                    createCsrFields,
+                                                    sizeof(createCsrFields) / sizeof(createCsrFields[0]),
+                                                    values);
+        if (error != nullptr) {
+            throw KSException(__func__, __LINE__, error);
         }
-        else if (function == "import_certificate") {
-            if (!inData.contains("certificate")) {
-                throw KSException(__func__, __LINE__, "Missing Parameters");
-            }
-            auto cert = Base64Utils::fromBase64(inData["certificate"]);
-            certificateStore.importCertificate(std::string(cert.data(), cert.size()));
-            outData["result"] = "OK";
-            outData["response"] = "import certificate successful";
+        templates.push_back({values[0]->get<std::string>(), values[1]->get<size_t>()});
+    }
+    auto generated = context.certificateStore.createCertificateRequests(templates, context.passwordProtect);
+    nlohmann::json csrs = nlohmann::json::array();
+    for (auto &request : generated) {
+        std::vector<unsigned char> vecData(request.request.begin(), request.request.end());
+        csrs.push_back({{"key_id", request.keyName},
+                        {"csr", Base64Utils::toBase64(vecData)}});
+    }
+    outData["response"] = csrs;
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field importCertificateFields[] = {
+        {"certificate", RequestSchema::fieldType::String, true}
+};
+
+static void importCertificate(RequestContext &context, nlohmann::json &outData) {
+    auto cert = Base64Utils::fromBase64(context.values[0]->get_ref<const std::string &>());
+    context.certificateStore.importCertificate(cert.data(), cert.size());
+    outData["result"] = "OK";
+    outData["response"] = "import certificate successful";
+}
+
+static constexpr RequestSchema::Field importPfxKeyFields[] = {
+        {"pkcs12", RequestSchema::fieldType::String, true},
+        {"password", RequestSchema::fieldType::String, true}
+};
+
+static void importPfxKey(RequestContext &context, nlohmann::json &outData) {
+    auto password = takePassword(*context.values[1]);
+    context.certificateStore.pfxImport(context.values[0]->get_ref<const std::string &>(),
+                                       password.data(),
+                                       context.passwordProtect);
+    outData["result"] = "OK";
+    outData["response"] = "import pfx successful";
+}
+
+static constexpr RequestSchema::Field exportPfxKeyFields[] = {
+        {"issuer", RequestSchema::fieldType::String, true},
+        {"serial_number", RequestSchema::fieldType::String, true},
+        {"password", RequestSchema::fieldType::String, true},
+        {"pfx_encryption", RequestSchema::fieldType::String, false},
+        {"include_chain", RequestSchema::fieldType::Boolean, false}
+};
+
+static void exportPfxKey(RequestContext &context, nlohmann::json &outData) {
+    auto encryption = CertificateStore::pfxEncryption::TripleDES_SHA1;
+    if (context.values[3] != nullptr) {
+        auto &pfxEncryption = context.values[3]->get_ref<const std::string &>();
+        if (pfxEncryption == "aes256") {
+            encryption = CertificateStore::pfxEncryption::AES256_SHA256;
         }
-        else if (function == "import_pfx_key") {
-            if ((!inData.contains("pkcs12")) ||
-                (!inData.contains("password"))){
-                throw KSException(__func__, __LINE__, "Missing Parameters");
-            }
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-            certificateStore.pfxImport( inData["pkcs12"],
-                                        converter.from_bytes(inData["password"]),
-                                        passwordProtect);
-            outData["result"] = "OK";
-            outData["response"] = "import pfx successful";
+        else if (pfxEncryption != "3des") {
+            throw KSException(__func__, __LINE__, "Invalid pfx_encryption");
         }
-        else if (function == "export_pfx_key") {
-            if ((!inData.contains("issuer")) ||
-                (!inData.contains("serial_number")) ||
-                (!inData.contains("password"))) {
-                throw KSException(__func__, __LINE__, "Missing Parameters");
-            }
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-            outData["response"] = certificateStore.pfxExport(inData["issuer"],
-                                                             inData["serial_number"],
-                                                             converter.from_bytes(inData["password"]));
-            outData["result"] = "OK";
+    }
+    bool includeChain = (context.values[4] != nullptr) && context.values[4]->get<bool>();
+    auto password = takePassword(*context.values[2]);
+    outData["response"] = context.certificateStore.pfxExport(context.values[0]->get_ref<const std::string &>(),
+                                                             context.values[1]->get_ref<const std::string &>(),
+                                                             password.data(),
+                                                             encryption,
+                                                             includeChain);
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field importPkcs8Fields[] = {
+        {"pkcs8", RequestSchema::fieldType::String, true},
+        {"password", RequestSchema::fieldType::String, true},
+        {"certificate", RequestSchema::fieldType::String, false}
+};
+
+static void importPkcs8(RequestContext &context, nlohmann::json &outData) {
+    auto pkcs8 = Base64Utils::fromBase64(context.values[0]->get_ref<const std::string &>());
+    std::vector<char> cert;
+    if (context.values[2] != nullptr) {
+        cert = Base64Utils::fromBase64(context.values[2]->get_ref<const std::string &>());
+    }
+    auto password = takePassword(*context.values[1]);
+    outData["response"] = context.certificateStore.importPkcs8(reinterpret_cast<const unsigned char *>(pkcs8.data()),
+                                                               pkcs8.size(),
+                                                               password.data(),
+                                                               context.values[2] ? cert.data() : nullptr,
+                                                               cert.size(),
+                                                               context.passwordProtect);
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field exportPkcs8Fields[] = {
+        {"issuer", RequestSchema::fieldType::String, true},
+        {"serial_number", RequestSchema::fieldType::String, true},
+        {"password", RequestSchema::fieldType::String, true},
+        {"iterations", RequestSchema::fieldType::Unsigned, false}
+};
+
+static void exportPkcs8(RequestContext &context, nlohmann::json &outData) {
+    uint32_t iterations = PKCS8_DEFAULT_ITERATIONS;
+    if (context.values[3] != nullptr) {
+        // The key store checks the bounds, this only keeps the number in range of the conversion
+        auto requested = context.values[3]->get<uint64_t>();
+        iterations = static_cast<uint32_t>((std::min)(requested, static_cast<uint64_t>(PKCS8_MAX_ITERATIONS + 1)));
+    }
+    auto password = takePassword(*context.values[2]);
+    auto exported = context.certificateStore.exportPkcs8(context.values[0]->get_ref<const std::string &>(),
+                                                         context.values[1]->get_ref<const std::string &>(),
+                                                         password.data(),
+                                                         iterations);
+    outData["response"]["pkcs8"] = Base64Utils::toBase64(exported.pkcs8);
+    outData["response"]["certificate"] = Base64Utils::toBase64(exported.certificate);
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field certificateIdFields[] = {
+        {"issuer", RequestSchema::fieldType::String, true},
+        {"serial_number", RequestSchema::fieldType::String, true}
+};
+
+static void getChain(RequestContext &context, nlohmann::json &outData) {
+    auto chain = context.certificateStore.getChain(context.values[0]->get_ref<const std::string &>(),
+                                                   context.values[1]->get_ref<const std::string &>());
+    std::vector<std::string> b64Chain;
+    for (auto &certificate : chain) {
+        b64Chain.push_back(Base64Utils::toBase64(certificate));
+    }
+    outData["response"] = b64Chain;
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field cancelFields[] = {
+        {"target_request_id", RequestSchema::fieldType::Any, true}
+};
+
+static void cancel(RequestContext &context, nlohmann::json &outData) {
+    if (CancellationToken::cancel(context.client, toRequestId(*context.values[0]))) {
+        outData["response"] = "cancelled";
+    }
+    else {
+        outData["response"] = "not running";
+    }
+    outData["result"] = "OK";
+}
+
+static void getMetrics(RequestContext &, nlohmann::json &outData) {
+    nlohmann::json timers;
+    for (auto &timer : Metrics::GetInstance().getTimers()) {
+        timers[timer.first]["count"] = timer.second.count;
+        timers[timer.first]["total_us"] = timer.second.totalMicroseconds;
+        timers[timer.first]["max_us"] = timer.second.maxMicroseconds;
+    }
+    nlohmann::json counters(Metrics::GetInstance().getCounters());
+    outData["response"]["timers"] = timers.is_null() ? nlohmann::json::object() : timers;
+    outData["response"]["counters"] = counters;
+    outData["result"] = "OK";
+}
+
+static void checkRevocation(RequestContext &context, nlohmann::json &outData) {
+    auto status = context.certificateStore.checkRevocation(context.values[0]->get_ref<const std::string &>(),
+                                                           context.values[1]->get_ref<const std::string &>());
+    if (status == RevocationIndex::revocationStatus::Revoked) {
+        outData["response"] = "revoked";
+    }
+    else if (status == RevocationIndex::revocationStatus::Good) {
+        outData["response"] = "good";
+    }
+    else {
+        outData["response"] = "unknown";
+    }
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field listCertificatesFields[] = {
+        {"issuer", RequestSchema::fieldType::String, false},
+        {"subject", RequestSchema::fieldType::String, false},
+        {"expires_after", RequestSchema::fieldType::Integer, false},
+        {"expires_before", RequestSchema::fieldType::Integer, false},
+        {"has_private_key", RequestSchema::fieldType::Boolean, false},
+        {"cursor", RequestSchema::fieldType::String, false},
+        {"page_size", RequestSchema::fieldType::Unsigned, false}
+};
+
+static void listCertificates(RequestContext &context, nlohmann::json &outData) {
+    StoreIndex::CertificateFilter filter;
+    if (context.values[0] != nullptr) {
+        filter.issuer = context.values[0]->get<std::string>();
+    }
+    if (context.values[1] != nullptr) {
+        filter.subject = context.values[1]->get<std::string>();
+    }
+    if (context.values[2] != nullptr) {
+        filter.expiresFrom = context.values[2]->get<std::time_t>();
+    }
+    if (context.values[3] != nullptr) {
+        filter.expiresTo = context.values[3]->get<std::time_t>();
+    }
+    if (context.values[4] != nullptr) {
+        filter.privateKey = context.values[4]->get<bool>() ?
+                StoreIndex::presence::With : StoreIndex::presence::Without;
+    }
+    auto page = context.certificateStore.listCertificates(
+            filter,
+            context.values[5] ? context.values[5]->get<std::string>() : std::string(),
+            context.values[6] ? context.values[6]->get<size_t>() : 0);
+    nlohmann::json certificates = nlohmann::json::array();
+    for (auto &certificate : page.entries) {
+        certificates.push_back({{"thumbprint", certificate.thumbprint},
+                                {"subject", certificate.subject},
+                                {"issuer", certificate.issuer},
+                                {"serial_number", certificate.serialNumber},
+                                {"not_before", certificate.notBefore},
+                                {"not_after", certificate.notAfter},
+                                {"has_private_key", !certificate.keyName.empty()},
+                                {"sha256", certificate.fingerprint}});
+    }
+    outData["response"]["certificates"] = certificates;
+    outData["response"]["cursor"] = page.cursor;
+    outData["result"] = "OK";
+}
+
+static constexpr RequestSchema::Field listKeysFields[] = {
+        {"has_certificate", RequestSchema::fieldType::Boolean, false},
+        {"cursor", RequestSchema::fieldType::String, false},
+        {"page_size", RequestSchema::fieldType::Unsigned, false}
+};
+
+static void listKeys(RequestContext &context, nlohmann::json &outData) {
+    StoreIndex::KeyFilter filter;
+    if (context.values[0] != nullptr) {
+        filter.certificate = context.values[0]->get<bool>() ?
+                StoreIndex::presence::With : StoreIndex::presence::Without;
+    }
+    auto page = context.certificateStore.listKeys(
+            filter,
+            context.values[1] ? context.values[1]->get<std::string>() : std::string(),
+            context.values[2] ? context.values[2]->get<size_t>() : 0);
+    nlohmann::json keys = nlohmann::json::array();
+    for (auto &key : page.entries) {
+        keys.push_back({{"name", key.name},
+                        {"algorithm", key.algorithm},
+                        {"thumbprint", key.thumbprint}});
+    }
+    outData["response"]["keys"] = keys;
+    outData["response"]["cursor"] = page.cursor;
+    outData["result"] = "OK";
+}
+
+// The fields are passed to the handler in the order of their schema
+static constexpr RequestType<RequestHandler> requestTypes[] = {
+        {"create_csr", createCsrFields, createCsr, RequestScheduler::costClass::Heavy, true},
+        {"create_csr_batch", createCsrBatchFields, createCsrBatch, RequestScheduler::costClass::Heavy, true},
+        {"import_certificate", importCertificateFields, importCertificate,
+         RequestScheduler::costClass::Interactive, true},
+        {"import_pfx_key", importPfxKeyFields, importPfxKey, RequestScheduler::costClass::Heavy, true},
+        {"export_pfx_key", exportPfxKeyFields, exportPfxKey, RequestScheduler::costClass::Heavy},
+        {"import_pkcs8", importPkcs8Fields, importPkcs8, RequestScheduler::costClass::Heavy, true},
+        {"export_pkcs8", exportPkcs8Fields, exportPkcs8, RequestScheduler::costClass::Heavy},
+        {"get_chain", certificateIdFields, getChain},
+        {"cancel", cancelFields, cancel},
+        {"get_metrics", getMetrics},
+        {"check_revocation", certificateIdFields, checkRevocation},
+        {"list_certificates", listCertificatesFields, listCertificates},
+        {"list_keys", listKeysFields, listKeys}
+};
+
+static constexpr auto requestDispatcher = makeRequestDispatcher(requestTypes);
+static_assert(requestDispatcher.isPerfect(), "request names must be unique");
+
+RequestScheduler::costClass WebExtension::getCostClass(const std::string &request) {
+    auto requestType = requestDispatcher.find(request);
+    // Unknown requests are only answered with an error
+    return (requestType == nullptr) ? RequestScheduler::costClass::Interactive : requestType->cost;
+}
+
+bool WebExtension::isCached(const std::string &request) {
+    auto requestType = requestDispatcher.find(request);
+    return (requestType != nullptr) && requestType->cached;
+}
+
+/**
+ * Find the request type and validate the request against its schema
+ */
+static KSStatus parseRequest(nlohmann::json &inData,
+                             const RequestType<RequestHandler> *&requestType,
+                             RequestSchema::Values &values) {
+    if (!inData.is_object()) {
+        return KSStatus(__func__, __LINE__, "Request is not an object");
+    }
+    auto request = inData.find("request");
+    if ((request == inData.end()) ||
+        (!request->is_string()) ||
+        (!inData.contains("request_id"))) {
+        return KSStatus(__func__, __LINE__, "Missing Parameters");
+    }
+    requestType = requestDispatcher.find(request->get_ref<const std::string &>());
+    if (requestType == nullptr) {
+        return KSStatus(__func__, __LINE__, "Invalid function called");
+    }
+    const char *error = requestType->validate(inData, values);
+    if (error != nullptr) {
+        return KSStatus(__func__, __LINE__, error);
+    }
+    return KSStatus();
+}
+
+bool WebExtension::runFunction(std::ostream &out, CertificateStore *sharedStore) {
+    nlohmann::json outData;
+    // Malformed requests are answered without an exception, the message is only formatted to log it
+    const RequestType<RequestHandler> *requestType = nullptr;
+    RequestSchema::Values values;
+    KSStatus status = inStatus.ok() ? parseRequest(inData, requestType, values) : inStatus;
+    if (!status.ok()) {
+        if (inData.contains("request_id")) {
+            outData["request_id"] = inData["request_id"];
         }
-        else {
-            outData["result"] = "NOK";
-            outData["response"] = "Bad Request";
-            LogEvent::GetInstance().error(0, "Invalid function called");
+        outData["result"] = "NOK";
+        outData["response"] = "Bad Request";
+        LogEvent::GetInstance().error(0, status.message());
+        writeResponse(out, outData);
+        return false;
+    }
+    try {
+        outData["request_id"] = inData["request_id"];
+        // The request can be cancelled while it waited for a worker
+        CancellationToken::checkpoint();
+        std::unique_ptr<CertificateStore> localStore;
+        if (sharedStore == nullptr) {
+            localStore.reset(new CertificateStore());
+            sharedStore = localStore.get();
         }
+        CertificateStore &certificateStore = *sharedStore;
+        certificateStore.setRevocationChecker(getRevocationChecker(
+                crlDirectory.empty() ? RevocationChecker::getDefaultDirectory() : crlDirectory));
+        RequestContext context{certificateStore, values, passwordProtect, client};
+        requestType->handler(context, outData);
     }
-    catch (KSException e) {
+    catch (OperationCancelled &e) {
+        outData["result"] = "NOK";
+        outData["response"] = "Cancelled";
+        LogEvent::GetInstance().info(0, e.what());
+    }
+    catch (const KSException &e) {
         outData["result"] = "NOK";
         outData["response"] = "Bad Request";
         LogEvent::GetInstance().error(0, e.what());
     }
-    catch (exception e) {
+    catch (const exception &e) {
         outData["result"] = "NOK";
         outData["response"] = "Bad Request";
         LogEvent::GetInstance().error(0, e.what());
     }
-    std::string tmpOut = outData.dump();
-    uint32_t tmpOutLg = tmpOut.size();
-    out.write((char *)&tmpOutLg, 4);
-    out << tmpOut;
+    writeResponse(out, outData);
+
+    return outData["result"] == "OK";
 }
 
 void WebExtension::setPasswordProtect(bool onOff) {
     passwordProtect = onOff;
 };
 
+void WebExtension::setCrlDirectory(const std::string &directory) {
+    crlDirectory = directory;
+}
+
 WebExtension::WebExtension(std::istream &in) : inDataLg{0}, passwordProtect{true} {
-    in.read((char *)&inDataLg, 4);
+    FrameReader reader(in);
+    parseFrame(reader, reader.read());
+}
+
+WebExtension::WebExtension(const FrameReader &reader, FrameReader::frameStatus status) : inDataLg{0},
+                                                                                          passwordProtect{true} {
+    parseFrame(reader, status);
+}
+
+void WebExtension::parseFrame(const FrameReader &reader, FrameReader::frameStatus frameStatus) {
+    inDataLg = reader.getFrameLength();
+    if (frameStatus == FrameReader::frameStatus::Oversized) {
+        inStatus = KSStatus(__func__, __LINE__, "Frame too large");
+        return;
+    }
+    if (frameStatus == FrameReader::frameStatus::Truncated) {
+        inStatus = KSStatus(__func__, __LINE__, "Truncated frame");
+        return;
+    }
     if (inDataLg == 0) {
-        throw KSException(__func__, __LINE__, "No data (length = 0)");
+        inStatus = KSStatus(__func__, __LINE__, "No data (length = 0)");
+        return;
+    }
+    // The message must be exactly one JSON value, trailing data is malformed too
+    inData = nlohmann::json::parse(reader.data(), reader.data() + reader.size(), nullptr, false);
+    if (inData.is_discarded()) {
+        inStatus = KSStatus(__func__, __LINE__, "Malformed JSON");
     }
-    in >> inData;
 }
 
 void WebExtension::process_request(std::istream &in, std::ostream &out) {
+    FrameReader reader(in);
+    process_request(reader, reader.read(), out, nullptr, nullptr, std::string());
+}
+
+void WebExtension::process_request(const FrameReader &reader, FrameReader::frameStatus status, std::ostream &out) {
+    process_request(reader, status, out, nullptr, nullptr, std::string());
+}
+
+void WebExtension::process_request(std::istream &in, std::ostream &out, CertificateStore &certificateStore) {
+    FrameReader reader(in);
+    process_request(reader, reader.read(), out, &certificateStore, nullptr, std::string());
+}
+
+void WebExtension::process_request(std::istream &in,
+                                   std::ostream &out,
+                                   CertificateStore &certificateStore,
+                                   RequestScheduler &scheduler,
+                                   const std::string &client) {
+    FrameReader reader(in);
+    process_request(reader, reader.read(), out, &certificateStore, &scheduler, client);
+}
+
+void WebExtension::process_request(const FrameReader &reader,
+                                   FrameReader::frameStatus status,
+                                   std::ostream &out,
+                                   CertificateStore *sharedStore,
+                                   RequestScheduler *scheduler,
+                                   const std::string &client) {
 
     try {
-        WebExtension webExtension(in);
+        WebExtension webExtension(reader, status);
+        webExtension.client = client;
 
-        webExtension.runFunction(out);
+        std::shared_ptr<CancellationToken> token;
+        if (webExtension.inData.contains("deadline_ms") && webExtension.inData["deadline_ms"].is_number_unsigned()) {
+            auto deadlineMs = webExtension.inData["deadline_ms"].get<uint64_t>();
+            if (deadlineMs > REQUEST_MAX_DEADLINE_MS) {
+                // The time point of a larger deadline can overflow the clock
+                webExtension.inStatus = KSStatus(__func__, __LINE__, "deadline_ms too large");
+                token = std::make_shared<CancellationToken>();
+            }
+            else {
+                auto deadline = std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(deadlineMs));
+                token = std::make_shared<CancellationToken>(CancellationToken::Clock::now() + deadline);
+            }
+        }
+        else {
+            token = std::make_shared<CancellationToken>();
+        }
+        std::unique_ptr<CancellationToken::Registration> registration;
+        if (webExtension.inData.contains("request_id")) {
+            registration.reset(new CancellationToken::Registration(client,
+                                                                   toRequestId(webExtension.inData["request_id"]),
+                                                                   token));
+        }
+        std::string function;
+        if (webExtension.inData.contains("request") && webExtension.inData["request"].is_string()) {
+            function = webExtension.inData["request"].get<std::string>();
+        }
+        auto run = [&webExtension, &function, sharedStore, token, scheduler](bool &cacheable) {
+            std::ostringstream response;
+            auto execute = [&webExtension, &response, &cacheable, sharedStore, token] {
+                CancellationToken::Scope scope(token);
+                // Only OK responses are reused, a failed request can be retried
+                cacheable = webExtension.runFunction(response, sharedStore);
+            };
+            if (scheduler == nullptr) {
+                execute();
+            }
+            else {
+                scheduler->submit(getCostClass(function), execute).get();
+            }
+            return response.str();
+        };
+
+        // A retry of a request which changes the store (same client, request_id and body) gets the response
+        // of the first one
+        std::string response;
+        if (webExtension.inData.contains("request_id") && isCached(function)) {
+            response = getResultCache().getOrRun(getCacheKey(client, webExtension.inData), run);
+        }
+        else {
+            bool cacheable;
+            response = run(cacheable);
+        }
+        out.write(response.data(), response.size());
     }
-    catch (std::exception &e) {
+    catch (const std::exception &e) {
         nlohmann::json outData;
         outData["result"] = "NOK";
         outData["response"] = "Bad Request";
         LogEvent::GetInstance().error(0, e.what());
-        std::string tmpOut = outData.dump();
-        uint32_t tmpOutLg = tmpOut.size();
-        out.write((char *)&tmpOutLg, 4);
-        out << tmpOut;
+        writeResponse(out, outData);
     }
 }
\ No newline at end of file
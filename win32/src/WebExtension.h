@@ -11,6 +11,14 @@
 #include <string>
 #include <nlohmann/json.hpp>
 #include "LogEvent.h"
+#include "KSStatus.h"
+#include "RequestScheduler.h"
+#include "FrameReader.h"
+
+// Largest deadline_ms of a request, a day
+#define REQUEST_MAX_DEADLINE_MS (24ULL * 60 * 60 * 1000)
+
+class CertificateStore;
 
 class WebExtension {
 
@@ -18,18 +26,78 @@ public:
 
     static void process_request(std::istream &in, std::ostream &out);
 
+    /**
+     * Process a frame which was read already, without buffering it again
+     * @param status result of reader.read()
+     */
+    static void process_request(const FrameReader &reader, FrameReader::frameStatus status, std::ostream &out);
+
+    /**
+     * Process a request on a certificate store which is shared between requests
+     */
+    static void process_request(std::istream &in, std::ostream &out, CertificateStore &certificateStore);
+
+    /**
+     * Process a request on a shared certificate store, on a worker of the scheduler which matches the cost
+     * of the request
+     * @param client identity of the client, a client can only cancel its own requests
+     */
+    static void process_request(std::istream &in,
+                                std::ostream &out,
+                                CertificateStore &certificateStore,
+                                RequestScheduler &scheduler,
+                                const std::string &client);
+
+    /**
+     * Cost class of a request type, from the registry of the request types
+     */
+    static RequestScheduler::costClass getCostClass(const std::string &request);
+
+    /**
+     * true when the response of a request type is kept for retries of the request
+     */
+    static bool isCached(const std::string &request);
+
     WebExtension();
 
     WebExtension(std::istream &in);
 
     void runFunction(std::ostream &out);
 
+    void runFunction(std::ostream &out, CertificateStore &certificateStore);
+
     void setPasswordProtect(bool onOff);
 
+    /**
+     * Directory with the CRLs for the revocation checks, default the crl directory next to the executable
+     */
+    void setCrlDirectory(const std::string &directory);
+
 private:
+    static void process_request(const FrameReader &reader,
+                                FrameReader::frameStatus status,
+                                std::ostream &out,
+                                CertificateStore *sharedStore,
+                                RequestScheduler *scheduler,
+                                const std::string &client);
+
+    WebExtension(const FrameReader &reader, FrameReader::frameStatus status);
+
+    void parseFrame(const FrameReader &reader, FrameReader::frameStatus status);
+
+    /**
+     * @return true when the result is OK
+     */
+    bool runFunction(std::ostream &out, CertificateStore *sharedStore);
+
     uint32_t inDataLg;
     nlohmann::json inData;
+    // Error while reading the request, it is answered by runFunction
+    KSStatus inStatus;
     bool passwordProtect;
+    std::string crlDirectory;
+    // Requests of a process without clients, like stdio, have an empty client
+    std::string client;
 };
 
 
@@ -9,6 +9,10 @@
 #include <iostream>
 #include <sstream>
 #include "WebExtension.h"
+#include "Broker.h"
+#include "SharedMemoryTransport.h"
+#include "FrameReader.h"
+#include "CertificateStore.h"
 #include "KSException.h"
 #include "LogEvent.h"
 #include "version.h"
@@ -71,9 +75,109 @@ int main(int argc, char* argv[]) {
             std::cout << "Version: " << VERSION << std::endl;
             return 0;
         }
+        if (strncmp(argv[1], "--gc", strlen("--gc")) == 0) {
+            try {
+                // Optional --gc-age=<hours>, keys younger than this are kept
+                std::chrono::seconds minimumAge = KEY_COLLECTOR_MINIMUM_AGE;
+                for (int i = 2; i < argc; i++) {
+                    if (strncmp(argv[i], "--gc-age=", strlen("--gc-age=")) == 0) {
+                        minimumAge = std::chrono::hours(strtoul(argv[i] + strlen("--gc-age="), nullptr, 10));
+                    }
+                }
+                CertificateStore certificateStore;
+                std::cout << "Deleted keys: " << certificateStore.collectOrphanKeys(minimumAge) << std::endl;
+                return 0;
+            }
+            catch (KSException &e) {
+                LogEvent::GetInstance().error(e.code(), e.what());
+                return e.code();
+            }
+            catch (std::invalid_argument &e) {
+                LogEvent::GetInstance().error(0, e.what());
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+        if (strncmp(argv[1], "--broker", strlen("--broker")) == 0) {
+            try {
+                size_t heavyWorkers = 0;
+                size_t interactiveWorkers = 0;
+                // Optional --gc-age=<hours>, orphaned keys younger than this are kept
+                std::chrono::seconds keyAge = KEY_COLLECTOR_MINIMUM_AGE;
+                for (int i = 2; i < argc; i++) {
+                    if (strncmp(argv[i], "--heavy-workers=", strlen("--heavy-workers=")) == 0) {
+                        heavyWorkers = strtoul(argv[i] + strlen("--heavy-workers="), nullptr, 10);
+                    }
+                    else if (strncmp(argv[i], "--interactive-workers=", strlen("--interactive-workers=")) == 0) {
+                        interactiveWorkers = strtoul(argv[i] + strlen("--interactive-workers="), nullptr, 10);
+                    }
+                    else if (strncmp(argv[i], "--gc-age=", strlen("--gc-age=")) == 0) {
+                        keyAge = std::chrono::hours(strtoul(argv[i] + strlen("--gc-age="), nullptr, 10));
+                    }
+                }
+                Broker broker(Broker::getPipeName(), heavyWorkers, interactiveWorkers, keyAge);
+                broker.run();
+                return 0;
+            }
+            catch (KSException &e) {
+                LogEvent::GetInstance().error(e.code(), e.what());
+                return e.code();
+            }
+            catch (std::invalid_argument &e) {
+                LogEvent::GetInstance().error(0, e.what());
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if ((argc > 2) && (strncmp(argv[1], "--shm", strlen("--shm")) == 0)) {
+        auto transport = SharedMemoryTransport::open(argv[2]);
+        if (transport) {
+            try {
+                CertificateStore certificateStore;
+                std::string request;
+                while (transport->readFrame(request)) {
+                    FrameBuffer buffer(&request[0], request.size());
+                    std::istream in(&buffer);
+                    std::ostringstream out;
+                    WebExtension::process_request(in, out, certificateStore);
+                    Broker::wipe(request);
+                    transport->writeFrame(out.str());
+                }
+                return 0;
+            }
+            catch (KSException &e) {
+                LogEvent::GetInstance().error(e.code(), e.what());
+                return e.code();
+            }
+        }
+        LogEvent::GetInstance().warning(0, "No shared memory transport, falling back to stdio");
     }
 
-    WebExtension::process_request(std::cin, std::cout);
+    // Hand the request to the broker of the user when it runs, else handle it in this process. The frame is read
+    // once into the buffer of the reader, which is relayed or processed from there and wiped when it is released.
+    FrameReader reader(std::cin);
+    auto status = reader.read();
+    std::string response;
+    try {
+        if ((status == FrameReader::frameStatus::Ok) && Broker::relay(reader.data(), reader.size(), response)) {
+            std::cout.write(response.data(), response.size());
+            return 0;
+        }
+    }
+    catch (KSException &e) {
+        LogEvent::GetInstance().error(e.code(), e.what());
+        nlohmann::json outData;
+        outData["result"] = "NOK";
+        outData["response"] = "Bad Request";
+        std::string tmpOut = outData.dump();
+        uint32_t tmpOutLg = tmpOut.size();
+        std::cout.write((char *)&tmpOutLg, 4);
+        std::cout << tmpOut;
+        return 0;
+    }
+    WebExtension::process_request(reader, status, std::cout);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include "Broker.h"
+
+TEST_CASE( "BrokerTests", "[success]" ) {
+
+    SECTION( "Relay a request to the broker" ) {
+        // Arrange
+        std::string pipeName = Broker::getPipeName() + ".test";
+        Broker broker(pipeName);
+        std::thread brokerThread([&broker] { broker.run(); });
+        nlohmann::json request;
+        request["request"] = "unknown_request";
+        request["request_id"] = "XH45E45MLk0";
+        std::string message = request.dump();
+        std::string response;
+
+        // Act
+        bool relayed = false;
+        for (int i = 0; (i < 50) && !relayed; i++) {
+            relayed = Broker::relay(message.data(), message.size(), response, pipeName);
+            if (!relayed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+
+        // Assert
+        REQUIRE( relayed );
+        uint32_t responseLg;
+        memcpy(&responseLg, response.data(), 4);
+        REQUIRE( responseLg == response.size() - 4 );
+        auto result = nlohmann::json::parse(response.substr(4));
+        REQUIRE( result["result"] == "NOK" );
+        REQUIRE( result["request_id"] == request["request_id"] );
+
+        // Cleanup
+        broker.stop();
+        brokerThread.join();
+    }
+
+    SECTION( "Relay without a broker" ) {
+        // Arrange
+        nlohmann::json request;
+        request["request"] = "unknown_request";
+        request["request_id"] = "XH45E45MLk0";
+        std::string message = request.dump();
+        std::string response;
+
+        // Act
+        bool relayed = Broker::relay(message.data(), message.size(), response, Broker::getPipeName() + ".none");
+
+        // Assert
+        REQUIRE_FALSE( relayed );
+    }
+}
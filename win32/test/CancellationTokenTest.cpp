@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <thread>
+#include "CancellationToken.h"
+
+TEST_CASE( "CancellationTokenTests", "[success]" ) {
+
+    SECTION( "Checkpoints outside a scope never throw" ) {
+        // Act
+        auto checkpoint = [] { CancellationToken::checkpoint(); };
+
+        // Assert
+        REQUIRE_NOTHROW( checkpoint() );
+        REQUIRE( CancellationToken::current() == nullptr );
+    }
+
+    SECTION( "Cancel a registered request" ) {
+        // Arrange
+        auto token = std::make_shared<CancellationToken>();
+        CancellationToken::Registration registration("client", "XH45E45MLk0", token);
+        CancellationToken::Scope scope(token);
+
+        // Act
+        bool cancelled = CancellationToken::cancel("client", "XH45E45MLk0");
+
+        // Assert
+        REQUIRE( cancelled );
+        REQUIRE( token->isCancelled() );
+        REQUIRE_THROWS_AS( CancellationToken::checkpoint(), OperationCancelled );
+    }
+
+    SECTION( "The scope only applies to its own thread" ) {
+        // Arrange
+        auto token = std::make_shared<CancellationToken>();
+        token->cancel();
+        CancellationToken::Scope scope(token);
+        bool otherThreadCancelled = true;
+
+        // Act
+        std::thread other([&otherThreadCancelled] {
+            otherThreadCancelled = (CancellationToken::current() != nullptr);
+        });
+        other.join();
+
+        // Assert
+        REQUIRE_FALSE( otherThreadCancelled );
+        REQUIRE( CancellationToken::current() == token );
+    }
+
+    SECTION( "The previous token is restored at the end of a scope" ) {
+        // Arrange
+        auto outer = std::make_shared<CancellationToken>();
+        auto inner = std::make_shared<CancellationToken>();
+        CancellationToken::Scope outerScope(outer);
+
+        // Act
+        {
+            CancellationToken::Scope innerScope(inner);
+            REQUIRE( CancellationToken::current() == inner );
+        }
+
+        // Assert
+        REQUIRE( CancellationToken::current() == outer );
+    }
+}
+
+TEST_CASE( "Failed CancellationTokenTests", "[failed]" ) {
+
+    SECTION( "Deadline exceeded" ) {
+        // Arrange
+        CancellationToken token(CancellationToken::Clock::now() - std::chrono::milliseconds(1));
+
+        // Act
+        bool cancelled = token.isCancelled();
+
+        // Assert
+        REQUIRE( cancelled );
+        REQUIRE_THROWS_AS( token.throwIfCancelled(), OperationCancelled );
+    }
+
+    SECTION( "Cancel a request which is not running" ) {
+        // Arrange
+        auto token = std::make_shared<CancellationToken>();
+        {
+            CancellationToken::Registration registration("client", "XH45E45MLk0", token);
+        }
+
+        // Act
+        bool cancelled = CancellationToken::cancel("client", "XH45E45MLk0");
+
+        // Assert
+        REQUIRE_FALSE( cancelled );
+        REQUIRE_FALSE( token->isCancelled() );
+    }
+
+    SECTION( "Cancel a request of another client" ) {
+        // Arrange
+        auto token = std::make_shared<CancellationToken>();
+        CancellationToken::Registration registration("client", "XH45E45MLk0", token);
+
+        // Act
+        bool cancelled = CancellationToken::cancel("other client", "XH45E45MLk0");
+
+        // Assert
+        REQUIRE_FALSE( cancelled );
+        REQUIRE_FALSE( token->isCancelled() );
+    }
+}
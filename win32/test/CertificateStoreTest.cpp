@@ -11,10 +11,16 @@
 #include <OpenSSLPKCS12.h>
 #include <locale>
 #include <codecvt>
+#include <thread>
+#include <set>
+#include <chrono>
 #include "CertificateStore.h"
+#include "CancellationToken.h"
+#include "KSException.h"
 #include "utils/KeyStoreUtil.h"
 #include "utils/CertStoreUtil.h"
 #include "Base64Utils.h"
+#include "Uuid.h"
 
 #define KEY_MGMGNT 0
 
@@ -82,6 +88,54 @@ TEST_CASE( "CertificateStoreTests", "[success]" ) {
         keyStoreUtil.deleteKeyFromKeyStore(certificateStore.getLastKeyId().c_str());
     }
 
+    SECTION("Create a batch of CSRs") {
+        // Arrange
+        KeyStoreUtil keyStoreUtil(MS_KEY_STORAGE_PROVIDER);
+        CertificateStore certificateStore;
+        std::vector<CertificateStore::RequestTemplate> templates = {
+                {"cn=John Doe Signing, o=Company, c=US", 2048},
+                {"cn=John Doe Encryption, o=Company, c=US", 2048},
+                {"cn=John Doe Authentication, o=Company, c=US", 3072}
+        };
+
+        // Act
+        auto csrs = certificateStore.createCertificateRequests(templates);
+
+        // Assert
+        REQUIRE(csrs.size() == 3);
+        for (auto &csr : csrs) {
+            OpenSSLCertificateRequest verifyCSR(csr.request);
+            REQUIRE(verifyCSR.verify());
+            std::wstring keyName(csr.keyName.begin(), csr.keyName.end());
+            REQUIRE(keyStoreUtil.isKeyInKeystore(keyName.c_str()));
+        }
+        REQUIRE(csrs[0].keyName != csrs[1].keyName);
+        REQUIRE(csrs[1].keyName != csrs[2].keyName);
+
+        // Cleanup
+        for (auto &csr : csrs) {
+            std::wstring keyName(csr.keyName.begin(), csr.keyName.end());
+            keyStoreUtil.deleteKeyFromKeyStore(keyName.c_str());
+        }
+    }
+
+    SECTION("A batch with an invalid subject name generates no keys") {
+        // Arrange
+        CertificateStore certificateStore;
+        auto keysBefore = certificateStore.listKeys(StoreIndex::KeyFilter(), std::string(), STORE_INDEX_MAX_PAGE_SIZE);
+        std::vector<CertificateStore::RequestTemplate> templates = {
+                {"cn=John Doe Signing, o=Company, c=US", 2048},
+                {"=John Doe", 2048}
+        };
+
+        // Act
+        REQUIRE_THROWS_AS(certificateStore.createCertificateRequests(templates), KSException);
+
+        // Assert
+        auto keysAfter = certificateStore.listKeys(StoreIndex::KeyFilter(), std::string(), STORE_INDEX_MAX_PAGE_SIZE);
+        REQUIRE(keysAfter.entries.size() == keysBefore.entries.size());
+    }
+
     SECTION("Import the certificate corresponding the CSR") {
         // Arrange
         CertStoreUtil certStoreUtil;
@@ -116,6 +170,55 @@ TEST_CASE( "CertificateStoreTests", "[success]" ) {
         certStoreUtil.deleteCertificates(L"John Doe");
     }
 
+    SECTION("Import a PEM bundle with the certificate and its CA") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        CertificateStore certificateStore;
+        auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+        OpenSSLCertificateRequest openSslCertificateRequest(csr);
+        OpenSSLCA openSslca("/CN=BundleCA", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        std::string bundle = cert->getPEM() + openSslca.getCertificate().getPEM();
+
+        // Act
+        REQUIRE_NOTHROW(certificateStore.importCertificate(bundle));
+
+        // Assert
+        certStoreUtil.reopen();
+        REQUIRE(certStoreUtil.hasCertificates(L"John Doe"));
+        REQUIRE(certStoreUtil.hasPrivateKey(L"John Doe"));
+        REQUIRE(!certStoreUtil.hasCertificates(L"BundleCA"));
+
+        // Cleanup
+        certStoreUtil.deleteCertificates(L"John Doe");
+    }
+
+    SECTION("A PEM bundle with a malformed certificate imports nothing") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        CertificateStore certificateStore;
+        auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+        OpenSSLCertificateRequest openSslCertificateRequest(csr);
+        OpenSSLCA openSslca("/CN=rootCA", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        std::string bundle = cert->getPEM() + "-----BEGIN CERTIFICATE-----\nTWFu\n-----END CERTIFICATE-----\n";
+
+        // Act
+        REQUIRE_THROWS(certificateStore.importCertificate(bundle));
+
+        // Assert
+        certStoreUtil.reopen();
+        REQUIRE(!certStoreUtil.hasCertificates(L"John Doe"));
+    }
+
     SECTION("Import a PKCS12 file") {
         // Arrange
         CertStoreUtil certStoreUtil;
@@ -157,6 +260,163 @@ TEST_CASE( "CertificateStoreTests", "[success]" ) {
         certStoreUtil.deleteCertificates(L"John Doe");
     }
 
+    SECTION("Import the same PKCS12 file twice") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        OpenSSLCertificateRequest openSslCertificateRequest(std::string("/CN=John Doe/O=Company/C=US"), 2048);
+        OpenSSLCA openSslca("/CN=RootCA/O=Company/C=US", 4096);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        OpenSSLPKCS12 openSslpkcs12(*(cert.get()),
+                                    openSslca.getCertificate(),
+                                    openSslCertificateRequest.getKeyPair(),
+                                    std::string("system"));
+        auto b64pkcs12 = Base64Utils::toBase64(openSslpkcs12.getPKCS12());
+        CertificateStore certificateStore;
+        REQUIRE_NOTHROW(certificateStore.pfxImport(b64pkcs12, L"system"));
+
+        // Act
+        REQUIRE_NOTHROW(certificateStore.pfxImport(b64pkcs12, L"system"));
+
+        // Assert
+        certStoreUtil.reopen();
+        REQUIRE(certStoreUtil.hasCertificates(L"John Doe"));
+        REQUIRE(certStoreUtil.hasPrivateKey(L"John Doe"));
+
+        // Cleanup
+        certStoreUtil.deleteCertificates(L"John Doe");
+    }
+
+    SECTION("A cancelled PKCS12 import leaves no keys behind") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        OpenSSLCertificateRequest openSslCertificateRequest(std::string("/CN=John Doe/O=Company/C=US"), 2048);
+        OpenSSLCA openSslca("/CN=RootCA/O=Company/C=US", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        OpenSSLPKCS12 openSslpkcs12(*(cert.get()),
+                                    openSslca.getCertificate(),
+                                    openSslCertificateRequest.getKeyPair(),
+                                    std::string("system"));
+        auto b64pkcs12 = Base64Utils::toBase64(openSslpkcs12.getPKCS12());
+        CertificateStore certificateStore;
+        KeyStore keyStore(MS_KEY_STORAGE_PROVIDER);
+        auto keysBefore = keyStore.listKeys();
+        std::set<std::pair<std::wstring, std::wstring>> before(keysBefore.begin(), keysBefore.end());
+
+        // Act
+        // The deadline passes somewhere in the import, a later deadline lets the import finish
+        size_t cancelled = 0;
+        for (int delay = 0; delay <= 200; delay += 5) {
+            auto token = std::make_shared<CancellationToken>(CancellationToken::Clock::now() +
+                                                             std::chrono::milliseconds(delay));
+            CancellationToken::Scope scope(token);
+            try {
+                certificateStore.pfxImport(b64pkcs12, L"system");
+                break;
+            }
+            catch (const OperationCancelled &) {
+                cancelled++;
+            }
+        }
+
+        // Assert
+        REQUIRE(cancelled > 0);
+        certStoreUtil.reopen();
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        auto keysAfter = keyStore.listKeys();
+        std::set<std::pair<std::wstring, std::wstring>> after(keysAfter.begin(), keysAfter.end());
+        REQUIRE(after == before);
+    }
+
+    SECTION("Import a PKCS12 file with enough certificates to classify them in parallel") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"Jane Doe")) {
+            certStoreUtil.deleteCertificates(L"Jane Doe");
+        }
+        certStoreUtil.close();
+        OpenSSLCertificateRequest openSslCertificateRequest(std::string("/CN=Jane Doe/O=Company/C=US"), 2048);
+        OpenSSLCA openSslca("/CN=RootCA/O=Company/C=US", 2048);
+        // 2 workers or more, with at least 33 certificates each (PFX_PARALLEL_IMPORT_THRESHOLD is 32)
+        const size_t certificateCount = 65;
+        HCERTSTORE memoryStore = CertOpenStore(CERT_STORE_PROV_MEMORY, 0, 0, 0, nullptr);
+        REQUIRE(memoryStore != nullptr);
+        for (size_t i = 0; i < certificateCount; i++) {
+            auto pem = openSslca.certify(openSslCertificateRequest)->getPEM();
+            DWORD derLg = 0;
+            REQUIRE(CryptStringToBinaryA(pem.c_str(), (DWORD)pem.size(), CRYPT_STRING_BASE64HEADER,
+                                         nullptr, &derLg, nullptr, nullptr));
+            std::vector<BYTE> der(derLg);
+            REQUIRE(CryptStringToBinaryA(pem.c_str(), (DWORD)pem.size(), CRYPT_STRING_BASE64HEADER,
+                                         der.data(), &derLg, nullptr, nullptr));
+            REQUIRE(CertAddEncodedCertificateToStore(memoryStore, X509_ASN_ENCODING, der.data(), derLg,
+                                                     CERT_STORE_ADD_ALWAYS, nullptr));
+        }
+        CRYPT_DATA_BLOB pfx{0, nullptr};
+        REQUIRE(PFXExportCertStoreEx(memoryStore, &pfx, L"system", nullptr, 0));
+        std::vector<unsigned char> pfxData(pfx.cbData);
+        pfx.pbData = pfxData.data();
+        REQUIRE(PFXExportCertStoreEx(memoryStore, &pfx, L"system", nullptr, 0));
+        CertCloseStore(memoryStore, 0);
+        auto b64pkcs12 = Base64Utils::toBase64(pfxData);
+        CertificateStore certificateStore;
+        if (std::thread::hardware_concurrency() < 2) {
+            WARN("Single core: the certificates are classified without workers");
+        }
+
+        // Act
+        REQUIRE_NOTHROW(certificateStore.pfxImport(b64pkcs12, L"system"));
+
+        // Assert
+        StoreIndex::CertificateFilter filter;
+        filter.subject = "Jane Doe";
+        auto page = certificateStore.listCertificates(filter, "", 100);
+        REQUIRE(page.entries.size() == certificateCount);
+
+        // Cleanup
+        certStoreUtil.reopen();
+        certStoreUtil.deleteCertificates(L"Jane Doe");
+    }
+
+    SECTION("Get the chain of an imported PKCS12 file") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        OpenSSLCertificateRequest openSslCertificateRequest(std::string("/CN=John Doe/O=Company/C=US"), 2048);
+        OpenSSLCA openSslca("/CN=RootCA/O=Company/C=US", 4096);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        OpenSSLPKCS12 openSslpkcs12(*(cert.get()),
+                                    openSslca.getCertificate(),
+                                    openSslCertificateRequest.getKeyPair(),
+                                    std::string("system"));
+        auto b64pkcs12 = Base64Utils::toBase64(openSslpkcs12.getPKCS12());
+        CertificateStore certificateStore;
+        REQUIRE_NOTHROW(certificateStore.pfxImport(b64pkcs12, L"system"));
+
+        // Act
+        std::vector<std::vector<unsigned char>> chain;
+        REQUIRE_NOTHROW(chain = certificateStore.getChain(std::string("cn=RootCA,o=Company,c=US"), std::string("03")));
+
+        // Assert
+        REQUIRE(chain.size() == 2);
+
+        // Cleanup
+        certStoreUtil.reopen();
+        certStoreUtil.deleteCertificates(L"John Doe");
+    }
+
     SECTION("Export to a PKCS12 file") {
         // Arrange
         {
@@ -197,6 +457,167 @@ TEST_CASE( "CertificateStoreTests", "[success]" ) {
     }
 }
 
+TEST_CASE( "CertificateStoreTests PFX encryption", "[success]" ) {
+
+    SECTION("Export to a PKCS12 file protected with AES256") {
+        // Arrange
+        {
+            CertStoreUtil certStoreUtil;
+            if (certStoreUtil.hasCertificates(L"John Doe")) {
+                certStoreUtil.deleteCertificates(L"John Doe");
+            }
+            certStoreUtil.close();
+            CertificateStore certificateStore;
+            auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+            OpenSSLCertificateRequest openSslCertificateRequest(csr);
+            OpenSSLCA openSslca("/CN=RootCA", 2048);
+            auto cert = openSslca.certify(openSslCertificateRequest);
+            REQUIRE_NOTHROW(certificateStore.importCertificate(cert->getPEM()));
+        }
+
+        // Act
+        std::string p12;
+        {
+            CertificateStore certificateStore;
+            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+            REQUIRE_NOTHROW(p12 = certificateStore.pfxExport(std::string("cn=RootCA"), std::string("03"),
+                                                             converter.from_bytes("system"),
+                                                             CertificateStore::pfxEncryption::AES256_SHA256));
+        }
+
+        // Assert
+        auto p12Data = Base64Utils::fromBase64(p12);
+        OpenSSLPKCS12 openSslpkcs12(p12Data.data(), p12Data.size(), "system");
+        REQUIRE(openSslpkcs12.getCertificate().getCommonName() == "John Doe");
+        REQUIRE(openSslpkcs12.getPrivateKey().getKeyBitlength() == 2048);
+
+        // Cleanup
+        {
+            CertStoreUtil certStoreUtil;
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+    }
+}
+
+TEST_CASE( "CertificateStoreTests PKCS8", "[success]" ) {
+
+    SECTION("Export a key as encrypted PKCS8 and import it with its certificate") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        CertificateStore certificateStore;
+        auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+        OpenSSLCertificateRequest openSslCertificateRequest(csr);
+        OpenSSLCA openSslca("/CN=RootCA", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        std::string pem = cert->getPEM();
+        REQUIRE_NOTHROW(certificateStore.importCertificate(pem));
+        CertificateStore::ExportedKey exported;
+        REQUIRE_NOTHROW(exported = certificateStore.exportPkcs8(std::string("cn=RootCA"), std::string("03"),
+                                                                L"system", PKCS8_MIN_ITERATIONS));
+        certStoreUtil.reopen();
+        certStoreUtil.deleteCertificates(L"John Doe");
+
+        // Act
+        std::string keyId;
+        {
+            CertificateStore importStore;
+            REQUIRE_NOTHROW(keyId = importStore.importPkcs8(exported.pkcs8.data(), exported.pkcs8.size(), L"system",
+                                                            pem.data(), pem.size()));
+        }
+
+        // Assert
+        auto encryptedKey = Pkcs8::decode(exported.pkcs8.data(), exported.pkcs8.size());
+        REQUIRE(encryptedKey.encryption.scheme == Pkcs8::encryptionScheme::Pbes2);
+        REQUIRE(encryptedKey.encryption.iterations == PKCS8_MIN_ITERATIONS);
+        REQUIRE(keyId.size() == UUID_STRING_LENGTH);
+        certStoreUtil.reopen();
+        REQUIRE(certStoreUtil.hasCertificates(L"John Doe"));
+        REQUIRE(certStoreUtil.hasPrivateKey(L"John Doe"));
+
+        // Cleanup
+        certStoreUtil.deleteCertificates(L"John Doe");
+    }
+
+    SECTION("Import a PKCS8 key with its certificate in a PKCS7 block") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        CertificateStore certificateStore;
+        auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+        OpenSSLCertificateRequest openSslCertificateRequest(csr);
+        OpenSSLCA openSslca("/CN=RootCA", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        REQUIRE_NOTHROW(certificateStore.importCertificate(cert->getPEM()));
+        auto exported = certificateStore.exportPkcs8(std::string("cn=RootCA"), std::string("03"),
+                                                     L"system", PKCS8_MIN_ITERATIONS);
+        certStoreUtil.reopen();
+        certStoreUtil.deleteCertificates(L"John Doe");
+        HCERTSTORE memoryStore = CertOpenStore(CERT_STORE_PROV_MEMORY, 0, 0, 0, nullptr);
+        REQUIRE(memoryStore != nullptr);
+        REQUIRE(CertAddEncodedCertificateToStore(memoryStore, X509_ASN_ENCODING, exported.certificate.data(),
+                                                 (DWORD)exported.certificate.size(), CERT_STORE_ADD_ALWAYS, nullptr));
+        CRYPT_DATA_BLOB pkcs7{0, nullptr};
+        REQUIRE(CertSaveStore(memoryStore, X509_ASN_ENCODING | PKCS_7_ASN_ENCODING, CERT_STORE_SAVE_AS_PKCS7,
+                              CERT_STORE_SAVE_TO_MEMORY, &pkcs7, 0));
+        std::vector<unsigned char> pkcs7Data(pkcs7.cbData);
+        pkcs7.pbData = pkcs7Data.data();
+        REQUIRE(CertSaveStore(memoryStore, X509_ASN_ENCODING | PKCS_7_ASN_ENCODING, CERT_STORE_SAVE_AS_PKCS7,
+                              CERT_STORE_SAVE_TO_MEMORY, &pkcs7, 0));
+        CertCloseStore(memoryStore, 0);
+        std::string pem = "-----BEGIN PKCS7-----\n" + Base64Utils::toBase64(pkcs7Data) + "\n-----END PKCS7-----\n";
+
+        // Act
+        {
+            CertificateStore importStore;
+            REQUIRE_NOTHROW(importStore.importPkcs8(exported.pkcs8.data(), exported.pkcs8.size(), L"system",
+                                                    pem.data(), pem.size()));
+        }
+
+        // Assert
+        certStoreUtil.reopen();
+        REQUIRE(certStoreUtil.hasCertificates(L"John Doe"));
+        REQUIRE(certStoreUtil.hasPrivateKey(L"John Doe"));
+
+        // Cleanup
+        certStoreUtil.deleteCertificates(L"John Doe");
+    }
+
+    SECTION("A PKCS8 key with the wrong password imports nothing") {
+        // Arrange
+        CertStoreUtil certStoreUtil;
+        if (certStoreUtil.hasCertificates(L"John Doe")) {
+            certStoreUtil.deleteCertificates(L"John Doe");
+        }
+        certStoreUtil.close();
+        CertificateStore certificateStore;
+        auto csr = certificateStore.createCertificateRequest(std::string("cn=John Doe, o=Company, c=US"), 2048);
+        OpenSSLCertificateRequest openSslCertificateRequest(csr);
+        OpenSSLCA openSslca("/CN=RootCA", 2048);
+        auto cert = openSslca.certify(openSslCertificateRequest);
+        std::string pem = cert->getPEM();
+        REQUIRE_NOTHROW(certificateStore.importCertificate(pem));
+        auto exported = certificateStore.exportPkcs8(std::string("cn=RootCA"), std::string("03"),
+                                                     L"system", PKCS8_MIN_ITERATIONS);
+        certStoreUtil.reopen();
+        certStoreUtil.deleteCertificates(L"John Doe");
+
+        // Act
+        REQUIRE_THROWS(certificateStore.importPkcs8(exported.pkcs8.data(), exported.pkcs8.size(), L"wrong",
+                                                    pem.data(), pem.size()));
+
+        // Assert
+        certStoreUtil.reopen();
+        REQUIRE(!certStoreUtil.hasCertificates(L"John Doe"));
+    }
+}
+
 /*
  * User Interfase testing
  */
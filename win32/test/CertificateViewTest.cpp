@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include "CertificateView.h"
+#include "utils/TestCertificates.h"
+
+TEST_CASE( "CertificateViewTests", "[success]" ) {
+
+    SECTION( "Parse an end entity certificate" ) {
+        // Arrange
+        const unsigned char serial[] = { 0x07, 0x63 };
+        const unsigned char ski[] = { 0xBB, 0x80, 0xF5, 0x5F, 0x4A, 0xB0, 0xD5, 0xEE, 0xAD, 0x2D,
+                                      0x29, 0xE5, 0x74, 0x83, 0x02, 0x23, 0xAB, 0x45, 0x51, 0xC7 };
+        const unsigned char aki[] = { 0x80, 0x7A, 0x9B, 0x6B, 0xD9, 0xAA, 0xA4, 0x8A, 0x2C, 0xF2,
+                                      0x04, 0x96, 0xE7, 0x33, 0x10, 0xFC, 0x44, 0x97, 0x35, 0xBF };
+
+        // Act
+        CertificateView view(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Assert
+        REQUIRE( view.getVersion() == 3 );
+        REQUIRE( view.getEncoded().size == sizeof(TestCertificates::johnDoe) );
+        REQUIRE( view.getSerialNumber() == DerBlob{ serial, sizeof(serial) } );
+        REQUIRE( view.getNotBefore() == 1792324653 );
+        REQUIRE( view.getNotAfter() == 1823860653 );
+        REQUIRE( view.getExtensions().size() == 4 );
+        REQUIRE_FALSE( view.isCA() );
+        REQUIRE( view.hasKeyUsage() );
+        REQUIRE( view.getKeyUsage() == (KU_DIGITAL_SIGNATURE | KU_KEY_ENCIPHERMENT) );
+        REQUIRE( view.getSubjectKeyIdentifier() == DerBlob{ ski, sizeof(ski) } );
+        REQUIRE( view.getAuthorityKeyIdentifier() == DerBlob{ aki, sizeof(aki) } );
+    }
+
+    SECTION( "Parse a CA certificate" ) {
+        // Arrange
+        CertificateView issuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+
+        // Act
+        CertificateView view(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Assert
+        REQUIRE( issuer.isCA() );
+        REQUIRE( issuer.getPathLength() == 1 );
+        REQUIRE( issuer.getKeyUsage() == (KU_KEY_CERT_SIGN | KU_CRL_SIGN) );
+        REQUIRE( issuer.getSubject() == issuer.getIssuer() );
+        REQUIRE( issuer.getSubject() == view.getIssuer() );
+        REQUIRE( issuer.getSubjectKeyIdentifier() == view.getAuthorityKeyIdentifier() );
+    }
+}
+
+TEST_CASE( "Failed CertificateViewTests", "[failed]" ) {
+
+    SECTION( "Truncated certificates are rejected" ) {
+        for (size_t size = 0; size < sizeof(TestCertificates::johnDoe); size++) {
+            REQUIRE_THROWS_AS(CertificateView(TestCertificates::johnDoe, size), std::invalid_argument);
+        }
+    }
+
+    SECTION( "Trailing data is rejected" ) {
+        // Arrange
+        std::vector<unsigned char> data(TestCertificates::johnDoe,
+                                        TestCertificates::johnDoe + sizeof(TestCertificates::johnDoe));
+        data.push_back(0x00);
+
+        // Act && Assert
+        REQUIRE_THROWS_AS(CertificateView(data.data(), data.size()), std::invalid_argument);
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include "ChainBuilder.h"
+#include "utils/TestCertificates.h"
+
+TEST_CASE( "ChainBuilderTests", "[success]" ) {
+
+    SECTION( "Build the chain of an end entity certificate" ) {
+        // Arrange
+        ChainBuilder chainBuilder;
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Act
+        REQUIRE( chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA)) );
+        auto chain = chainBuilder.getChain(certificate);
+
+        // Assert
+        REQUIRE( chain->complete );
+        REQUIRE( chain->issuers.size() == 1 );
+        REQUIRE( chain->issuers[0]->getEncoded().size == sizeof(TestCertificates::rootCA) );
+        REQUIRE( chainBuilder.getChain(certificate) == chain );
+    }
+
+    SECTION( "End entity certificates are not indexed" ) {
+        // Arrange
+        ChainBuilder chainBuilder;
+
+        // Act
+        bool added = chainBuilder.addIssuer(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Assert
+        REQUIRE_FALSE( added );
+        REQUIRE( chainBuilder.size() == 0 );
+    }
+
+    SECTION( "Adding an issuer invalidates incomplete chains" ) {
+        // Arrange
+        ChainBuilder chainBuilder;
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        auto incomplete = chainBuilder.getChain(certificate);
+
+        // Act
+        chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+        auto chain = chainBuilder.getChain(certificate);
+
+        // Assert
+        REQUIRE_FALSE( incomplete->complete );
+        REQUIRE( incomplete->issuers.empty() );
+        REQUIRE( chain->complete );
+    }
+
+    SECTION( "Chains stay valid after the index is cleared" ) {
+        // Arrange
+        ChainBuilder chainBuilder;
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+        auto chain = chainBuilder.getChain(certificate);
+
+        // Act
+        chainBuilder.clear();
+
+        // Assert
+        REQUIRE( chainBuilder.size() == 0 );
+        REQUIRE( chain->issuers[0]->isCA() );
+        REQUIRE( chain->issuers[0]->getSubject() == certificate.getIssuer() );
+    }
+
+    SECTION( "Only the most recently used chains are cached" ) {
+        // Arrange
+        ChainBuilder chainBuilder(nullptr, 1);
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        CertificateView rootCA(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+        chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+        auto chain = chainBuilder.getChain(certificate);
+
+        // Act
+        chainBuilder.getChain(rootCA);
+        auto rebuilt = chainBuilder.getChain(certificate);
+
+        // Assert
+        REQUIRE( rebuilt != chain );
+        REQUIRE( rebuilt->complete );
+        REQUIRE( chainBuilder.getChain(certificate) == rebuilt );
+    }
+}
+
+TEST_CASE( "Failed ChainBuilderTests", "[failed]" ) {
+
+    SECTION( "Issuers with a bad signature are skipped" ) {
+        // Arrange
+        ChainBuilder chainBuilder([](const CertificateView &, const CertificateView &) { return false; });
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+
+        // Act
+        auto chain = chainBuilder.getChain(certificate);
+
+        // Assert
+        REQUIRE_FALSE( chain->complete );
+        REQUIRE( chain->issuers.empty() );
+    }
+
+    SECTION( "A forged certificate with the same issuer and serial number does not share the chain" ) {
+        // Arrange
+        std::vector<unsigned char> forged(TestCertificates::johnDoe,
+                                          TestCertificates::johnDoe + sizeof(TestCertificates::johnDoe));
+        // Last byte of the signature
+        forged.back() ^= 0x01;
+        CertificateView forgedCertificate(forged.data(), forged.size());
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        ChainBuilder chainBuilder([&forged](const CertificateView &certificate, const CertificateView &) {
+            return !(certificate.getEncoded() == DerBlob{forged.data(), forged.size()});
+        });
+        chainBuilder.addIssuer(TestCertificates::rootCA, sizeof(TestCertificates::rootCA));
+
+        // Act
+        auto chain = chainBuilder.getChain(certificate);
+        auto forgedChain = chainBuilder.getChain(forgedCertificate);
+
+        // Assert
+        REQUIRE( forgedCertificate.getIssuer() == certificate.getIssuer() );
+        REQUIRE( forgedCertificate.getSerialNumber() == certificate.getSerialNumber() );
+        REQUIRE( chain->complete );
+        REQUIRE_FALSE( forgedChain->complete );
+        REQUIRE( forgedChain->issuers.empty() );
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <string>
+#include "Digest.h"
+#include "utils/HexUtils.hpp"
+
+static std::string toHex(const std::string &digest) {
+    return HexUtils::binToHex(reinterpret_cast<unsigned char *>(const_cast<char *>(digest.data())), digest.size());
+}
+
+static std::string hash(Digest::hashAlgorithm algorithm, const char *message) {
+    return Digest::hash(algorithm, reinterpret_cast<const unsigned char *>(message), strlen(message));
+}
+
+TEST_CASE( "DigestTests", "[success]" ) {
+
+    SECTION( "Known SHA-1 digests" ) {
+        // Act && Assert
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha1, "")) == "da39a3ee5e6b4b0d3255bfef95601890afd80709" );
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha1, "abc")) == "a9993e364706816aba3e25717850c26c9cd0d89d" );
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha1,
+                            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+                 "84983e441c3bd26ebaae4aa1f95129e5e54670f1" );
+    }
+
+    SECTION( "Known SHA-256 digests" ) {
+        // Act && Assert
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha256, "")) ==
+                 "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha256, "abc")) ==
+                 "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+        REQUIRE( toHex(hash(Digest::hashAlgorithm::Sha256,
+                            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+                 "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+    }
+
+    SECTION( "A digest is started again after it is finished" ) {
+        // Arrange
+        Digest digest(Digest::hashAlgorithm::Sha256);
+        std::string first(digest.getSize(), '\0');
+        std::string second(digest.getSize(), '\0');
+
+        // Act
+        digest.update(reinterpret_cast<const unsigned char *>("a"), 1);
+        digest.update(reinterpret_cast<const unsigned char *>("bc"), 2);
+        digest.finish(reinterpret_cast<unsigned char *>(&first[0]), first.size());
+        digest.update(reinterpret_cast<const unsigned char *>("abc"), 3);
+        digest.finish(reinterpret_cast<unsigned char *>(&second[0]), second.size());
+
+        // Assert
+        REQUIRE( digest.getSize() == 32 );
+        REQUIRE( toHex(first) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+        REQUIRE( second == first );
+    }
+}
+
+TEST_CASE( "Failed DigestTests", "[failed]" ) {
+
+    SECTION( "Result buffer smaller than the digest" ) {
+        // Arrange
+        Digest digest(Digest::hashAlgorithm::Sha1);
+        unsigned char result[16];
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( digest.finish(result, sizeof(result)), std::invalid_argument );
+    }
+}
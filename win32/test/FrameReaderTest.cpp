@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include "FrameReader.h"
+
+static std::string createFrame(const std::string &message) {
+    uint32_t messageLg = (uint32_t)message.size();
+    return std::string((char *)&messageLg, 4) + message;
+}
+
+static std::string createHeader(uint32_t messageLg) {
+    return std::string((char *)&messageLg, 4);
+}
+
+TEST_CASE( "FrameReaderTests", "[success]" ) {
+
+    SECTION( "Read consecutive frames" ) {
+        // Arrange
+        std::istringstream in(createFrame(R"({"request": "get_metrics"})") + createFrame("{}"));
+        FrameReader reader(in);
+
+        // Act
+        auto firstStatus = reader.read();
+        std::string first(reader.data(), reader.size());
+        auto secondStatus = reader.read();
+        std::string second(reader.data(), reader.size());
+        auto endStatus = reader.read();
+
+        // Assert
+        REQUIRE( firstStatus == FrameReader::frameStatus::Ok );
+        REQUIRE( first == R"({"request": "get_metrics"})" );
+        REQUIRE( secondStatus == FrameReader::frameStatus::Ok );
+        REQUIRE( second == "{}" );
+        REQUIRE( endStatus == FrameReader::frameStatus::End );
+    }
+
+    SECTION( "Empty frame" ) {
+        // Arrange
+        std::istringstream in(createFrame(""));
+        FrameReader reader(in);
+
+        // Act
+        auto status = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Ok );
+        REQUIRE( reader.size() == 0 );
+        REQUIRE( reader.getFrameLength() == 0 );
+    }
+
+    SECTION( "Frame of the maximum size" ) {
+        // Arrange
+        std::istringstream in(createFrame(std::string(64, 'a')));
+        FrameReader reader(in, 64);
+
+        // Act
+        auto status = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Ok );
+        REQUIRE( reader.size() == 64 );
+    }
+
+    SECTION( "Buffer stays below the largest accepted frame" ) {
+        // Arrange
+        std::string input;
+        for (size_t i = 0; i < 100; i++) {
+            input += createFrame(std::string(i * 100, 'x'));
+        }
+        input += createFrame(std::string(FRAME_READER_MAX_FRAME + 1, 'y'));
+        input += createFrame("{}");
+        std::istringstream in(input);
+        FrameReader reader(in);
+
+        // Act
+        size_t highWater = 0;
+        size_t frames = 0;
+        FrameReader::frameStatus status;
+        while ((status = reader.read()) == FrameReader::frameStatus::Ok) {
+            highWater = (std::max)(highWater, reader.capacity());
+            frames++;
+        }
+        auto afterOversized = reader.read();
+        highWater = (std::max)(highWater, reader.capacity());
+
+        // Assert
+        REQUIRE( frames == 100 );
+        REQUIRE( status == FrameReader::frameStatus::Oversized );
+        REQUIRE( reader.getFrameLength() == 2 );
+        REQUIRE( afterOversized == FrameReader::frameStatus::Ok );
+        REQUIRE( highWater >= 9900 );
+        REQUIRE( highWater <= FRAME_READER_MAX_FRAME );
+    }
+
+    SECTION( "Read a frame in place" ) {
+        // Arrange
+        std::string frame = createFrame(R"({"password": "system"})");
+        FrameBuffer buffer(&frame[0], frame.size());
+        std::istream in(&buffer);
+        FrameReader reader(in);
+
+        // Act
+        auto status = reader.read();
+        std::string message(reader.data(), reader.size());
+        auto endStatus = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Ok );
+        REQUIRE( message == R"({"password": "system"})" );
+        REQUIRE( endStatus == FrameReader::frameStatus::End );
+    }
+}
+
+TEST_CASE( "Failed FrameReaderTests", "[failed]" ) {
+
+    SECTION( "Oversized frame is skipped without buffering it" ) {
+        // Arrange
+        std::istringstream in(createFrame(std::string(65, 'a')) + createFrame("{}"));
+        FrameReader reader(in, 64);
+
+        // Act
+        auto oversizedStatus = reader.read();
+        size_t oversizedCapacity = reader.capacity();
+        uint32_t oversizedLg = reader.getFrameLength();
+        auto nextStatus = reader.read();
+        std::string next(reader.data(), reader.size());
+
+        // Assert
+        REQUIRE( oversizedStatus == FrameReader::frameStatus::Oversized );
+        REQUIRE( oversizedCapacity == 0 );
+        REQUIRE( oversizedLg == 65 );
+        REQUIRE( nextStatus == FrameReader::frameStatus::Ok );
+        REQUIRE( next == "{}" );
+    }
+
+    SECTION( "Hostile length is rejected before reading" ) {
+        // Arrange
+        std::istringstream in(createHeader(0xFFFFFFFF));
+        FrameReader reader(in);
+
+        // Act
+        auto status = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Oversized );
+        REQUIRE( reader.capacity() == 0 );
+        REQUIRE( reader.read() == FrameReader::frameStatus::End );
+    }
+
+    SECTION( "Truncated length" ) {
+        // Arrange
+        std::istringstream in(createHeader(10).substr(0, 3));
+        FrameReader reader(in);
+
+        // Act
+        auto status = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Truncated );
+    }
+
+    SECTION( "Truncated message" ) {
+        // Arrange
+        std::istringstream in(createFrame(R"({"request": "get_metrics"})").substr(0, 12));
+        FrameReader reader(in);
+
+        // Act
+        auto status = reader.read();
+
+        // Assert
+        REQUIRE( status == FrameReader::frameStatus::Truncated );
+        REQUIRE( reader.size() == 0 );
+        REQUIRE( reader.read() == FrameReader::frameStatus::End );
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <string>
+#include "KSStatus.h"
+#include "KSException.h"
+using Catch::Matchers::Message;
+
+TEST_CASE( "KSStatusTests", "[success]" ) {
+
+    SECTION( "Default status is success" ) {
+        // Arrange
+        KSStatus status;
+
+        // Act
+        std::string message = status.message();
+
+        // Assert
+        REQUIRE( status.ok() );
+        REQUIRE( status.code() == 0 );
+        REQUIRE( message.empty() );
+    }
+
+    SECTION( "Application error message" ) {
+        // Arrange
+        KSStatus status("checkParameters", 42, "Missing Parameters");
+
+        // Act
+        std::string message = status.message();
+
+        // Assert
+        REQUIRE( !status.ok() );
+        REQUIRE( status.code() == KSSTATUS_APPLICATION_ERROR );
+        REQUIRE( message == "checkParameters(42) : Missing Parameters" );
+    }
+
+    SECTION( "System error message" ) {
+        // Arrange
+        KSStatus status("open", 7, (DWORD)ERROR_FILE_NOT_FOUND);
+
+        // Act
+        std::string message = status.message();
+
+        // Assert
+        REQUIRE( !status.ok() );
+        REQUIRE( status.code() == ERROR_FILE_NOT_FOUND );
+        REQUIRE( message.find("open(7) : error(2) : ") == 0 );
+    }
+
+    SECTION( "Exception from a status" ) {
+        // Arrange
+        KSStatus status("checkParameters", 42, "Missing Parameters");
+
+        // Act
+        KSException exception(status);
+
+        // Assert
+        REQUIRE( exception.status().code() == KSSTATUS_APPLICATION_ERROR );
+        REQUIRE( std::string(exception.what()) == "checkParameters(42) : Missing Parameters" );
+    }
+}
+
+TEST_CASE( "Failed KSStatusTests", "[failed]" ) {
+
+    SECTION( "Throw a status as exception" ) {
+        // Arrange
+        KSStatus status("checkParameters", 42, "Missing Parameters");
+
+        // Act && Assert
+        REQUIRE_THROWS_MATCHES( throw KSException(status),
+                                KSException,
+                                Message("checkParameters(42) : Missing Parameters") );
+    }
+}
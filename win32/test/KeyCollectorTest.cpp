@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <map>
+#include <stdexcept>
+#include "KeyCollector.h"
+#include "Metrics.h"
+
+/**
+ * Key store in memory
+ */
+class MemoryKeyBackend : public KeyCollector::Backend {
+public:
+    std::vector<KeyCollector::Key> listHostKeys() override {
+        std::vector<KeyCollector::Key> keys;
+        for (auto &key : hostKeys) {
+            keys.push_back(KeyCollector::Key{key.first, key.second});
+        }
+        return keys;
+    }
+
+    std::set<std::wstring> listLinkedKeys() override {
+        auto linked = linkedKeys;
+        // Certificates imported after the scan
+        linkedKeys.insert(linkedAfterScan.begin(), linkedAfterScan.end());
+        return linked;
+    }
+
+    bool deleteOrphanKey(const std::wstring &name) override {
+        if (lockedKeys.count(name)) {
+            throw std::runtime_error("key in use");
+        }
+        if (linkedKeys.count(name)) {
+            return false;
+        }
+        hostKeys.erase(name);
+        return true;
+    }
+
+    std::map<std::wstring, time_t> hostKeys;
+    std::set<std::wstring> linkedKeys;
+    std::set<std::wstring> linkedAfterScan;
+    std::set<std::wstring> lockedKeys;
+};
+
+TEST_CASE( "KeyCollectorTests", "[success]" ) {
+
+    SECTION( "Delete old keys without a certificate" ) {
+        // Arrange
+        MemoryKeyBackend backend;
+        time_t now = 1800000000;
+        backend.hostKeys[L"old-orphan"] = now - 3600;
+        backend.hostKeys[L"old-linked"] = now - 3600;
+        backend.hostKeys[L"new-orphan"] = now - 60;
+        backend.linkedKeys.insert(L"old-linked");
+        KeyCollector collector(backend, std::chrono::seconds(600), 16, std::chrono::milliseconds(0));
+
+        // Act
+        size_t deleted = collector.collect(now);
+
+        // Assert
+        REQUIRE( deleted == 1 );
+        REQUIRE( backend.hostKeys.count(L"old-orphan") == 0 );
+        REQUIRE( backend.hostKeys.count(L"old-linked") == 1 );
+        REQUIRE( backend.hostKeys.count(L"new-orphan") == 1 );
+        REQUIRE( Metrics::GetInstance().getCounters()["gc.host_keys"] == 2 );
+    }
+
+    SECTION( "Delete in batches" ) {
+        // Arrange
+        MemoryKeyBackend backend;
+        time_t now = 1800000000;
+        for (int i = 0; i < 10; i++) {
+            backend.hostKeys[L"orphan-" + std::to_wstring(i)] = now - 3600;
+        }
+        KeyCollector collector(backend, std::chrono::seconds(600), 3, std::chrono::milliseconds(1));
+
+        // Act
+        size_t deleted = collector.collect(now);
+
+        // Assert
+        REQUIRE( deleted == 10 );
+        REQUIRE( backend.hostKeys.empty() );
+    }
+
+    SECTION( "Keys linked after the scan are kept" ) {
+        // Arrange
+        MemoryKeyBackend backend;
+        time_t now = 1800000000;
+        backend.hostKeys[L"orphan"] = now - 3600;
+        backend.hostKeys[L"imported"] = now - 3600;
+        backend.linkedAfterScan.insert(L"imported");
+        KeyCollector collector(backend, std::chrono::seconds(600), 16, std::chrono::milliseconds(0));
+
+        // Act
+        size_t deleted = collector.collect(now);
+
+        // Assert
+        REQUIRE( deleted == 1 );
+        REQUIRE( backend.hostKeys.count(L"orphan") == 0 );
+        REQUIRE( backend.hostKeys.count(L"imported") == 1 );
+        REQUIRE( Metrics::GetInstance().getCounters()["gc.orphans"] == 1 );
+    }
+}
+
+TEST_CASE( "Failed KeyCollectorTests", "[failed]" ) {
+
+    SECTION( "Keys which can not be deleted are skipped" ) {
+        // Arrange
+        MemoryKeyBackend backend;
+        time_t now = 1800000000;
+        backend.hostKeys[L"locked"] = now - 3600;
+        backend.hostKeys[L"orphan"] = now - 3600;
+        backend.lockedKeys.insert(L"locked");
+        KeyCollector collector(backend, std::chrono::seconds(600), 16, std::chrono::milliseconds(0));
+
+        // Act
+        size_t deleted = collector.collect(now);
+
+        // Assert
+        REQUIRE( deleted == 1 );
+        REQUIRE( backend.hostKeys.count(L"locked") == 1 );
+    }
+}
@@ -3,9 +3,32 @@
  * Author: David Tillemans
  */
 #include <catch2/catch.hpp>
+#include <string>
+#include <vector>
 #include "KeyStore.h"
+#include "utils/HexUtils.hpp"
 #include "utils/KeyStoreUtil.h"
 
+static std::vector<unsigned char> fromHex(const char *hex) {
+    std::string data = HexUtils::hexToBin(const_cast<char *>(hex)).str();
+    return std::vector<unsigned char>(data.begin(), data.end());
+}
+
+static std::string toHex(const std::vector<unsigned char> &data) {
+    return HexUtils::binToHex(const_cast<unsigned char *>(data.data()), data.size());
+}
+
+static std::vector<unsigned char> toBmp(const char *password) {
+    std::vector<unsigned char> bmp;
+    for (const char *c = password; *c != '\0'; c++) {
+        bmp.push_back(0);
+        bmp.push_back(static_cast<unsigned char>(*c));
+    }
+    bmp.push_back(0);
+    bmp.push_back(0);
+    return bmp;
+}
+
 TEST_CASE( "KeyStoreTests", "[success]" ) {
 
     SECTION( "Generate a 2048 bit Signing Key" ) {
@@ -26,5 +49,57 @@ TEST_CASE( "KeyStoreTests", "[success]" ) {
         // Cleanup
         keyStoreUtil.deleteKeyFromKeyStore(L"My Key");
     }
+
+    SECTION( "Keep the opened key for the next use" ) {
+        // Arrange
+        KeyStoreUtil keyStoreUtil(MS_KEY_STORAGE_PROVIDER);
+        if (keyStoreUtil.isKeyInKeystore(L"My Key")) {
+            keyStoreUtil.deleteKeyFromKeyStore(L"My Key");
+        }
+        KeyStore keyStore(MS_KEY_STORAGE_PROVIDER);
+        auto generated = keyStore.generateKeyPair(L"My Key", 2048);
+
+        // Act
+        auto byName = keyStore.getKeyPair(L"My Key");
+        auto byPublicKey = keyStore.getKeyPair(*generated->getPublicKeyInfo());
+        keyStore.deleteKeyPair(L"My Key");
+
+        // Assert
+        REQUIRE(byName == generated);
+        REQUIRE(byPublicKey == generated);
+        REQUIRE(!keyStoreUtil.isKeyInKeystore(L"My Key"));
+    }
+
+    SECTION( "PKCS12 key derivation with one iteration" ) {
+        // Arrange
+        auto password = toBmp("smeg");
+        auto salt = fromHex("0a58cf64530d823f");
+        std::vector<unsigned char> key(24);
+        std::vector<unsigned char> iv(8);
+
+        // Act
+        KeyStore::pkcs12DeriveKey(password.data(), password.size(), salt, 1, 1, key.data(), key.size());
+        KeyStore::pkcs12DeriveKey(password.data(), password.size(), salt, 1, 2, iv.data(), iv.size());
+
+        // Assert
+        REQUIRE( toHex(key) == "8aaae6297b6cb04642ab5b077851284eb7128f1a2a7fbca3" );
+        REQUIRE( toHex(iv) == "79993dfe048d3b76" );
+    }
+
+    SECTION( "PKCS12 key derivation with 1000 iterations" ) {
+        // Arrange
+        auto password = toBmp("queeg");
+        auto salt = fromHex("05dec959acff72f7");
+        std::vector<unsigned char> key(24);
+        std::vector<unsigned char> iv(8);
+
+        // Act
+        KeyStore::pkcs12DeriveKey(password.data(), password.size(), salt, 1000, 1, key.data(), key.size());
+        KeyStore::pkcs12DeriveKey(password.data(), password.size(), salt, 1000, 2, iv.data(), iv.size());
+
+        // Assert
+        REQUIRE( toHex(key) == "ed2034e36328830ff09df1e1a07dd357185dac0d4f9eb3d4" );
+        REQUIRE( toHex(iv) == "11dedad7758d4860" );
+    }
 }
 
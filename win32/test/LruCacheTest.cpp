@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <memory>
+#include <string>
+#include "LruCache.h"
+
+namespace {
+
+struct Handle {
+    Handle(int v, std::shared_ptr<int> c) : value{v}, closed{c} {
+    }
+
+    ~Handle() {
+        (*closed)++;
+    }
+
+    int value;
+    std::shared_ptr<int> closed;
+};
+
+}
+
+TEST_CASE( "LruCacheTests", "[success]" ) {
+
+    SECTION( "Find a value which was put" ) {
+        // Arrange
+        LruCache<std::string, int> cache(2);
+        cache.put("first", std::make_shared<int>(1));
+
+        // Act
+        auto value = cache.find("first");
+
+        // Assert
+        REQUIRE( value != nullptr );
+        REQUIRE( *value == 1 );
+        REQUIRE( cache.size() == 1 );
+    }
+
+    SECTION( "The least recently used value is dropped" ) {
+        // Arrange
+        auto closed = std::make_shared<int>(0);
+        LruCache<std::string, Handle> cache(2);
+        cache.put("first", std::make_shared<Handle>(1, closed));
+        cache.put("second", std::make_shared<Handle>(2, closed));
+        cache.find("first");
+
+        // Act
+        cache.put("third", std::make_shared<Handle>(3, closed));
+
+        // Assert
+        REQUIRE( *closed == 1 );
+        REQUIRE( cache.size() == 2 );
+        REQUIRE( cache.find("second") == nullptr );
+        REQUIRE( cache.find("first")->value == 1 );
+        REQUIRE( cache.find("third")->value == 3 );
+    }
+
+    SECTION( "A dropped value stays valid while it is used" ) {
+        // Arrange
+        auto closed = std::make_shared<int>(0);
+        LruCache<std::string, Handle> cache(1);
+        cache.put("first", std::make_shared<Handle>(1, closed));
+        auto inUse = cache.find("first");
+
+        // Act
+        cache.put("second", std::make_shared<Handle>(2, closed));
+        int closedWhileInUse = *closed;
+        inUse.reset();
+
+        // Assert
+        REQUIRE( closedWhileInUse == 0 );
+        REQUIRE( *closed == 1 );
+    }
+
+    SECTION( "Replace the value of a key" ) {
+        // Arrange
+        auto closed = std::make_shared<int>(0);
+        LruCache<std::string, Handle> cache(2);
+        cache.put("first", std::make_shared<Handle>(1, closed));
+
+        // Act
+        cache.put("first", std::make_shared<Handle>(10, closed));
+
+        // Assert
+        REQUIRE( *closed == 1 );
+        REQUIRE( cache.size() == 1 );
+        REQUIRE( cache.find("first")->value == 10 );
+    }
+
+    SECTION( "Find a value by its content" ) {
+        // Arrange
+        LruCache<std::string, int> cache(3);
+        cache.put("first", std::make_shared<int>(1));
+        cache.put("second", std::make_shared<int>(2));
+        cache.put("third", std::make_shared<int>(3));
+
+        // Act
+        auto value = cache.findIf([](int &v) { return v == 1; });
+        cache.put("fourth", std::make_shared<int>(4));
+
+        // Assert
+        REQUIRE( *value == 1 );
+        REQUIRE( cache.find("first") != nullptr );
+        REQUIRE( cache.find("second") == nullptr );
+    }
+
+    SECTION( "Erase and clear" ) {
+        // Arrange
+        auto closed = std::make_shared<int>(0);
+        LruCache<std::string, Handle> cache(4);
+        cache.put("first", std::make_shared<Handle>(1, closed));
+        cache.put("second", std::make_shared<Handle>(2, closed));
+        cache.put("third", std::make_shared<Handle>(3, closed));
+
+        // Act
+        bool erased = cache.erase("second");
+        cache.clear();
+
+        // Assert
+        REQUIRE( erased );
+        REQUIRE( *closed == 3 );
+        REQUIRE( cache.size() == 0 );
+    }
+
+    SECTION( "Erase the values of the matching keys" ) {
+        // Arrange
+        auto closed = std::make_shared<int>(0);
+        LruCache<std::string, Handle> cache(4);
+        cache.put("first", std::make_shared<Handle>(1, closed));
+        cache.put("second", std::make_shared<Handle>(2, closed));
+        cache.put("third", std::make_shared<Handle>(3, closed));
+
+        // Act
+        size_t erased = cache.eraseIf([](const std::string &key) { return key != "second"; });
+        cache.put("fourth", std::make_shared<Handle>(4, closed));
+
+        // Assert
+        REQUIRE( erased == 2 );
+        REQUIRE( *closed == 2 );
+        REQUIRE( cache.size() == 2 );
+        REQUIRE( cache.find("first") == nullptr );
+        REQUIRE( cache.find("second")->value == 2 );
+    }
+}
+
+TEST_CASE( "Failed LruCacheTests", "[failed]" ) {
+
+    SECTION( "Unknown key" ) {
+        // Arrange
+        LruCache<std::string, int> cache(2);
+        cache.put("first", std::make_shared<int>(1));
+
+        // Act && Assert
+        REQUIRE( cache.find("second") == nullptr );
+        REQUIRE( !cache.erase("second") );
+        REQUIRE( cache.findIf([](int &v) { return v == 2; }) == nullptr );
+    }
+
+    SECTION( "A cache without capacity keeps nothing" ) {
+        // Arrange
+        LruCache<std::string, int> cache(0);
+
+        // Act
+        cache.put("first", std::make_shared<int>(1));
+
+        // Assert
+        REQUIRE( cache.size() == 0 );
+        REQUIRE( cache.find("first") == nullptr );
+    }
+}
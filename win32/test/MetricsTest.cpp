@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include "Metrics.h"
+
+TEST_CASE( "MetricsTests", "[success]" ) {
+
+    SECTION( "Record timings and counters" ) {
+        // Arrange
+        Metrics &metrics = Metrics::GetInstance();
+        metrics.reset();
+
+        // Act
+        metrics.record("test.timer", 10);
+        metrics.record("test.timer", 30);
+        metrics.increment("test.counter");
+        metrics.increment("test.counter", 4);
+
+        // Assert
+        auto timer = metrics.getTimers()["test.timer"];
+        REQUIRE( timer.count == 2 );
+        REQUIRE( timer.totalMicroseconds == 40 );
+        REQUIRE( timer.maxMicroseconds == 30 );
+        REQUIRE( metrics.getCounters()["test.counter"] == 5 );
+
+        // Cleanup
+        metrics.reset();
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include "PemScanner.h"
+
+static std::string block(const std::string &label, const std::string &body) {
+    return "-----BEGIN " + label + "-----\n" + body + "\n-----END " + label + "-----\n";
+}
+
+TEST_CASE( "PemScannerTests", "[success]" ) {
+
+    SECTION( "Read a bundle of blocks" ) {
+        // Arrange
+        std::string pem = "Bag Attributes\n    friendlyName: John Doe\n" +
+                          block("CERTIFICATE", "TWFu") +
+                          block("CERTIFICATE", "SGVsbG8sIFdv\r\ncmxkIQ==") +
+                          "subject=CN = RootCA\n" +
+                          block("PKCS7", "YQ==");
+        PemScanner scanner(pem.data(), pem.size());
+
+        // Act
+        bool first = scanner.next();
+        std::string firstLabel = scanner.label();
+        std::string firstData(reinterpret_cast<const char *>(scanner.data()), scanner.size());
+        bool second = scanner.next();
+        std::string secondData(reinterpret_cast<const char *>(scanner.data()), scanner.size());
+        bool third = scanner.next();
+        std::string thirdLabel = scanner.label();
+        std::string thirdData(reinterpret_cast<const char *>(scanner.data()), scanner.size());
+        bool fourth = scanner.next();
+
+        // Assert
+        REQUIRE( first );
+        REQUIRE( firstLabel == "CERTIFICATE" );
+        REQUIRE( firstData == "Man" );
+        REQUIRE( second );
+        REQUIRE( secondData == "Hello, World!" );
+        REQUIRE( third );
+        REQUIRE( thirdLabel == "PKCS7" );
+        REQUIRE( thirdData == "a" );
+        REQUIRE( !fourth );
+        REQUIRE( scanner.size() == 0 );
+    }
+
+    SECTION( "Only the text of the caller is read" ) {
+        // Arrange
+        std::string pem = block("CERTIFICATE", "TWFu") + block("CERTIFICATE", "TWFu");
+
+        // Act
+        PemScanner scanner(pem.data(), pem.size() / 2);
+        bool first = scanner.next();
+        bool second = scanner.next();
+
+        // Assert
+        REQUIRE( first );
+        REQUIRE( !second );
+    }
+
+    SECTION( "Text without blocks" ) {
+        // Arrange
+        std::string text = "MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEA";
+        PemScanner scanner(text.data(), text.size());
+
+        // Act && Assert
+        REQUIRE( !scanner.next() );
+    }
+}
+
+TEST_CASE( "Failed PemScannerTests", "[failed]" ) {
+
+    SECTION( "Block without end line" ) {
+        // Arrange
+        std::string pem = "-----BEGIN CERTIFICATE-----\nTWFu\n";
+        PemScanner scanner(pem.data(), pem.size());
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( scanner.next(), std::invalid_argument );
+    }
+
+    SECTION( "End line of another block" ) {
+        // Arrange
+        std::string pem = "-----BEGIN CERTIFICATE-----\nTWFu\n-----END PKCS7-----\n";
+        PemScanner scanner(pem.data(), pem.size());
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( scanner.next(), std::invalid_argument );
+    }
+
+    SECTION( "Begin line without dashes" ) {
+        // Arrange
+        std::string pem = "-----BEGIN CERTIFICATE\nTWFu\n-----END CERTIFICATE-----\n";
+        PemScanner scanner(pem.data(), pem.size());
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( scanner.next(), std::invalid_argument );
+    }
+
+    SECTION( "Invalid base64" ) {
+        // Arrange
+        std::string invalidCharacter = block("CERTIFICATE", "TW*u");
+        std::string incompleteGroup = block("CERTIFICATE", "TWFuT");
+        std::string dataAfterPadding = block("CERTIFICATE", "TQ==TWFu");
+        std::string header = block("CERTIFICATE", "Proc-Type: 4,ENCRYPTED\nTWFu");
+
+        // Act && Assert
+        for (auto &pem : {invalidCharacter, incompleteGroup, dataAfterPadding, header}) {
+            PemScanner scanner(pem.data(), pem.size());
+            REQUIRE_THROWS_AS( scanner.next(), std::invalid_argument );
+        }
+    }
+}
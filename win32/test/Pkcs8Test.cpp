@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Pkcs8.h"
+#include "utils/HexUtils.hpp"
+
+// openssl pkcs8 -topk8 -v2 aes-256-cbc -v2prf hmacWithSHA256 -iter 2048 of a P-256 key
+static const char *pbes2Key =
+        "3081ec305706092a864886f70d01050d304a302906092a864886f70d01050c301c04086f2d71c5ee682b6d02020800300c06"
+        "082a864886f70d02090500301d060960864801650304012a0410d9c06e9c11bc6d259594d51f86b7240d048190e0ffef65f7"
+        "3e517cc0e94a7f9955c245163592004466836a5b1b6044b4ae2f51d24ed640ae23dbe921991737d5c150aace9ca9decb22ca"
+        "1756e1ee27dff87fd8e576ba315f0b1cc762048eeb3fb2b362e98701a2445228fdaab57274d84235bc83bf9c4cb4d50bdddd"
+        "2537d72ab8a4a5e8d4da8090db91ec47bbeb10946df1e9be8c4959e84051609c93f3c4cc1f0291";
+
+// openssl pkcs8 -topk8 -v1 PBE-SHA1-3DES -iter 2048 of the same key
+static const char *tripleDesKey =
+        "3081b1301c060a2a864886f70d010c0103300e040871cd2296b8bd0f200202080004819067f20686641b60cfff5466a04bcf"
+        "a50d942a91a4b66749750c723c576e2e31feb6fa5bc773f9a703220bac3d2030b42f11a76fb2b7aafbcef940d8f6855bcdf5"
+        "6a1b53fca48869cd8d45266a0e3cf8739d194299961127cd3a5fa8f42725ff5505b2f7ddea77b897235b64041bf72624fc8f"
+        "66ed9ca1e20020c1950595b24aa851cef8b91b0f22613810d4d4498a557a";
+
+static std::vector<unsigned char> fromHex(const char *hex) {
+    std::string data = HexUtils::hexToBin(const_cast<char *>(hex)).str();
+    return std::vector<unsigned char>(data.begin(), data.end());
+}
+
+static std::string toHex(const std::vector<unsigned char> &data) {
+    return HexUtils::binToHex(const_cast<unsigned char *>(data.data()), data.size());
+}
+
+static std::string toHex(const DerBlob &blob) {
+    return HexUtils::binToHex(const_cast<unsigned char *>(blob.data), blob.size);
+}
+
+TEST_CASE( "Pkcs8Tests", "[success]" ) {
+
+    SECTION( "Decode a PBES2 key of openssl" ) {
+        // Arrange
+        auto der = fromHex(pbes2Key);
+
+        // Act
+        auto key = Pkcs8::decode(der.data(), der.size());
+
+        // Assert
+        REQUIRE( key.encryption.scheme == Pkcs8::encryptionScheme::Pbes2 );
+        REQUIRE( toHex(key.encryption.salt) == "6f2d71c5ee682b6d" );
+        REQUIRE( key.encryption.iterations == 2048 );
+        REQUIRE( key.encryption.prf == Pkcs8::prfAlgorithm::HmacSha256 );
+        REQUIRE( key.encryption.keyLength == 32 );
+        REQUIRE( toHex(key.encryption.iv) == "d9c06e9c11bc6d259594d51f86b7240d" );
+        REQUIRE( key.encryptedData.size == 144 );
+        REQUIRE( key.encryptedData.data == der.data() + 95 );
+    }
+
+    SECTION( "Decode a triple DES key of openssl" ) {
+        // Arrange
+        auto der = fromHex(tripleDesKey);
+
+        // Act
+        auto key = Pkcs8::decode(der.data(), der.size());
+
+        // Assert
+        REQUIRE( key.encryption.scheme == Pkcs8::encryptionScheme::Pkcs12TripleDes );
+        REQUIRE( toHex(key.encryption.salt) == "71cd2296b8bd0f20" );
+        REQUIRE( key.encryption.iterations == 2048 );
+        REQUIRE( key.encryptedData.size == 144 );
+    }
+
+    SECTION( "Encode gives back the key of openssl" ) {
+        // Arrange
+        auto pbes2 = fromHex(pbes2Key);
+        auto tripleDes = fromHex(tripleDesKey);
+        auto pbes2Decoded = Pkcs8::decode(pbes2.data(), pbes2.size());
+        auto tripleDesDecoded = Pkcs8::decode(tripleDes.data(), tripleDes.size());
+
+        // Act
+        auto pbes2Encoded = Pkcs8::encode(pbes2Decoded.encryption,
+                                          pbes2Decoded.encryptedData.data,
+                                          pbes2Decoded.encryptedData.size);
+        auto tripleDesEncoded = Pkcs8::encode(tripleDesDecoded.encryption,
+                                              tripleDesDecoded.encryptedData.data,
+                                              tripleDesDecoded.encryptedData.size);
+
+        // Assert
+        REQUIRE( pbes2Encoded == pbes2 );
+        REQUIRE( tripleDesEncoded == tripleDes );
+    }
+
+    SECTION( "Encode a PBES2 key with HMAC-SHA1 and many iterations" ) {
+        // Arrange
+        Pkcs8::Encryption encryption;
+        encryption.scheme = Pkcs8::encryptionScheme::Pbes2;
+        encryption.salt = fromHex("0001020304050607080910111213141516");
+        encryption.iterations = PKCS8_DEFAULT_ITERATIONS;
+        encryption.prf = Pkcs8::prfAlgorithm::HmacSha1;
+        encryption.keyLength = 16;
+        encryption.iv = fromHex("000102030405060708090a0b0c0d0e0f");
+        std::vector<unsigned char> encryptedData(208, 0x5A);
+
+        // Act
+        auto encoded = Pkcs8::encode(encryption, encryptedData.data(), encryptedData.size());
+        auto decoded = Pkcs8::decode(encoded.data(), encoded.size());
+
+        // Assert
+        REQUIRE( decoded.encryption.iterations == PKCS8_DEFAULT_ITERATIONS );
+        REQUIRE( decoded.encryption.prf == Pkcs8::prfAlgorithm::HmacSha1 );
+        REQUIRE( decoded.encryption.keyLength == 16 );
+        REQUIRE( decoded.encryption.salt == encryption.salt );
+        REQUIRE( decoded.encryption.iv == encryption.iv );
+        REQUIRE( toHex(decoded.encryptedData) == toHex(encryptedData) );
+    }
+
+    SECTION( "Encode the parameters of a PKCS12 encryption" ) {
+        // Arrange
+        auto salt = fromHex("0102030405060708");
+
+        // Act
+        auto parameters = Pkcs8::encodePkcs12Parameters(salt, 128);
+
+        // Assert
+        REQUIRE( toHex(parameters) == "300e0408010203040506070802020080" );
+        REQUIRE( std::string(Pkcs8::getPkcs12TripleDesOid()) == "1.2.840.113549.1.12.1.3" );
+    }
+}
+
+TEST_CASE( "Failed Pkcs8Tests", "[failed]" ) {
+
+    SECTION( "Unencrypted private key" ) {
+        // Arrange
+        auto der = fromHex("308187020100301306072a8648ce3d020106082a8648ce3d030107046d306b02010104208bb2431a5c9c8d3d"
+                           "2834b75c8a564cec3aaf6df49cb7133bf8418ee44f6a653fa144034200047b6892e07f28c5bc3f005b5a8119"
+                           "9706d89785379b94301fd774ca28cdf7f530b8f0ec78067fff0a1850d156ce47f8481242facb64c111de773f"
+                           "d5d5ca4b5857");
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( Pkcs8::decode(der.data(), der.size()), std::invalid_argument );
+    }
+
+    SECTION( "Truncated key" ) {
+        // Arrange
+        auto der = fromHex(pbes2Key);
+
+        // Act && Assert
+        REQUIRE_THROWS_AS( Pkcs8::decode(der.data(), der.size() - 1), std::invalid_argument );
+    }
+
+    SECTION( "Data after the key" ) {
+        // Arrange
+        auto der = fromHex(tripleDesKey);
+        der.push_back(0);
+
+        // Act && Assert
+        REQUIRE_THROWS_WITH( Pkcs8::decode(der.data(), der.size()), "PKCS8: data after the key" );
+    }
+
+    SECTION( "Unsupported cipher" ) {
+        // Arrange
+        auto der = fromHex(pbes2Key);
+        // aes-256-cbc becomes aes-256-gcm
+        der[73] = 0x2E;
+
+        // Act && Assert
+        REQUIRE_THROWS_WITH( Pkcs8::decode(der.data(), der.size()), "PKCS8: unsupported cipher" );
+    }
+
+    SECTION( "Too many iterations" ) {
+        // Arrange
+        Pkcs8::Encryption encryption;
+        encryption.scheme = Pkcs8::encryptionScheme::Pkcs12TripleDes;
+        encryption.salt = fromHex("0102030405060708");
+        encryption.iterations = PKCS8_MAX_ITERATIONS + 1;
+        std::vector<unsigned char> encryptedData(16, 0);
+        auto encoded = Pkcs8::encode(encryption, encryptedData.data(), encryptedData.size());
+
+        // Act && Assert
+        REQUIRE_THROWS_WITH( Pkcs8::decode(encoded.data(), encoded.size()),
+                             "PKCS8: unsupported number of iterations" );
+    }
+
+    SECTION( "Encrypted data which is not a whole number of blocks" ) {
+        // Arrange
+        Pkcs8::Encryption encryption;
+        encryption.scheme = Pkcs8::encryptionScheme::Pbes2;
+        encryption.salt = fromHex("0102030405060708");
+        encryption.iterations = 2048;
+        encryption.prf = Pkcs8::prfAlgorithm::HmacSha256;
+        encryption.keyLength = 32;
+        encryption.iv = std::vector<unsigned char>(16, 1);
+        std::vector<unsigned char> encryptedData(24, 0);
+        auto encoded = Pkcs8::encode(encryption, encryptedData.data(), encryptedData.size());
+
+        // Act && Assert
+        REQUIRE_THROWS_WITH( Pkcs8::decode(encoded.data(), encoded.size()), "PKCS8: invalid encrypted data" );
+    }
+}
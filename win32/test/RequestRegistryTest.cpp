@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <string>
+#include "RequestRegistry.h"
+
+typedef int (*TestHandler)(const RequestSchema::Values &values);
+
+static int first(const RequestSchema::Values &) {
+    return 1;
+}
+
+static int second(const RequestSchema::Values &) {
+    return 2;
+}
+
+static int third(const RequestSchema::Values &) {
+    return 3;
+}
+
+static constexpr RequestSchema::Field firstFields[] = {
+        {"subject_name", RequestSchema::fieldType::String, true},
+        {"rsa_key_length", RequestSchema::fieldType::Unsigned, true},
+        {"include_chain", RequestSchema::fieldType::Boolean, false}
+};
+
+static constexpr RequestSchema::Field secondFields[] = {
+        {"expires_after", RequestSchema::fieldType::Integer, false},
+        {"target", RequestSchema::fieldType::Any, false}
+};
+
+static constexpr RequestType<TestHandler> testTypes[] = {
+        {"first", firstFields, first, RequestScheduler::costClass::Heavy, true},
+        {"second", secondFields, second},
+        {"third", third}
+};
+
+static constexpr auto testDispatcher = makeRequestDispatcher(testTypes);
+static_assert(testDispatcher.isPerfect(), "every request type has its own slot");
+static_assert(RequestSchema::hash("") == 2166136261u, "FNV-1a offset basis");
+static_assert(RequestSchema::hash("a") == 0xe40c292cu, "FNV-1a of a");
+
+TEST_CASE( "RequestRegistryTests", "[success]" ) {
+
+    SECTION( "Find every request type" ) {
+        // Arrange
+        RequestSchema::Values values;
+
+        // Act
+        auto firstType = testDispatcher.find("first");
+        auto secondType = testDispatcher.find("second");
+        auto thirdType = testDispatcher.find("third");
+
+        // Assert
+        REQUIRE( firstType != nullptr );
+        REQUIRE( secondType != nullptr );
+        REQUIRE( thirdType != nullptr );
+        REQUIRE( firstType->handler(values) == 1 );
+        REQUIRE( secondType->handler(values) == 2 );
+        REQUIRE( thirdType->handler(values) == 3 );
+        REQUIRE( thirdType->fieldCount == 0 );
+        REQUIRE( firstType->cost == RequestScheduler::costClass::Heavy );
+        REQUIRE( secondType->cost == RequestScheduler::costClass::Interactive );
+        REQUIRE( thirdType->cost == RequestScheduler::costClass::Interactive );
+        REQUIRE( firstType->cached );
+        REQUIRE_FALSE( secondType->cached );
+        REQUIRE_FALSE( thirdType->cached );
+    }
+
+    SECTION( "Runtime hash matches the compile time hash" ) {
+        // Arrange
+        std::string name = "rsa_key_length";
+
+        // Act
+        auto value = RequestSchema::hash(name.data(), name.size());
+
+        // Assert
+        REQUIRE( value == firstFields[1].hash );
+    }
+
+    SECTION( "Validate the fields in the order of the schema" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"({"request": "first", "request_id": 5, "rsa_key_length": 2048,
+                                                 "subject_name": "cn=John Doe", "unknown": true})");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("first")->validate(request, values);
+
+        // Assert
+        REQUIRE( error == nullptr );
+        REQUIRE( values[0] != nullptr );
+        REQUIRE( values[0]->get<std::string>() == "cn=John Doe" );
+        REQUIRE( values[1]->get<size_t>() == 2048 );
+        REQUIRE( values[2] == nullptr );
+    }
+
+    SECTION( "Values point into the request" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"({"target": "abc", "expires_after": -1})");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("second")->validate(request, values);
+        *values[1] = "def";
+
+        // Assert
+        REQUIRE( error == nullptr );
+        REQUIRE( values[0]->get<int>() == -1 );
+        REQUIRE( request["target"] == "def" );
+    }
+}
+
+TEST_CASE( "Failed RequestRegistryTests", "[failed]" ) {
+
+    SECTION( "Unknown request type" ) {
+        // Arrange
+        std::string name = "fourth";
+
+        // Act
+        auto type = testDispatcher.find(name);
+
+        // Assert
+        REQUIRE( type == nullptr );
+        REQUIRE( testDispatcher.find("") == nullptr );
+        REQUIRE( testDispatcher.find("firs") == nullptr );
+    }
+
+    SECTION( "Missing required field" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"({"subject_name": "cn=John Doe"})");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("first")->validate(request, values);
+
+        // Assert
+        REQUIRE( error != nullptr );
+        REQUIRE( std::string(error) == "Missing Parameters" );
+    }
+
+    SECTION( "Field of the wrong type" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"({"subject_name": "cn=John Doe", "rsa_key_length": "2048"})");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("first")->validate(request, values);
+
+        // Assert
+        REQUIRE( error != nullptr );
+        REQUIRE( std::string(error) == "Invalid Parameter type" );
+    }
+
+    SECTION( "Negative number for an unsigned field" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"({"subject_name": "cn=John Doe", "rsa_key_length": -2048})");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("first")->validate(request, values);
+
+        // Assert
+        REQUIRE( std::string(error) == "Invalid Parameter type" );
+    }
+
+    SECTION( "Request which is not an object" ) {
+        // Arrange
+        auto request = nlohmann::json::parse(R"(["first"])");
+        RequestSchema::Values values;
+
+        // Act
+        auto error = testDispatcher.find("third")->validate(request, values);
+
+        // Assert
+        REQUIRE( std::string(error) == "Request is not an object" );
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <stdexcept>
+#include "RequestScheduler.h"
+#include "Metrics.h"
+
+TEST_CASE( "RequestSchedulerTests", "[success]" ) {
+
+    SECTION( "Interactive requests are not queued behind heavy requests" ) {
+        // Arrange
+        RequestScheduler scheduler(1, 1);
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        auto firstHeavy = scheduler.submit(RequestScheduler::costClass::Heavy, [released] { released.wait(); });
+        auto secondHeavy = scheduler.submit(RequestScheduler::costClass::Heavy, [released] { released.wait(); });
+
+        // Act
+        auto interactive = scheduler.submit(RequestScheduler::costClass::Interactive, [] {});
+        auto status = interactive.wait_for(std::chrono::seconds(5));
+        release.set_value();
+
+        // Assert
+        REQUIRE( status == std::future_status::ready );
+        firstHeavy.get();
+        secondHeavy.get();
+        REQUIRE( Metrics::GetInstance().getTimers().count("queue_wait.heavy") == 1 );
+        REQUIRE( Metrics::GetInstance().getTimers().count("queue_wait.interactive") == 1 );
+    }
+
+    SECTION( "Queued requests are run before the scheduler stops" ) {
+        // Arrange
+        std::atomic<int> runs{0};
+
+        // Act
+        {
+            RequestScheduler scheduler(1, 2);
+            for (int i = 0; i < 20; i++) {
+                scheduler.submit(i % 2 ? RequestScheduler::costClass::Heavy : RequestScheduler::costClass::Interactive,
+                                 [&runs] { runs++; });
+            }
+        }
+
+        // Assert
+        REQUIRE( runs == 20 );
+    }
+}
+
+TEST_CASE( "Failed RequestSchedulerTests", "[failed]" ) {
+
+    SECTION( "Exceptions of a request are returned by its future" ) {
+        // Arrange
+        RequestScheduler scheduler(1, 1);
+
+        // Act
+        auto result = scheduler.submit(RequestScheduler::costClass::Interactive,
+                                       [] { throw std::runtime_error("failed request"); });
+
+        // Assert
+        REQUIRE_THROWS_AS( result.get(), std::runtime_error );
+    }
+
+    SECTION( "A cost class without workers" ) {
+        // Act
+        auto create = [] { RequestScheduler scheduler(0, 1); };
+
+        // Assert
+        REQUIRE_THROWS_AS( create(), std::invalid_argument );
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "ResultCache.h"
+
+TEST_CASE( "ResultCacheTests", "[success]" ) {
+
+    SECTION( "A duplicate returns the cached response" ) {
+        // Arrange
+        ResultCache cache;
+        int runs = 0;
+        auto producer = [&runs](bool &) { runs++; return std::string("response"); };
+
+        // Act
+        auto first = cache.getOrRun("XH45E45MLk0", producer);
+        auto second = cache.getOrRun("XH45E45MLk0", producer);
+
+        // Assert
+        REQUIRE( first == "response" );
+        REQUIRE( second == "response" );
+        REQUIRE( runs == 1 );
+    }
+
+    SECTION( "Concurrent duplicates are run once" ) {
+        // Arrange
+        ResultCache cache;
+        std::atomic<int> runs{0};
+        std::promise<void> release;
+        std::shared_future<void> released(release.get_future());
+        auto producer = [&runs, released](bool &) {
+            runs++;
+            released.wait();
+            return std::string("response");
+        };
+
+        // Act
+        std::vector<std::thread> threads;
+        std::vector<std::string> responses(4);
+        for (size_t i = 0; i < responses.size(); i++) {
+            threads.emplace_back([&cache, &producer, &responses, i] {
+                responses[i] = cache.getOrRun("XH45E45MLk0", producer);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release.set_value();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        // Assert
+        REQUIRE( runs == 1 );
+        for (auto &response : responses) {
+            REQUIRE( response == "response" );
+        }
+    }
+
+    SECTION( "Responses which are not cacheable are run again" ) {
+        // Arrange
+        ResultCache cache;
+        int runs = 0;
+        auto producer = [&runs](bool &cacheable) { runs++; cacheable = false; return std::string("failed"); };
+
+        // Act
+        cache.getOrRun("XH45E45MLk0", producer);
+        cache.getOrRun("XH45E45MLk0", producer);
+
+        // Assert
+        REQUIRE( runs == 2 );
+        REQUIRE( cache.size() == 0 );
+    }
+
+    SECTION( "Expired and surplus entries are evicted" ) {
+        // Arrange
+        ResultCache expiring(16, 1024, std::chrono::milliseconds(0));
+        ResultCache small(2, 1024, std::chrono::minutes(1));
+        auto producer = [](bool &) { return std::string("response"); };
+
+        // Act
+        expiring.getOrRun("1", producer);
+        expiring.getOrRun("2", producer);
+        small.getOrRun("1", producer);
+        small.getOrRun("2", producer);
+        small.getOrRun("3", producer);
+
+        // Assert
+        REQUIRE( expiring.size() == 0 );
+        REQUIRE( small.size() == 2 );
+    }
+}
+
+TEST_CASE( "Failed ResultCacheTests", "[failed]" ) {
+
+    SECTION( "Exceptions are not cached" ) {
+        // Arrange
+        ResultCache cache;
+        int runs = 0;
+        auto producer = [&runs](bool &) -> std::string { runs++; throw std::runtime_error("failed"); };
+
+        // Act
+        auto first = [&] { cache.getOrRun("XH45E45MLk0", producer); };
+        auto second = [&] { cache.getOrRun("XH45E45MLk0", producer); };
+
+        // Assert
+        REQUIRE_THROWS_AS( first(), std::runtime_error );
+        REQUIRE_THROWS_AS( second(), std::runtime_error );
+        REQUIRE( runs == 2 );
+        REQUIRE( cache.size() == 0 );
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include "RevocationIndex.h"
+#include "CertificateView.h"
+#include "utils/TestCertificates.h"
+
+TEST_CASE( "RevocationIndexTests", "[success]" ) {
+
+    SECTION( "Revoked certificate is found" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl));
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Act
+        auto data = RevocationIndex::build(crls, 1, 1234);
+        RevocationIndex index(data.data(), data.size());
+
+        // Assert
+        REQUIRE( index.getIssuerCount() == 1 );
+        REQUIRE( index.getSerialCount() == 4 );
+        REQUIRE( index.getSourceCount() == 1 );
+        REQUIRE( index.getSourceStamp() == 1234 );
+        REQUIRE( index.check(certificate.getIssuer(), certificate.getSerialNumber()) ==
+                 RevocationIndex::revocationStatus::Revoked );
+    }
+
+    SECTION( "Serial numbers are compared numerically" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl));
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        const unsigned char paddedSerial[] = { 0x00, 0x00, 0x01, 0x00 };
+        const unsigned char largeSerial[] = { 0x7F, 0xFF, 0xFF, 0xFF };
+        const unsigned char goodSerial[] = { 0x02 };
+        const unsigned char tooLargeSerial[REVOCATION_SERIAL_WIDTH + 1] = { 0x01 };
+
+        // Act
+        auto data = RevocationIndex::build(crls);
+        RevocationIndex index(data.data(), data.size());
+
+        // Assert
+        REQUIRE( index.check(certificate.getIssuer(), { paddedSerial, sizeof(paddedSerial) }) ==
+                 RevocationIndex::revocationStatus::Revoked );
+        REQUIRE( index.check(certificate.getIssuer(), { largeSerial, sizeof(largeSerial) }) ==
+                 RevocationIndex::revocationStatus::Revoked );
+        REQUIRE( index.check(certificate.getIssuer(), { goodSerial, sizeof(goodSerial) }) ==
+                 RevocationIndex::revocationStatus::Good );
+        REQUIRE( index.check(certificate.getIssuer(), { tooLargeSerial, sizeof(tooLargeSerial) }) ==
+                 RevocationIndex::revocationStatus::Unknown );
+    }
+
+    SECTION( "A CRL past its nextUpdate only answers revoked" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl));
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+        const unsigned char goodSerial[] = { 0x02 };
+        // nextUpdate of rootCACrl is 15/10/2036 12:02:34 UTC
+        const std::time_t nextUpdate = 2107684954;
+
+        // Act
+        auto data = RevocationIndex::build(crls);
+        RevocationIndex index(data.data(), data.size());
+
+        // Assert
+        REQUIRE( index.check(certificate.getIssuer(), { goodSerial, sizeof(goodSerial) }, nextUpdate) ==
+                 RevocationIndex::revocationStatus::Good );
+        REQUIRE( index.check(certificate.getIssuer(), { goodSerial, sizeof(goodSerial) }, nextUpdate + 1) ==
+                 RevocationIndex::revocationStatus::Unknown );
+        REQUIRE( index.check(certificate.getIssuer(), certificate.getSerialNumber(), nextUpdate + 1) ==
+                 RevocationIndex::revocationStatus::Revoked );
+    }
+
+    SECTION( "Issuer without CRL is unknown" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl));
+        CertificateView certificate(TestCertificates::johnDoe, sizeof(TestCertificates::johnDoe));
+
+        // Act
+        auto data = RevocationIndex::build(crls);
+        RevocationIndex index(data.data(), data.size());
+
+        // Assert
+        REQUIRE( index.check(certificate.getSubject(), certificate.getSerialNumber()) ==
+                 RevocationIndex::revocationStatus::Unknown );
+    }
+}
+
+TEST_CASE( "Failed RevocationIndexTests", "[failed]" ) {
+
+    SECTION( "Truncated indexes are rejected" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl));
+        auto data = RevocationIndex::build(crls);
+
+        // Act && Assert
+        for (size_t size = 0; size < data.size(); size++) {
+            REQUIRE_THROWS_AS(RevocationIndex(data.data(), size), std::invalid_argument);
+        }
+    }
+
+    SECTION( "Malformed CRLs are rejected" ) {
+        // Arrange
+        std::vector<std::vector<unsigned char>> crls;
+        crls.emplace_back(TestCertificates::rootCACrl, TestCertificates::rootCACrl + sizeof(TestCertificates::rootCACrl) - 1);
+
+        // Act && Assert
+        REQUIRE_THROWS_AS(RevocationIndex::build(crls), std::invalid_argument);
+        REQUIRE_THROWS_AS(RevocationIndex::validate(crls[0]), std::invalid_argument);
+    }
+}
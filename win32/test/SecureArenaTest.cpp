@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <new>
+#include "SecureArena.h"
+
+TEST_CASE( "SecureArenaTests", "[success]" ) {
+
+    SECTION( "Released chunks are zeroized and reused" ) {
+        // Arrange
+        auto &arena = SecureArena::GetInstance();
+        size_t allocations = arena.getAllocationCount();
+        auto secret = static_cast<unsigned char *>(arena.allocate(24));
+        memset(secret, 0xA5, 24);
+
+        // Act
+        arena.deallocate(secret, 24);
+        auto reused = static_cast<unsigned char *>(arena.allocate(30));
+
+        // Assert
+        REQUIRE( reused == secret );
+        for (size_t i = 0; i < 30; i++) {
+            REQUIRE( reused[i] == 0 );
+        }
+        REQUIRE( arena.getAllocationCount() == allocations + 1 );
+
+        // Cleanup
+        arena.deallocate(reused, 30);
+    }
+
+    SECTION( "Small allocations share the pooled blocks" ) {
+        // Arrange
+        auto &arena = SecureArena::GetInstance();
+        std::vector<void *> chunks;
+        for (int i = 0; i < 64; i++) {
+            chunks.push_back(arena.allocate(64));
+        }
+        size_t reserved = arena.getReservedBytes();
+
+        // Act
+        for (auto chunk : chunks) {
+            arena.deallocate(chunk, 64);
+        }
+        for (auto &chunk : chunks) {
+            chunk = arena.allocate(64);
+        }
+
+        // Assert
+        REQUIRE( reserved <= 2 * SECURE_ARENA_BLOCK_SIZE );
+        REQUIRE( arena.getReservedBytes() == reserved );
+
+        // Cleanup
+        for (auto chunk : chunks) {
+            arena.deallocate(chunk, 64);
+        }
+    }
+
+    SECTION( "Large allocations get their own pages" ) {
+        // Arrange
+        auto &arena = SecureArena::GetInstance();
+        size_t reserved = arena.getReservedBytes();
+
+        // Act
+        void *large = arena.allocate(3 * SECURE_ARENA_MAX_CHUNK);
+        size_t reservedLarge = arena.getReservedBytes();
+        arena.deallocate(large, 3 * SECURE_ARENA_MAX_CHUNK);
+
+        // Assert
+        REQUIRE( reservedLarge >= reserved + 3 * SECURE_ARENA_MAX_CHUNK );
+        REQUIRE( arena.getReservedBytes() == reserved );
+    }
+
+    SECTION( "Containers with the secure allocator" ) {
+        // Arrange
+        auto &arena = SecureArena::GetInstance();
+        size_t allocations = arena.getAllocationCount();
+
+        // Act
+        {
+            SecureWideString password(L"system", L"system" + wcslen(L"system") + 1);
+            SecureBuffer key(10000, 0x5A);
+            password.insert(password.end() - 1, L'!');
+
+            // Assert
+            REQUIRE( wcscmp(password.data(), L"system!") == 0 );
+            REQUIRE( key[9999] == 0x5A );
+            REQUIRE( arena.getAllocationCount() == allocations + 2 );
+        }
+        REQUIRE( arena.getAllocationCount() == allocations );
+    }
+}
+
+TEST_CASE( "Failed SecureArenaTests", "[failed]" ) {
+
+    SECTION( "Allocation size overflow" ) {
+        // Arrange
+        SecureAllocator<wchar_t> allocator;
+
+        // Act
+        // Assert
+        REQUIRE_THROWS_AS( allocator.allocate((std::numeric_limits<size_t>::max)() / 2), std::bad_alloc );
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+#include "SharedMemoryTransport.h"
+
+TEST_CASE( "SharedMemoryTransportTests", "[success]" ) {
+
+    SECTION( "Echo frames larger than the ring" ) {
+        // Arrange
+        auto client = SharedMemoryTransport::create("test.echo", 64 * 1024);
+        auto host = SharedMemoryTransport::open("test.echo");
+        REQUIRE( host != nullptr );
+        std::string body(300 * 1024, 'x');
+        uint32_t bodyLg = body.size();
+        std::string frame = std::string((char *)&bodyLg, 4) + body;
+        std::thread hostThread([&host] {
+            std::string request;
+            while (host->readFrame(request)) {
+                host->writeFrame(request);
+            }
+            host->close();
+        });
+
+        // Act
+        std::string first;
+        std::string second;
+        client->writeFrame(frame);
+        bool firstRead = client->readFrame(first);
+        client->writeFrame(frame);
+        bool secondRead = client->readFrame(second);
+        client->close();
+        hostThread.join();
+        std::string end;
+        bool endRead = client->readFrame(end);
+
+        // Assert
+        REQUIRE( firstRead );
+        REQUIRE( first == frame );
+        REQUIRE( secondRead );
+        REQUIRE( second == frame );
+        REQUIRE_FALSE( endRead );
+    }
+}
+
+TEST_CASE( "Failed SharedMemoryTransportTests", "[failed]" ) {
+
+    SECTION( "Open a transport which does not exist" ) {
+        // Act
+        auto host = SharedMemoryTransport::open("test.none");
+
+        // Assert
+        REQUIRE( host == nullptr );
+    }
+}
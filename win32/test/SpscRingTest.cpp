@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+
+TEST_CASE( "SpscRingTests", "[success]" ) {
+
+    SECTION( "Write and read around the end of the ring" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(16));
+        SpscRing producer = SpscRing::create(memory.data(), 16);
+        SpscRing consumer = SpscRing::attach(memory.data(), memory.size());
+        const char data[] = "0123456789ABCDEFGHIJ";
+        char result[32] = {0};
+
+        // Act
+        size_t firstWritten = producer.write(data, 12);
+        size_t firstRead = consumer.read(result, 10);
+        size_t secondWritten = producer.write(data + 12, 8);
+        size_t secondRead = consumer.read(result + 10, sizeof(result) - 10);
+
+        // Assert
+        REQUIRE( firstWritten == 12 );
+        REQUIRE( firstRead == 10 );
+        REQUIRE( secondWritten == 8 );
+        REQUIRE( secondRead == 10 );
+        REQUIRE( std::string(result) == std::string(data) );
+    }
+
+    SECTION( "Write no more than the capacity" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(16));
+        SpscRing ring = SpscRing::create(memory.data(), 16);
+        std::vector<unsigned char> data(20, 0x5A);
+
+        // Act
+        size_t written = ring.write(data.data(), data.size());
+        size_t writtenWhenFull = ring.write(data.data(), data.size());
+
+        // Assert
+        REQUIRE( written == 16 );
+        REQUIRE( writtenWhenFull == 0 );
+        REQUIRE_FALSE( ring.isClosed() );
+        ring.close();
+        REQUIRE( ring.isClosed() );
+    }
+
+    SECTION( "Stream a frame larger than the ring between threads" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(1024));
+        SpscRing producer = SpscRing::create(memory.data(), 1024);
+        SpscRing consumer = SpscRing::attach(memory.data(), memory.size());
+        std::vector<unsigned char> frame(1024 * 1024);
+        for (size_t i = 0; i < frame.size(); i++) {
+            frame[i] = static_cast<unsigned char>(i * 31);
+        }
+        std::vector<unsigned char> received(frame.size());
+
+        // Act
+        std::thread producerThread([&] {
+            size_t offset = 0;
+            while (offset < frame.size()) {
+                offset += producer.write(frame.data() + offset, (std::min)(size_t(700), frame.size() - offset));
+            }
+            producer.close();
+        });
+        size_t offset = 0;
+        while (offset < received.size()) {
+            offset += consumer.read(received.data() + offset, received.size() - offset);
+        }
+        producerThread.join();
+
+        // Assert
+        REQUIRE( received == frame );
+        REQUIRE( consumer.isClosed() );
+    }
+}
+
+TEST_CASE( "Failed SpscRingTests", "[failed]" ) {
+
+    SECTION( "Capacity is not a power of 2" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(24));
+
+        // Act
+        auto create = [&memory] { SpscRing::create(memory.data(), 24); };
+
+        // Assert
+        REQUIRE_THROWS_AS( create(), std::invalid_argument );
+    }
+
+    SECTION( "Attach to memory without a ring" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(16), 0x00);
+
+        // Act
+        auto attach = [&memory] { SpscRing::attach(memory.data(), memory.size()); };
+
+        // Assert
+        REQUIRE_THROWS_AS( attach(), std::invalid_argument );
+    }
+
+    SECTION( "Positions corrupted by the peer close the ring" ) {
+        // Arrange
+        std::vector<unsigned char> memory(SpscRing::requiredSize(16));
+        SpscRing producer = SpscRing::create(memory.data(), 16);
+        SpscRing consumer = SpscRing::attach(memory.data(), memory.size());
+        producer.write("0123", 4);
+        // The peer enlarges the capacity and moves the head (magic, capacity, head) past the end of the ring
+        uint32_t capacity = 1 << 20;
+        uint64_t head = 1000;
+        memcpy(memory.data() + 4, &capacity, sizeof(capacity));
+        memcpy(memory.data() + 8, &head, sizeof(head));
+        char result[2048];
+
+        // Act
+        auto read = [&consumer, &result] { consumer.read(result, sizeof(result)); };
+
+        // Assert
+        REQUIRE_THROWS_AS( read(), std::runtime_error );
+        REQUIRE( consumer.isClosed() );
+        REQUIRE( consumer.getCapacity() == 16 );
+    }
+}
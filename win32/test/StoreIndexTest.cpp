@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <set>
+#include "StoreIndex.h"
+
+static StoreIndex::Certificate makeCertificate(const std::string &thumbprint,
+                                               const std::string &subject,
+                                               const std::string &issuer,
+                                               std::time_t notAfter,
+                                               const std::string &keyName = std::string()) {
+    return StoreIndex::Certificate{thumbprint, subject, issuer, "01", notAfter - 3600, notAfter, keyName};
+}
+
+TEST_CASE( "StoreIndexTests", "[success]" ) {
+
+    SECTION( "Page through all certificates in thumbprint order" ) {
+        // Arrange
+        StoreIndex index;
+        std::vector<StoreIndex::Certificate> certificates;
+        for (int i = 0; i < 7; i++) {
+            certificates.push_back(makeCertificate(std::string(1, static_cast<char>('g' - i)), "CN=User", "CN=CA", 1000));
+        }
+        index.setCertificates(certificates);
+
+        // Act
+        std::vector<std::string> listed;
+        std::string cursor;
+        size_t pages = 0;
+        do {
+            auto page = index.listCertificates(StoreIndex::CertificateFilter(), cursor, 3);
+            for (auto &certificate : page.entries) {
+                listed.push_back(certificate.thumbprint);
+            }
+            cursor = page.cursor;
+            pages++;
+        } while (!cursor.empty());
+
+        // Assert
+        REQUIRE( index.getCertificateCount() == 7 );
+        REQUIRE( pages == 3 );
+        REQUIRE( listed == std::vector<std::string>{"a", "b", "c", "d", "e", "f", "g"} );
+    }
+
+    SECTION( "Last page which is exactly full has no cursor" ) {
+        // Arrange
+        StoreIndex index;
+        index.setCertificates({makeCertificate("a", "CN=A", "CN=CA", 1000),
+                               makeCertificate("b", "CN=B", "CN=CA", 1000)});
+
+        // Act
+        auto page = index.listCertificates(StoreIndex::CertificateFilter(), "", 2);
+
+        // Assert
+        REQUIRE( page.entries.size() == 2 );
+        REQUIRE( page.cursor.empty() );
+    }
+
+    SECTION( "Filter on issuer with pages" ) {
+        // Arrange
+        StoreIndex index;
+        index.setCertificates({makeCertificate("a", "CN=A", "CN=CA 1", 1000),
+                               makeCertificate("b", "CN=B", "CN=CA 2", 1000),
+                               makeCertificate("c", "CN=C", "CN=CA 1", 1000),
+                               makeCertificate("d", "CN=D", "CN=CA 1", 1000)});
+        StoreIndex::CertificateFilter filter;
+        filter.issuer = "CN=CA 1";
+
+        // Act
+        auto first = index.listCertificates(filter, "", 2);
+        auto second = index.listCertificates(filter, first.cursor, 2);
+
+        // Assert
+        REQUIRE( first.entries.size() == 2 );
+        REQUIRE( first.entries[0].thumbprint == "a" );
+        REQUIRE( first.entries[1].thumbprint == "c" );
+        REQUIRE( first.cursor == "c" );
+        REQUIRE( second.entries.size() == 1 );
+        REQUIRE( second.entries[0].thumbprint == "d" );
+        REQUIRE( second.cursor.empty() );
+    }
+
+    SECTION( "Filter on subject, expiry window and private key" ) {
+        // Arrange
+        StoreIndex index;
+        index.setCertificates({makeCertificate("a", "CN=Alice, O=Cryptable", "CN=CA", 1000, "key-a"),
+                               makeCertificate("b", "CN=Bob, O=Cryptable", "CN=CA", 2000, "key-b"),
+                               makeCertificate("c", "CN=Carol, O=Other", "CN=CA", 3000),
+                               makeCertificate("d", "CN=Dave, O=CRYPTABLE", "CN=CA", 4000)});
+        StoreIndex::CertificateFilter subject;
+        subject.subject = "o=cryptable";
+        StoreIndex::CertificateFilter expiry;
+        expiry.expiresFrom = 2000;
+        expiry.expiresTo = 3000;
+        StoreIndex::CertificateFilter withKey;
+        withKey.privateKey = StoreIndex::presence::With;
+        StoreIndex::CertificateFilter withoutKey;
+        withoutKey.privateKey = StoreIndex::presence::Without;
+        withoutKey.subject = "Cryptable";
+
+        // Act
+        auto bySubject = index.listCertificates(subject);
+        auto byExpiry = index.listCertificates(expiry);
+        auto byWithKey = index.listCertificates(withKey);
+        auto byWithoutKey = index.listCertificates(withoutKey);
+
+        // Assert
+        REQUIRE( bySubject.entries.size() == 3 );
+        REQUIRE( byExpiry.entries.size() == 2 );
+        REQUIRE( byExpiry.entries[0].thumbprint == "b" );
+        REQUIRE( byExpiry.entries[1].thumbprint == "c" );
+        REQUIRE( byWithKey.entries.size() == 2 );
+        REQUIRE( byWithoutKey.entries.size() == 1 );
+        REQUIRE( byWithoutKey.entries[0].thumbprint == "d" );
+    }
+
+    SECTION( "Page size is limited" ) {
+        // Arrange
+        StoreIndex index;
+        std::vector<StoreIndex::Key> keys;
+        for (int i = 0; i < STORE_INDEX_MAX_PAGE_SIZE + 10; i++) {
+            keys.push_back(StoreIndex::Key{std::to_string(100000 + i), "RSA", ""});
+        }
+        index.setKeys(keys);
+
+        // Act
+        auto defaultPage = index.listKeys(StoreIndex::KeyFilter());
+        auto largePage = index.listKeys(StoreIndex::KeyFilter(), "", STORE_INDEX_MAX_PAGE_SIZE * 2);
+
+        // Assert
+        REQUIRE( defaultPage.entries.size() == STORE_INDEX_PAGE_SIZE );
+        REQUIRE( largePage.entries.size() == STORE_INDEX_MAX_PAGE_SIZE );
+        REQUIRE( largePage.cursor == largePage.entries.back().name );
+    }
+
+    SECTION( "Filter keys on their certificate" ) {
+        // Arrange
+        StoreIndex index;
+        index.setKeys({StoreIndex::Key{"key-a", "RSA", "a"},
+                       StoreIndex::Key{"key-b", "RSA", ""},
+                       StoreIndex::Key{"key-c", "ECDSA_P256", "c"}});
+        StoreIndex::KeyFilter linked;
+        linked.certificate = StoreIndex::presence::With;
+        StoreIndex::KeyFilter orphans;
+        orphans.certificate = StoreIndex::presence::Without;
+
+        // Act
+        auto linkedPage = index.listKeys(linked);
+        auto orphanPage = index.listKeys(orphans);
+
+        // Assert
+        REQUIRE( linkedPage.entries.size() == 2 );
+        REQUIRE( orphanPage.entries.size() == 1 );
+        REQUIRE( orphanPage.entries[0].name == "key-b" );
+    }
+
+    SECTION( "Rebuilding reuses the indexed certificates" ) {
+        // Arrange
+        StoreIndex index;
+        index.setCertificates({makeCertificate("a", "CN=A", "CN=CA", 1000)});
+        StoreIndex::Certificate certificate;
+
+        // Act
+        bool found = index.getCertificate("a", certificate);
+        index.setCertificates({certificate, makeCertificate("b", "CN=B", "CN=CA", 1000)});
+
+        // Assert
+        REQUIRE( found );
+        REQUIRE( certificate.subject == "CN=A" );
+        REQUIRE( index.getCertificateCount() == 2 );
+    }
+}
+
+TEST_CASE( "Failed StoreIndexTests", "[failed]" ) {
+
+    SECTION( "Unknown certificate" ) {
+        // Arrange
+        StoreIndex index;
+        StoreIndex::Certificate certificate;
+
+        // Act
+        bool found = index.getCertificate("a", certificate);
+
+        // Assert
+        REQUIRE( !found );
+    }
+
+    SECTION( "Cursor after the last certificate" ) {
+        // Arrange
+        StoreIndex index;
+        index.setCertificates({makeCertificate("a", "CN=A", "CN=CA", 1000)});
+
+        // Act
+        auto page = index.listCertificates(StoreIndex::CertificateFilter(), "z");
+
+        // Assert
+        REQUIRE( page.entries.empty() );
+        REQUIRE( page.cursor.empty() );
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <memory>
+#include "StoreWatcher.h"
+#include "Metrics.h"
+
+namespace {
+
+/**
+ * Store of which the test announces the changes
+ */
+struct Changes {
+    Changes() : pending{0}, polls{0} {
+    }
+
+    int pending;
+    int polls;
+};
+
+class TestSource : public StoreWatcher::Source {
+public:
+    explicit TestSource(std::shared_ptr<Changes> c) : changes{c} {
+    }
+
+    bool changed() override {
+        changes->polls++;
+        bool result = (changes->pending > 0);
+        changes->pending = 0;
+        return result;
+    }
+
+private:
+    std::shared_ptr<Changes> changes;
+};
+
+}
+
+TEST_CASE( "StoreWatcherTests", "[success]" ) {
+
+    SECTION( "A change moves the generation of its store on" ) {
+        // Arrange
+        auto certificates = std::make_shared<Changes>();
+        auto keys = std::make_shared<Changes>();
+        StoreWatcher watcher;
+        watcher.watch(StoreWatcher::watchedStore::Certificates,
+                      std::unique_ptr<StoreWatcher::Source>(new TestSource(certificates)));
+        watcher.watch(StoreWatcher::watchedStore::Keys, std::unique_ptr<StoreWatcher::Source>(new TestSource(keys)));
+
+        // Act
+        bool first = watcher.poll();
+        certificates->pending = 1;
+        bool second = watcher.poll();
+
+        // Assert
+        REQUIRE( !first );
+        REQUIRE( second );
+        REQUIRE( watcher.getGeneration(StoreWatcher::watchedStore::Certificates) == 1 );
+        REQUIRE( watcher.getGeneration(StoreWatcher::watchedStore::Keys) == 0 );
+        REQUIRE( keys->polls == 2 );
+        REQUIRE( Metrics::GetInstance().getCounters()["store.certificates_generation"] == 1 );
+    }
+
+    SECTION( "Changes of several sources of a store move it on once" ) {
+        // Arrange
+        auto ca = std::make_shared<Changes>();
+        auto root = std::make_shared<Changes>();
+        StoreWatcher watcher;
+        watcher.watch(StoreWatcher::watchedStore::Issuers, std::unique_ptr<StoreWatcher::Source>(new TestSource(ca)));
+        watcher.watch(StoreWatcher::watchedStore::Issuers, std::unique_ptr<StoreWatcher::Source>(new TestSource(root)));
+        ca->pending = 1;
+        root->pending = 3;
+
+        // Act
+        watcher.poll();
+
+        // Assert
+        REQUIRE( watcher.getGeneration(StoreWatcher::watchedStore::Issuers) == 1 );
+        REQUIRE( ca->polls == 1 );
+        REQUIRE( root->polls == 1 );
+        REQUIRE( root->pending == 0 );
+    }
+
+    SECTION( "A store without sources keeps its generation" ) {
+        // Arrange
+        StoreWatcher watcher;
+
+        // Act
+        bool changed = watcher.poll();
+
+        // Assert
+        REQUIRE( !changed );
+        REQUIRE( watcher.getGeneration(StoreWatcher::watchedStore::Keys) == 0 );
+    }
+}
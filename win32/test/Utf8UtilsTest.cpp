@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include "Utf8Utils.h"
+
+TEST_CASE( "Utf8UtilsTests", "[success]" ) {
+
+    SECTION( "Convert ASCII longer than a block" ) {
+        // Arrange
+        std::string utf8("CN=Test User, O=Cryptable, C=BE");
+
+        // Act
+        auto utf16 = Utf8Utils::toUtf16(utf8);
+        auto back = Utf8Utils::toUtf8(utf16);
+
+        // Assert
+        REQUIRE( utf16 == u"CN=Test User, O=Cryptable, C=BE" );
+        REQUIRE( back == utf8 );
+    }
+
+    SECTION( "Convert two, three and four byte sequences" ) {
+        // Arrange
+        std::string utf8("p\xC3\xA4ssw\xC3\xB6rd \xE2\x82\xAC \xF0\x9F\x94\x91 and some more ASCII");
+
+        // Act
+        auto utf16 = Utf8Utils::toUtf16(utf8);
+        auto back = Utf8Utils::toUtf8(utf16);
+
+        // Assert
+        REQUIRE( utf16 == u"pässwörd € \U0001F511 and some more ASCII" );
+        REQUIRE( back == utf8 );
+    }
+
+    SECTION( "Convert into a buffer of the caller" ) {
+        // Arrange
+        const char utf8[] = "\xC3\xA9t\xC3\xA9";
+        char16_t utf16[sizeof(utf8)];
+
+        // Act
+        size_t written = Utf8Utils::toUtf16(utf8, sizeof(utf8) - 1, utf16);
+
+        // Assert
+        REQUIRE( written == 3 );
+        REQUIRE( utf16[0] == u'é' );
+        REQUIRE( utf16[1] == u't' );
+        REQUIRE( utf16[2] == u'é' );
+    }
+
+    SECTION( "Convert empty strings" ) {
+        // Arrange
+        // Act
+        // Assert
+        REQUIRE( Utf8Utils::toUtf16(std::string()).empty() );
+        REQUIRE( Utf8Utils::toUtf8(std::u16string()).empty() );
+    }
+}
+
+TEST_CASE( "Failed Utf8UtilsTests", "[failed]" ) {
+
+    SECTION( "Invalid UTF-8" ) {
+        // Arrange
+        std::string truncated("abc\xE2\x82");
+        std::string overlong("\xC0\xAF");
+        std::string overlongThree("\xE0\x80\xAF");
+        std::string surrogate("\xED\xA0\x80");
+        std::string tooLarge("\xF4\x90\x80\x80");
+        std::string continuation("abcdefgh\x80");
+        std::string badContinuation("\xE2\x28\xA1");
+
+        // Act
+        // Assert
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(truncated), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(overlong), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(overlongThree), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(surrogate), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(tooLarge), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(continuation), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf16(badContinuation), std::invalid_argument );
+    }
+
+    SECTION( "Unpaired surrogates" ) {
+        // Arrange
+        std::u16string high(u"abcd");
+        high.push_back(static_cast<char16_t>(0xD83D));
+        std::u16string low(u"a");
+        low.push_back(static_cast<char16_t>(0xDD11));
+        low += u"bcd";
+
+        // Act
+        // Assert
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf8(high), std::invalid_argument );
+        REQUIRE_THROWS_AS( Utf8Utils::toUtf8(low), std::invalid_argument );
+    }
+}
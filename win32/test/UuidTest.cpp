@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Uuid.h"
+
+TEST_CASE( "UuidTests", "[success]" ) {
+
+    SECTION( "Version 4 layout" ) {
+        // Arrange
+        unsigned char uuid[16];
+        char text[UUID_STRING_LENGTH + 1];
+
+        // Act
+        Uuid::generate(Uuid::uuidVersion::V4, uuid);
+        Uuid::format(uuid, text);
+
+        // Assert
+        REQUIRE( (uuid[6] >> 4) == 4 );
+        REQUIRE( (uuid[8] & 0xC0) == 0x80 );
+        REQUIRE( strlen(text) == UUID_STRING_LENGTH );
+        REQUIRE( text[8] == '-' );
+        REQUIRE( text[13] == '-' );
+        REQUIRE( text[14] == '4' );
+        REQUIRE( text[18] == '-' );
+        REQUIRE( text[23] == '-' );
+    }
+
+    SECTION( "Version 7 starts with the time" ) {
+        // Arrange
+        unsigned char uuid[16];
+        char text[UUID_STRING_LENGTH + 1];
+
+        // Act
+        Uuid::generate(0x0123456789ABULL, uuid);
+        Uuid::format(uuid, text);
+
+        // Assert
+        REQUIRE( std::string(text).substr(0, 15) == "01234567-89ab-7" );
+        REQUIRE( (uuid[8] & 0xC0) == 0x80 );
+    }
+
+    SECTION( "Version 7 names sort in time order" ) {
+        // Arrange
+        unsigned char first[16];
+        unsigned char second[16];
+        wchar_t firstText[UUID_STRING_LENGTH + 1];
+        wchar_t secondText[UUID_STRING_LENGTH + 1];
+
+        // Act
+        Uuid::generate(1700000000000ULL, first);
+        Uuid::generate(1700000000001ULL, second);
+        Uuid::format(first, firstText);
+        Uuid::format(second, secondText);
+
+        // Assert
+        REQUIRE( std::wstring(firstText) < std::wstring(secondText) );
+    }
+
+    SECTION( "Unique over threads" ) {
+        // Arrange
+        std::set<std::string> uuids;
+        std::mutex lock;
+        std::vector<std::thread> threads;
+
+        // Act
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&uuids, &lock, t] {
+                std::vector<std::string> generated;
+                for (int i = 0; i < 2000; i++) {
+                    unsigned char uuid[16];
+                    char text[UUID_STRING_LENGTH + 1];
+                    Uuid::generate((t % 2) ? Uuid::uuidVersion::V7 : Uuid::uuidVersion::V4, uuid);
+                    Uuid::format(uuid, text);
+                    generated.push_back(text);
+                }
+                std::lock_guard<std::mutex> guard(lock);
+                uuids.insert(generated.begin(), generated.end());
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        // Assert
+        REQUIRE( uuids.size() == 8 * 2000 );
+    }
+}
@@ -11,6 +11,7 @@
 #include <OpenSSLCertificateRequest.h>
 #include <OpenSSLCA.h>
 #include <Base64Utils.h>
+#include <FrameReader.h>
 #include <sstream>
 #include <iomanip>
 #include <OpenSSLPKCS12.h>
@@ -594,6 +595,138 @@ TEST_CASE( "WebExtensionTests from the field 3", "[fuzzing]" ) {
         REQUIRE(result["response"] == "Bad Request");
     }
 }
+
+TEST_CASE( "WebExtensionTests from the field 4", "[fuzzing]" ) {
+    SECTION( "Truncated frame" ) {
+
+        // Arrange
+        std::string input("{\"request\":\"get_metrics\",\"request_id\":\"1\"}");
+        std::stringstream in;
+        uint32_t length = input.size() + 10;
+        in.write((char *)&length, 4);
+        in << input;
+
+        // Act
+        std::stringstream out;
+        WebExtension::process_request(in, out);
+
+        // Assert
+        uint32_t outLg;
+        out.read((char *)&outLg, 4);
+        nlohmann::json result;
+        out >> result;
+
+        REQUIRE(result["result"] == "NOK");
+        REQUIRE(result["response"] == "Bad Request");
+    }
+
+    SECTION( "Oversized frame" ) {
+
+        // Arrange
+        std::stringstream in;
+        uint32_t length = FRAME_READER_MAX_FRAME + 1;
+        in.write((char *)&length, 4);
+
+        // Act
+        std::stringstream out;
+        WebExtension::process_request(in, out);
+
+        // Assert
+        uint32_t outLg;
+        out.read((char *)&outLg, 4);
+        nlohmann::json result;
+        out >> result;
+
+        REQUIRE(result["result"] == "NOK");
+        REQUIRE(result["response"] == "Bad Request");
+    }
+
+    SECTION( "Frame read by the host" ) {
+
+        // Arrange
+        std::string input("{\"request\":\"get_metrics\",\"request_id\":\"1\"}");
+        std::stringstream in;
+        uint32_t length = input.size();
+        in.write((char *)&length, 4);
+        in << input;
+        FrameReader reader(in);
+        auto status = reader.read();
+
+        // Act
+        std::stringstream out;
+        WebExtension::process_request(reader, status, out);
+
+        // Assert
+        uint32_t outLg;
+        out.read((char *)&outLg, 4);
+        nlohmann::json result;
+        out >> result;
+
+        REQUIRE(result["result"] == "OK");
+        REQUIRE(result["request_id"] == "1");
+    }
+
+    SECTION( "Deadline too large" ) {
+
+        // Arrange
+        std::string input("{\"request\":\"get_metrics\",\"request_id\":\"1\",\"deadline_ms\":18446744073709551615}");
+        std::stringstream in;
+        uint32_t length = input.size();
+        in.write((char *)&length, 4);
+        in << input;
+
+        // Act
+        std::stringstream out;
+        WebExtension::process_request(in, out);
+
+        // Assert
+        uint32_t outLg;
+        out.read((char *)&outLg, 4);
+        nlohmann::json result;
+        out >> result;
+
+        REQUIRE(result["result"] == "NOK");
+        REQUIRE(result["request_id"] == "1");
+        REQUIRE(result["response"] == "Bad Request");
+    }
+}
+
+TEST_CASE( "WebExtensionTests request types", "[success]" ) {
+    SECTION( "Cost classes of the request types" ) {
+
+        // Act
+        auto createCsr = WebExtension::getCostClass("create_csr");
+        auto createCsrBatch = WebExtension::getCostClass("create_csr_batch");
+        auto exportPfx = WebExtension::getCostClass("export_pfx_key");
+        auto importPkcs8 = WebExtension::getCostClass("import_pkcs8");
+        auto importCertificate = WebExtension::getCostClass("import_certificate");
+        auto getChain = WebExtension::getCostClass("get_chain");
+        auto unknown = WebExtension::getCostClass("generate_everything");
+
+        // Assert
+        REQUIRE(createCsr == RequestScheduler::costClass::Heavy);
+        REQUIRE(createCsrBatch == RequestScheduler::costClass::Heavy);
+        REQUIRE(exportPfx == RequestScheduler::costClass::Heavy);
+        REQUIRE(importPkcs8 == RequestScheduler::costClass::Heavy);
+        REQUIRE(importCertificate == RequestScheduler::costClass::Interactive);
+        REQUIRE(getChain == RequestScheduler::costClass::Interactive);
+        REQUIRE(unknown == RequestScheduler::costClass::Interactive);
+    }
+
+    SECTION( "Only requests which change the store are cached" ) {
+
+        // Act && Assert
+        REQUIRE(WebExtension::isCached("create_csr"));
+        REQUIRE(WebExtension::isCached("create_csr_batch"));
+        REQUIRE(WebExtension::isCached("import_certificate"));
+        REQUIRE(WebExtension::isCached("import_pfx_key"));
+        REQUIRE(WebExtension::isCached("import_pkcs8"));
+        REQUIRE_FALSE(WebExtension::isCached("export_pfx_key"));
+        REQUIRE_FALSE(WebExtension::isCached("list_certificates"));
+        REQUIRE_FALSE(WebExtension::isCached("get_metrics"));
+        REQUIRE_FALSE(WebExtension::isCached("generate_everything"));
+    }
+}
 #if 0
 TEST_CASE( "WebExtensionTests from the field 1", "[firefox]" ) {
     SECTION( "Import pfx file 1" ) {
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 Cryptable BV. All rights reserved.
+ * (MIT License)
+ * Author: "David Tillemans"
+ * Date: 18/10/2026
+ */
+
+#ifndef KSMGMNT_TESTCERTIFICATES_H
+#define KSMGMNT_TESTCERTIFICATES_H
+
+/*
+ * Fixed test certificates generated with openssl
+ *
+ * rootCA: CN=RootCA,O=Company,C=US, self signed, basicConstraints=critical,CA:TRUE,pathlen:1,
+ *         keyUsage=critical,keyCertSign,cRLSign
+ *         SKI 807A9B6BD9AAA48A2CF20496E73310FC449735BF
+ * johnDoe: CN=John Doe,O=Company,C=US, issued by rootCA, serial 0x0763,
+ *          valid from 2026-10-18 11:57:33 until 2027-10-18 11:57:33 UTC,
+ *          basicConstraints=CA:FALSE, keyUsage=critical,digitalSignature,keyEncipherment
+ *          SKI BB80F55F4AB0D5EEAD2D29E574830223AB4551C7
+ * rootCACrl: CRL of rootCA revoking the serials 0x01, 0x0100, 0x0763 (johnDoe) and 0x7FFFFFFF
+ */
+namespace TestCertificates {
+    static const unsigned char rootCA[] = {
+        0x30, 0x82, 0x02, 0x4f, 0x30, 0x82, 0x01, 0xb8, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x14, 0x2b,
+        0x2a, 0x8e, 0x47, 0x34, 0x28, 0x88, 0xf8, 0xf1, 0x50, 0xa7, 0xf9, 0x42, 0x01, 0xa1, 0x39, 0x1a,
+        0x24, 0x58, 0x48, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b,
+        0x05, 0x00, 0x30, 0x30, 0x31, 0x0f, 0x30, 0x0d, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x06, 0x52,
+        0x6f, 0x6f, 0x74, 0x43, 0x41, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07,
+        0x43, 0x6f, 0x6d, 0x70, 0x61, 0x6e, 0x79, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06,
+        0x13, 0x02, 0x55, 0x53, 0x30, 0x1e, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31,
+        0x35, 0x37, 0x33, 0x33, 0x5a, 0x17, 0x0d, 0x33, 0x36, 0x31, 0x30, 0x31, 0x35, 0x31, 0x31, 0x35,
+        0x37, 0x33, 0x33, 0x5a, 0x30, 0x30, 0x31, 0x0f, 0x30, 0x0d, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c,
+        0x06, 0x52, 0x6f, 0x6f, 0x74, 0x43, 0x41, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a,
+        0x0c, 0x07, 0x43, 0x6f, 0x6d, 0x70, 0x61, 0x6e, 0x79, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55,
+        0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x30, 0x81, 0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48,
+        0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81, 0x8d, 0x00, 0x30, 0x81, 0x89, 0x02,
+        0x81, 0x81, 0x00, 0xe8, 0x2a, 0x45, 0xad, 0xe8, 0xae, 0xcb, 0x9a, 0x1c, 0xf3, 0xe5, 0x34, 0xf5,
+        0x02, 0x9d, 0x1c, 0xd6, 0x95, 0xe1, 0xc5, 0xd9, 0x54, 0x65, 0xce, 0xbe, 0x2e, 0xf4, 0xef, 0x7d,
+        0x80, 0xbd, 0x32, 0x7a, 0x35, 0xf5, 0x3f, 0xe7, 0x69, 0xf3, 0xfe, 0xef, 0x68, 0xd2, 0x0a, 0x36,
+        0xc0, 0x73, 0xea, 0xd9, 0x6d, 0x85, 0x73, 0x82, 0xf1, 0x30, 0x67, 0xb8, 0xb0, 0x86, 0xf0, 0x87,
+        0x56, 0x1a, 0x29, 0xa9, 0x59, 0xed, 0x7c, 0xd5, 0xf8, 0x97, 0xfe, 0xdf, 0x16, 0xbb, 0xb1, 0x54,
+        0x6e, 0x0d, 0x68, 0x0c, 0x24, 0x43, 0xd0, 0x71, 0xe8, 0x2b, 0xb5, 0x9c, 0x3b, 0x51, 0xe6, 0x93,
+        0x50, 0xc9, 0x6e, 0x31, 0x81, 0x7b, 0x5b, 0xe5, 0xf5, 0x47, 0xb3, 0x9f, 0x15, 0xef, 0x1a, 0xb6,
+        0x83, 0xf8, 0xfe, 0x28, 0xe5, 0xb8, 0xcd, 0x53, 0x24, 0x31, 0x56, 0x63, 0xbd, 0x5f, 0xe4, 0x28,
+        0x29, 0x99, 0x0d, 0x02, 0x03, 0x01, 0x00, 0x01, 0xa3, 0x66, 0x30, 0x64, 0x30, 0x1d, 0x06, 0x03,
+        0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x80, 0x7a, 0x9b, 0x6b, 0xd9, 0xaa, 0xa4, 0x8a, 0x2c,
+        0xf2, 0x04, 0x96, 0xe7, 0x33, 0x10, 0xfc, 0x44, 0x97, 0x35, 0xbf, 0x30, 0x1f, 0x06, 0x03, 0x55,
+        0x1d, 0x23, 0x04, 0x18, 0x30, 0x16, 0x80, 0x14, 0x80, 0x7a, 0x9b, 0x6b, 0xd9, 0xaa, 0xa4, 0x8a,
+        0x2c, 0xf2, 0x04, 0x96, 0xe7, 0x33, 0x10, 0xfc, 0x44, 0x97, 0x35, 0xbf, 0x30, 0x12, 0x06, 0x03,
+        0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x08, 0x30, 0x06, 0x01, 0x01, 0xff, 0x02, 0x01, 0x01,
+        0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01, 0x01, 0xff, 0x04, 0x04, 0x03, 0x02, 0x01, 0x06,
+        0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x03,
+        0x81, 0x81, 0x00, 0x52, 0x2b, 0x18, 0x5b, 0x15, 0x32, 0x90, 0x2f, 0x6d, 0x34, 0xc8, 0x6c, 0xf0,
+        0x53, 0x75, 0x75, 0xbb, 0x19, 0x26, 0x47, 0xfc, 0x09, 0xc2, 0xac, 0x03, 0xfe, 0x11, 0x38, 0x84,
+        0x13, 0x87, 0xcf, 0x44, 0xe2, 0x8c, 0x08, 0x15, 0xf6, 0xd3, 0x8d, 0xe9, 0x94, 0x5e, 0x25, 0xf1,
+        0xba, 0xbf, 0xa0, 0xbc, 0xeb, 0x8e, 0x4d, 0x8c, 0xab, 0x13, 0x2c, 0x4e, 0x52, 0x99, 0xa0, 0x16,
+        0x4c, 0xc0, 0xc9, 0xbf, 0x94, 0xb5, 0x2b, 0xaf, 0xc5, 0x4d, 0x28, 0x51, 0x1d, 0xc4, 0x38, 0x69,
+        0x07, 0x88, 0x8c, 0x93, 0xd8, 0x24, 0xb2, 0xc8, 0xd3, 0xc3, 0x5e, 0x77, 0xa2, 0x74, 0x00, 0x70,
+        0xd7, 0x3f, 0x97, 0xec, 0xc4, 0x95, 0x61, 0x0e, 0x05, 0xfe, 0xf6, 0x50, 0x0b, 0x44, 0x2f, 0x6e,
+        0x1b, 0xf5, 0x60, 0xd2, 0x20, 0x10, 0x64, 0xcb, 0x6e, 0xa9, 0xed, 0x3c, 0x68, 0xab, 0x6e, 0x03,
+        0xc5, 0xf7, 0xfe,
+    };
+
+    static const unsigned char johnDoe[] = {
+        0x30, 0x82, 0x02, 0x36, 0x30, 0x82, 0x01, 0x9f, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x02, 0x07,
+        0x63, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00,
+        0x30, 0x30, 0x31, 0x0f, 0x30, 0x0d, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x06, 0x52, 0x6f, 0x6f,
+        0x74, 0x43, 0x41, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x43, 0x6f,
+        0x6d, 0x70, 0x61, 0x6e, 0x79, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02,
+        0x55, 0x53, 0x30, 0x1e, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31, 0x35, 0x37,
+        0x33, 0x33, 0x5a, 0x17, 0x0d, 0x32, 0x37, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31, 0x35, 0x37, 0x33,
+        0x33, 0x5a, 0x30, 0x32, 0x31, 0x11, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x08, 0x4a,
+        0x6f, 0x68, 0x6e, 0x20, 0x44, 0x6f, 0x65, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x0a,
+        0x0c, 0x07, 0x43, 0x6f, 0x6d, 0x70, 0x61, 0x6e, 0x79, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55,
+        0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x30, 0x81, 0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48,
+        0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81, 0x8d, 0x00, 0x30, 0x81, 0x89, 0x02,
+        0x81, 0x81, 0x00, 0xc7, 0x9b, 0x44, 0x72, 0x44, 0xb8, 0x03, 0x48, 0xb2, 0xad, 0xa2, 0x33, 0x00,
+        0xe6, 0x4c, 0x71, 0x45, 0xed, 0x4e, 0xf7, 0x3b, 0xc6, 0xdd, 0x1a, 0xd9, 0x92, 0x05, 0xc3, 0xc5,
+        0xa3, 0xb9, 0xd6, 0x27, 0xa1, 0xc0, 0x94, 0x60, 0xd6, 0xb3, 0x82, 0x3d, 0xd3, 0x63, 0xc4, 0x8c,
+        0xa0, 0x3d, 0x46, 0x8b, 0x24, 0xc0, 0xa3, 0x2e, 0x5a, 0x79, 0x31, 0x51, 0x03, 0x98, 0x2a, 0x22,
+        0xf9, 0xf5, 0x98, 0xbf, 0x8c, 0x30, 0xe9, 0xf2, 0xda, 0xb1, 0x40, 0x03, 0xbe, 0xea, 0xf6, 0x55,
+        0x55, 0x74, 0x88, 0x45, 0x6a, 0x63, 0x1f, 0x08, 0x09, 0x0b, 0x90, 0xa7, 0xce, 0xe0, 0x32, 0xbb,
+        0x04, 0xf7, 0xe4, 0x35, 0x00, 0x53, 0xd0, 0xb4, 0xb1, 0x78, 0x9f, 0x91, 0xfc, 0xcb, 0x80, 0xd9,
+        0x64, 0xdf, 0xfd, 0x68, 0x26, 0x76, 0x76, 0x3c, 0x8b, 0xef, 0x21, 0xf0, 0x57, 0x4a, 0x60, 0xee,
+        0xa2, 0x1c, 0xbd, 0x02, 0x03, 0x01, 0x00, 0x01, 0xa3, 0x5d, 0x30, 0x5b, 0x30, 0x09, 0x06, 0x03,
+        0x55, 0x1d, 0x13, 0x04, 0x02, 0x30, 0x00, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x1d, 0x0f, 0x01, 0x01,
+        0xff, 0x04, 0x04, 0x03, 0x02, 0x05, 0xa0, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16,
+        0x04, 0x14, 0xbb, 0x80, 0xf5, 0x5f, 0x4a, 0xb0, 0xd5, 0xee, 0xad, 0x2d, 0x29, 0xe5, 0x74, 0x83,
+        0x02, 0x23, 0xab, 0x45, 0x51, 0xc7, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x18, 0x30,
+        0x16, 0x80, 0x14, 0x80, 0x7a, 0x9b, 0x6b, 0xd9, 0xaa, 0xa4, 0x8a, 0x2c, 0xf2, 0x04, 0x96, 0xe7,
+        0x33, 0x10, 0xfc, 0x44, 0x97, 0x35, 0xbf, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7,
+        0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x03, 0x81, 0x81, 0x00, 0xcf, 0xba, 0xf8, 0x6a, 0xbf, 0x60,
+        0x82, 0x9b, 0x08, 0x44, 0x82, 0xbc, 0xa4, 0xb9, 0xf2, 0x0e, 0x90, 0x86, 0x23, 0x8c, 0x7a, 0x39,
+        0xde, 0xa8, 0xb4, 0xb7, 0x8a, 0xda, 0xb1, 0x99, 0x9c, 0xd9, 0x64, 0xe7, 0x4e, 0xef, 0x7b, 0x05,
+        0x7d, 0x9e, 0x15, 0x53, 0x4a, 0x60, 0x05, 0x73, 0x68, 0xc7, 0xca, 0x89, 0x99, 0x43, 0x84, 0x01,
+        0x0c, 0x7e, 0x05, 0x8a, 0x3a, 0x56, 0x43, 0xfe, 0xaa, 0x35, 0xf3, 0x53, 0xfd, 0xcc, 0x25, 0xdf,
+        0x2a, 0x26, 0x87, 0x57, 0x66, 0x79, 0x6f, 0x25, 0xc2, 0x0c, 0x66, 0xf6, 0xb3, 0x79, 0x00, 0xb1,
+        0x6e, 0xaa, 0x9d, 0xea, 0x18, 0x47, 0xfb, 0x5b, 0xca, 0x08, 0xe3, 0xd2, 0x78, 0x76, 0x5f, 0x9b,
+        0x5a, 0x54, 0x05, 0x99, 0x4e, 0x76, 0xbd, 0x23, 0x0a, 0x9a, 0xdf, 0x48, 0xd4, 0x02, 0x47, 0x9a,
+        0xeb, 0x9c, 0xad, 0xe8, 0xd7, 0x05, 0x47, 0xcd, 0x70, 0x3f,
+    };
+
+    static const unsigned char rootCACrl[] = {
+        0x30, 0x82, 0x01, 0x60, 0x30, 0x81, 0xca, 0x02, 0x01, 0x01, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86,
+        0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00, 0x30, 0x30, 0x31, 0x0f, 0x30, 0x0d, 0x06,
+        0x03, 0x55, 0x04, 0x03, 0x0c, 0x06, 0x52, 0x6f, 0x6f, 0x74, 0x43, 0x41, 0x31, 0x10, 0x30, 0x0e,
+        0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x07, 0x43, 0x6f, 0x6d, 0x70, 0x61, 0x6e, 0x79, 0x31, 0x0b,
+        0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x17, 0x0d, 0x32, 0x36, 0x31,
+        0x30, 0x31, 0x38, 0x31, 0x32, 0x30, 0x32, 0x33, 0x34, 0x5a, 0x17, 0x0d, 0x33, 0x36, 0x31, 0x30,
+        0x31, 0x35, 0x31, 0x32, 0x30, 0x32, 0x33, 0x34, 0x5a, 0x30, 0x55, 0x30, 0x12, 0x02, 0x01, 0x01,
+        0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31, 0x35, 0x37, 0x33, 0x33, 0x5a, 0x30,
+        0x13, 0x02, 0x02, 0x01, 0x00, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31, 0x35,
+        0x37, 0x33, 0x33, 0x5a, 0x30, 0x13, 0x02, 0x02, 0x07, 0x63, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30,
+        0x31, 0x38, 0x31, 0x32, 0x30, 0x32, 0x33, 0x34, 0x5a, 0x30, 0x15, 0x02, 0x04, 0x7f, 0xff, 0xff,
+        0xff, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x31, 0x35, 0x37, 0x33, 0x33, 0x5a,
+        0xa0, 0x0f, 0x30, 0x0d, 0x30, 0x0b, 0x06, 0x03, 0x55, 0x1d, 0x14, 0x04, 0x04, 0x02, 0x02, 0x10,
+        0x00, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b, 0x05, 0x00,
+        0x03, 0x81, 0x81, 0x00, 0xab, 0x0b, 0x38, 0x02, 0x92, 0x64, 0xf4, 0x5a, 0x3a, 0x3f, 0x39, 0x8d,
+        0x54, 0x1f, 0x33, 0xd5, 0x45, 0xe0, 0x3d, 0x6e, 0x1e, 0x79, 0x38, 0x98, 0xe0, 0x88, 0xd8, 0xe2,
+        0x70, 0x0b, 0x28, 0x93, 0x56, 0xbf, 0x29, 0x13, 0xa0, 0xab, 0x58, 0xe6, 0x6d, 0x90, 0x94, 0x15,
+        0x4a, 0xd8, 0x27, 0xc5, 0x0f, 0x78, 0x1b, 0x87, 0x37, 0x4e, 0xfb, 0x66, 0x3d, 0x53, 0xa6, 0xb8,
+        0xf2, 0x6e, 0xe1, 0xfd, 0x58, 0x30, 0x81, 0xe9, 0x15, 0x1e, 0x8e, 0x81, 0x8e, 0xcf, 0xba, 0x9d,
+        0xdd, 0x6c, 0x8a, 0x7d, 0x6f, 0xc3, 0x58, 0x55, 0x79, 0xce, 0x3c, 0x99, 0x36, 0x40, 0xba, 0x9d,
+        0xa7, 0x15, 0x64, 0x04, 0xae, 0x24, 0x36, 0xef, 0x7b, 0x72, 0x71, 0x27, 0x09, 0x87, 0x6f, 0xd2,
+        0x02, 0xbe, 0x8c, 0x9a, 0xc6, 0x7d, 0xc7, 0x10, 0xdc, 0xdf, 0x36, 0x87, 0xd9, 0x7f, 0x4c, 0xfe,
+        0x95, 0x36, 0x92, 0x68,
+    };
+}
+
+#endif //KSMGMNT_TESTCERTIFICATES_H
+/**********************************************************************************/
+/* MIT License                                                                    */
+/*                                                                                */
+/* Copyright (c) 2020 Cryptable BV
+/*                                                                                */
+/* Permission is hereby granted, free of charge, to any person obtaining a copy   */
+/* of this software and associated documentation files (the "Software"), to deal  */
+/* in the Software without restriction, including without limitation the rights   */
+/* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      */
+/* copies of the Software, and to permit persons to whom the Software is          */
+/* furnished to do so, subject to the following conditions:                       */
+/*                                                                                */
+/* The above copyright notice and this permission notice shall be included in all */
+/* copies or substantial portions of the Software.                                */
+/*                                                                                */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     */
+/* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       */
+/* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    */
+/* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         */
+/* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  */
+/* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  */
+/* SOFTWARE.                                                                      */
+/**********************************************************************************/